@@ -31,28 +31,42 @@ Average performance O(n*log(n))
     e.g. on [2,4,1,3] (which would give [2,1,3,4] with pivot = 4 in index 2)
 3. Call the function on the array after the pivot
     e.g. on [8,7] (which would give [7,8] with pivot = 7 in index 0)
+
+Here the pivot is the last element and the partition Lomuto's: one unpredictable branch per
+element, and O(n^2) on sorted input or many repeated keys.
+
+kthSortedElementPdq uses the pattern defeating partition of pdqSort (pdq_partition.hpp),
+keeping only the side holding the k-th element:
+1. median of three / ninther pivot
+2. branchless block partition (BlockQuicksort) for arithmetic types, Hoare otherwise
+3. bad (< 1/8) partitions shuffle a few elements, and after log2(n) of them the remaining range
+   is heap sorted - O(n*log(n)) worst case instead of O(n^2)
+4. a partition that moved nothing triggers a bounded insertion sort of both sides - sorted
+   input is done in one pass
+5. a pivot equal to the previous pivot splits off all copies of that key at once
+Expected O(n). Leaves data partitioned around the k-th element, like std::nth_element.
+
+main() checks it against std::nth_element on random and patterned input and times both.
 */
 
 #include <iostream>
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <type_traits>
+#include <chrono>
+#include <string>
+#include <cmath>
 #include "random.hpp"
 #include "comparators.hpp"
+#include "pdq_partition.hpp"
 
 using namespace structures_and_algorithms::random;
 using namespace structures_and_algorithms::comparators;
+using namespace structures_and_algorithms::algorithms::arrays::pdq;
 
 #define DEFAULT std::pow(2,31)
 
-template<typename T>
-void swap(T &a, T &b)
-{
-    T temp = std::move(a);
-    a = std::move(b);
-    b = std::move(temp);
-}
-
 template<typename T,typename func>
 size_t partition(std::vector<T> &data, const size_t low, const size_t high, const func &compare)
 {
@@ -121,7 +135,77 @@ size_t kthSortedElementIterative(std::vector<T> &data, const size_t k, const fun
     return DEFAULT;//?
 }
 
-int main(/*int argc, char* argv[]*/)
+///////////////// PATTERN DEFEATING ///////////////////////
+
+//narrow [first,last) down to the partition holding kth - badAllowed and leftmost as in pdqSortLoop
+template<typename T,typename func>
+void pdqSelectLoop(T *first, T *last, T *kth, size_t badAllowed, bool leftmost, const func &compare)
+{
+    while (true){
+        size_t size = last - first;
+        if (size < insertionThreshold){
+            insertionSort(first,last,compare);
+            return;
+        }
+        choosePivot(first,last,compare);
+
+        //pivot equal to the previous one - [first,pivot] all equal to it, so done if kth is there
+        if (!leftmost && !compare(*(first - 1),*first)){
+            T *pivotPosition = partitionLeft(first,last,compare);
+            if (kth <= pivotPosition)
+                return;
+            first = pivotPosition + 1;
+            continue;
+        }
+
+        auto [pivotPosition,alreadyPartitioned] = partitionRight(first,last,compare);
+        if (pivotPosition == kth)
+            return;
+        size_t sizeL = pivotPosition - first;
+        size_t sizeR = last - (pivotPosition + 1);
+        if ((sizeL < size / 8) || (sizeR < size / 8)){ //bad pivot
+            if (--badAllowed == 0){
+                heapSort(first,last,compare);
+                return;
+            }
+            //swap a few elements around to break up the pattern that caused it
+            if (sizeL >= insertionThreshold){
+                swap(*first,*(first + sizeL / 4));
+                swap(*(pivotPosition - 1),*(pivotPosition - sizeL / 4));
+            }
+            if (sizeR >= insertionThreshold){
+                swap(*(pivotPosition + 1),*(pivotPosition + (1 + sizeR / 4)));
+                swap(*(last - 1),*(last - sizeR / 4));
+            }
+        }
+        //nothing moved - the range may be sorted already
+        else if (alreadyPartitioned && partialInsertionSort(first,pivotPosition,compare)
+                                    && partialInsertionSort(pivotPosition + 1,last,compare))
+            return;
+
+        if (kth < pivotPosition)
+            last = pivotPosition;
+        else{
+            first = pivotPosition + 1;
+            leftmost = false;
+        }
+    }
+}
+
+//entry point - k-th smallest, k = 1 ... data.size()
+template<typename T,typename func = decltype(lessThan<T>)>
+size_t kthSortedElementPdq(std::vector<T> &data, const size_t k, const func compare = lessThan<T>)
+{
+    if ((k == 0) || (k > data.size()))
+        return DEFAULT;
+    size_t badAllowed = 1;
+    for (size_t n = data.size(); n >>= 1;)
+        ++badAllowed;
+    pdqSelectLoop(data.data(),data.data() + data.size(),data.data() + (k - 1),badAllowed,true,compare);
+    return data[k - 1];
+}
+
+int main(int argc, char* argv[])
 {
     typedef int32_t T;
     const int32_t N = 10;
@@ -147,5 +231,55 @@ int main(/*int argc, char* argv[]*/)
 
     std::cout<<k<<"-th extreme point is "<<kthVal<<std::endl;
 
+    //pattern defeating version against std::nth_element
+    auto pattern = [&rnd](size_t n, const std::string &name){
+        std::vector<T> values(n);
+        for (size_t i = 0; i < n; ++i){
+            if (name == "random")
+                values[i] = static_cast<T>(2147483647.0*rnd());
+            else if (name == "sorted")
+                values[i] = i;
+            else if (name == "reversed")
+                values[i] = n - i;
+            else if (name == "equal")
+                values[i] = 7;
+            else if (name == "organ pipe")
+                values[i] = std::min(i,n - i);
+            else //few unique
+                values[i] = static_cast<T>(16*rnd());
+        }
+        return values;
+    };
+    const std::vector<std::string> patterns = {"random","sorted","reversed","equal","organ pipe","few unique"};
+    bool agrees = true;
+    for (size_t n : {1,2,23,24,25,129,1000,100000})
+        for (const auto & name : patterns)
+            for (size_t kth : {static_cast<size_t>(1),n / 3 + 1,n}){
+                std::vector<T> values = pattern(n,name);
+                std::vector<T> expected = values;
+                std::nth_element(expected.begin(),expected.begin() + (kth - 1),expected.end());
+                bool ok = (kthSortedElementPdq(values,kth) == static_cast<size_t>(expected[kth - 1]));
+                for (size_t i = 0; i < n; ++i) //partitioned around the k-th
+                    ok = ok && ((i < kth - 1) ? !(values[kth - 1] < values[i]) : !(values[i] < values[kth - 1]));
+                agrees = agrees && ok;
+            }
+    std::cout<<std::endl<<"kthSortedElementPdq agrees: "<<agrees<<std::endl;
+
+    size_t n = (argc > 1) ? std::stoull(argv[1]) : 10000000;
+    std::cout<<std::endl<<"n = "<<n<<", median"<<std::endl<<"input,std::nth_element (ms),kthSortedElementPdq (ms)"<<std::endl;
+    for (const auto & name : patterns){
+        std::vector<T> values = pattern(n,name), copy = values;
+        auto start = std::chrono::steady_clock::now();
+        std::nth_element(copy.begin(),copy.begin() + n / 2,copy.end());
+        auto mid = std::chrono::steady_clock::now();
+        size_t median = kthSortedElementPdq(values,n / 2 + 1);
+        auto end = std::chrono::steady_clock::now();
+        std::cout<<name<<","<<std::chrono::duration<double,std::milli>(mid-start).count()<<","
+                 <<std::chrono::duration<double,std::milli>(end-mid).count();
+        if (median != static_cast<size_t>(copy[n / 2]))
+            std::cout<<" (WRONG)";
+        std::cout<<std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -37,6 +37,7 @@ b = std::move(temp);
 
 #include <iostream>
 #include <vector>
+#include <functional>
 #include "random.hpp"
 #include "comparators.hpp"
 
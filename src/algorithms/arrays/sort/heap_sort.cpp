@@ -31,10 +31,25 @@ We adapt heap so that we consider a dynamical bound n,
 3. Reduce n -> n-1
 4. SendDown data at root (position 1) to re-heapify
 5. loop 2-4 until n = 0
+
+Bottom-up (Floyd) variant - heapSortBottomUp
+
+The textbook sendDown compares the sinking value against the children at every level, even
+though the value taken from the back of the array almost always ends up back near the leaves.
+Instead we:
+
+1. Lift the value out, leaving a "hole" at the root (no swaps - one move per level)
+2. Walk the hole down to a leaf, always moving the extreme child up into it (only child-child comparisons)
+3. Walk the hole back up from the leaf until the value fits, then drop it in (usually 0-1 steps)
+
+We also use a 4-ary heap - children of i at 4i+1 ... 4i+4, parent at (i-1)/4 - which halves
+the depth of the tree, and the 4 children sit next to each other in memory (one cache line for
+small T).
 */
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include "random.hpp"
 #include "comparators.hpp"
 
@@ -98,6 +113,56 @@ void heapSort(std::vector<T> &data,func compare)
     }
 }
 
+///////////////// BOTTOM-UP 4-ARY /////////////////////////
+
+constexpr size_t heapArity = 4; //children per node
+
+//place val into hole at index i of the heap data[0,n) - bottom-up with hole technique
+template<typename T, typename func = decltype(lessThan<T>)>
+void sendDownBottomUp(std::vector<T> &data,size_t i,size_t n,T val,const func &compare)
+{
+    size_t hole = i;
+    size_t child = heapArity * hole + 1;
+    while (child < n){ //walk hole down to a leaf along the extreme children
+        size_t extreme_index = child;
+        size_t last = std::min(child + heapArity,n);
+        for (size_t j = child + 1; j < last; ++j)
+            if (compare(data[extreme_index],data[j]))
+                extreme_index = j;
+        data[hole] = std::move(data[extreme_index]); //move child up into hole
+        hole = extreme_index;
+        child = heapArity * hole + 1;
+    }
+    while (hole > i){ //walk hole back up until val fits
+        size_t parent = (hole - 1) / heapArity;
+        if (!compare(data[parent],val))
+            break;
+        data[hole] = std::move(data[parent]);
+        hole = parent;
+    }
+    data[hole] = std::move(val);
+}
+
+template<typename T, typename func = decltype(lessThan<T>)>
+void heapifyBottomUp(std::vector<T> &data,const func &compare)
+{
+    if (data.size() < 2)
+        return;
+    for (size_t index = (data.size() - 2) / heapArity + 1; index-- > 0;)
+        sendDownBottomUp(data,index,data.size(),std::move(data[index]),compare);
+}
+
+template<typename T, typename func = decltype(lessThan<T>)>
+void heapSortBottomUp(std::vector<T> &data,const func compare = lessThan<T>)
+{
+    heapifyBottomUp(data,compare);
+    for (size_t n = data.size(); n > 1; --n){
+        T val = std::move(data[n-1]); //value displaced by the extreme element
+        data[n-1] = std::move(data.front()); //extreme element to its sorted position
+        sendDownBottomUp(data,0,n-1,std::move(val),compare); //root is now a hole
+    }
+}
+
 int main(/*int argc, char* argv[]*/)
 {
     typedef int32_t T;
@@ -132,5 +197,18 @@ int main(/*int argc, char* argv[]*/)
     for (auto & x: data)
         std::cout<<x<<std::endl;
 
+    for (auto & x: data)
+        x = M*rnd();
+
+    std::cout<<"before (bottom-up 4-ary)"<<std::endl<<std::endl;
+    for (auto & x: data)
+        std::cout<<x<<std::endl;
+
+    heapSortBottomUp(data,lessThan<T>);
+
+    std::cout<<"after (bottom-up 4-ary)"<<std::endl<<std::endl;
+    for (auto & x: data)
+        std::cout<<x<<std::endl;
+
     return 0;
 }
@@ -0,0 +1,265 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Intro sort
+
+Worst case performance O(n*log(n))
+
+Quick sort is fast in practice but degrades to O(n^2) when the pivots are poor (e.g. already
+sorted input with a last-element pivot). Heap sort is always O(n*log(n)) but slower in practice.
+Intro sort ("introspective" sort) combines them:
+
+1. Quick sort as usual, using the partition from quick_sort.cpp, but first move the median of
+   data[low], data[mid], data[high] into data[high] so it is used as the pivot
+2. Keep track of the recursion depth - if it exceeds 2*log2(n) the pivots are clearly bad, so
+   finish the current subrange with heap sort (bottom-up 4-ary version from heap_sort.cpp)
+3. Leave ranges of <= 16 elements alone and finish with a single insertion sort pass at the end
+   - every element is then at most 16 places from its final position
+
+We recurse on the smaller partition and loop on the larger to keep the stack O(log(n)).
+
+main() benchmarks introSort and heapSortBottomUp against std::sort for n = 10^3 ... 10^maxExp
+(maxExp = 7 by default, or the first command line argument).
+*/
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include "random.hpp"
+#include "comparators.hpp"
+
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::comparators;
+
+constexpr size_t heapArity = 4; //children per node
+constexpr size_t insertionThreshold = 16; //ranges this small are left for insertion sort
+
+template<typename T>
+void swap(T &a, T &b)
+{
+    T temp = std::move(a);
+    a = std::move(b);
+    b = std::move(temp);
+}
+
+///////////////// HEAP SORT (on a subrange) /////////////////////////
+
+//place val into hole at index i of the heap heap[0,n) - bottom-up with hole technique
+template<typename T,typename func>
+void sendDownBottomUp(T *heap, size_t i, size_t n, T val, const func &compare)
+{
+    size_t hole = i;
+    size_t child = heapArity * hole + 1;
+    while (child < n){ //walk hole down to a leaf along the extreme children
+        size_t extreme_index = child;
+        size_t last = std::min(child + heapArity,n);
+        for (size_t j = child + 1; j < last; ++j)
+            if (compare(heap[extreme_index],heap[j]))
+                extreme_index = j;
+        heap[hole] = std::move(heap[extreme_index]);
+        hole = extreme_index;
+        child = heapArity * hole + 1;
+    }
+    while (hole > i){ //walk hole back up until val fits
+        size_t parent = (hole - 1) / heapArity;
+        if (!compare(heap[parent],val))
+            break;
+        heap[hole] = std::move(heap[parent]);
+        hole = parent;
+    }
+    heap[hole] = std::move(val);
+}
+
+//heap sort data[low,high]
+template<typename T,typename func>
+void heapSort(std::vector<T> &data, const size_t low, const size_t high, const func &compare)
+{
+    T *heap = data.data() + low;
+    size_t n = high - low + 1;
+    if (n < 2)
+        return;
+    for (size_t index = (n - 2) / heapArity + 1; index-- > 0;)
+        sendDownBottomUp(heap,index,n,std::move(heap[index]),compare);
+    for (; n > 1; --n){
+        T val = std::move(heap[n-1]);
+        heap[n-1] = std::move(heap[0]);
+        sendDownBottomUp(heap,0,n-1,std::move(val),compare);
+    }
+}
+
+template<typename T,typename func = decltype(lessThan<T>)>
+void heapSortBottomUp(std::vector<T> &data, const func compare = lessThan<T>)
+{
+    if (data.size())
+        heapSort(data,0,data.size()-1,compare);
+}
+
+///////////////// QUICK SORT PARTS /////////////////////////
+
+template<typename T,typename func>
+size_t partition(std::vector<T> &data, const size_t low, const size_t high, const func &compare){
+
+    T pivot = data[high]; //take this value - could be any
+
+    //has to be signed integer in case low = 0
+    int64_t pivotIndex = low - 1; //index of the end of the front where "less than" values are moved to
+
+    for (size_t index = low; index < high; ++index){ //no need for index <= j
+        if (compare(data[index],pivot)){//(data[index] < pivot){
+            pivotIndex++;
+            swap(data[index],data[pivotIndex]);
+        }
+    }
+
+    pivotIndex++; //after increment pivotIndex is precisely correct position for pivot.
+    swap(data[high],data[pivotIndex]); //move pivot into its correct position
+    return pivotIndex; //return the pivot index
+}
+
+//move median of data[low], data[mid], data[high] into data[high] for use as the pivot
+template<typename T,typename func>
+void medianOfThree(std::vector<T> &data, const size_t low, const size_t high, const func &compare)
+{
+    size_t mid = low + (high - low) / 2;
+    if (compare(data[mid],data[low]))
+        swap(data[mid],data[low]);
+    if (compare(data[high],data[low]))
+        swap(data[high],data[low]);
+    if (compare(data[mid],data[high]))
+        swap(data[mid],data[high]);
+    //now data[low] <= data[high] <= data[mid]
+}
+
+template<typename T,typename func>
+void insertionSort(std::vector<T> &data, const func &compare)
+{
+    for (size_t i=1; i<data.size(); ++i){
+        T val = std::move(data[i]);
+        size_t j = i;
+        while ((j > 0) && (compare(val,data[j-1]))){ //move all the values up one if greater than the value
+            data[j] = std::move(data[j-1]);
+            --j;
+        }
+        data[j] = std::move(val);
+    }
+}
+
+///////////////// INTRO SORT /////////////////////////
+
+template<typename T,typename func>
+void introSortLoop(std::vector<T> &data, size_t low, size_t high, size_t depthLimit, const func &compare)
+{
+    while (high - low + 1 > insertionThreshold){
+        if (depthLimit == 0){ //too many bad pivots - fall back to heap sort
+            heapSort(data,low,high,compare);
+            return;
+        }
+        --depthLimit;
+        medianOfThree(data,low,high,compare);
+        size_t pivotIndex = partition(data,low,high,compare);
+        if (pivotIndex - low < high - pivotIndex){ //recurse on smaller side, loop on larger
+            if (pivotIndex > low)
+                introSortLoop(data,low,pivotIndex-1,depthLimit,compare);
+            low = pivotIndex + 1;
+        }
+        else{
+            introSortLoop(data,pivotIndex+1,high,depthLimit,compare);
+            if (pivotIndex == low)
+                return;
+            high = pivotIndex - 1;
+        }
+    }
+}
+
+//entry point
+template<typename T,typename func = decltype(lessThan<T>)>
+void introSort(std::vector<T> &data, const func compare = lessThan<T>)
+{
+    if (data.size() < 2)
+        return;
+    size_t depthLimit = 0;
+    for (size_t n = data.size(); n > 1; n >>= 1)
+        depthLimit += 2; // 2*log2(n)
+    introSortLoop(data,0,data.size()-1,depthLimit,compare);
+    insertionSort(data,compare);
+}
+
+///////////////// BENCHMARK /////////////////////////
+
+template<typename Sorter>
+double timeSort(std::vector<int32_t> data, Sorter sorter, bool &sorted)
+{
+    auto start = std::chrono::steady_clock::now();
+    sorter(data);
+    auto end = std::chrono::steady_clock::now();
+    sorted = std::is_sorted(data.begin(),data.end());
+    return std::chrono::duration<double,std::milli>(end-start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    typedef int32_t T;
+    const int32_t N = 10;
+    const T M = 100;
+    RndUniform rnd;
+    std::vector<T> data(N);
+
+    for (auto & x: data)
+        x = M*rnd();
+
+    std::cout<<"before sort"<<std::endl<<std::endl;
+    for (auto & x: data)
+        std::cout<<x<<std::endl;
+
+    introSort(data);
+
+    std::cout<<std::endl<<"after sort"<<std::endl<<std::endl;
+    for (auto & x: data)
+        std::cout<<x<<std::endl;
+
+    //benchmark against std::sort - random and already sorted input
+    int32_t maxExp = (argc > 1) ? std::stoi(argv[1]) : 7;
+    std::cout<<std::endl<<"n,input,std::sort (ms),introSort (ms),heapSortBottomUp (ms)"<<std::endl;
+    for (int32_t e = 3; e <= maxExp; ++e){
+        size_t n = 1;
+        for (int32_t i = 0; i < e; ++i)
+            n *= 10;
+        std::vector<T> bench(n);
+        for (auto & x: bench)
+            x = static_cast<T>(2147483647.0*rnd());
+        for (int32_t pass = 0; pass < 2; ++pass){
+            if (pass == 1)
+                std::sort(bench.begin(),bench.end());
+            bool okStd, okIntro, okHeap;
+            double tStd = timeSort(bench,[](std::vector<T> &d){std::sort(d.begin(),d.end());},okStd);
+            double tIntro = timeSort(bench,[](std::vector<T> &d){introSort(d);},okIntro);
+            double tHeap = timeSort(bench,[](std::vector<T> &d){heapSortBottomUp(d);},okHeap);
+            std::cout<<n<<","<<(pass ? "sorted" : "random")<<","<<tStd<<","<<tIntro<<","<<tHeap;
+            if (!(okStd && okIntro && okHeap))
+                std::cout<<" (NOT SORTED)";
+            std::cout<<std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,379 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Pattern defeating quick sort (Peters) building blocks - shared by pdqSort (quick_sort.cpp) and
+kthSortedElementPdq (quick_select.cpp), which differ only in their main loop (recurse into both
+sides, or keep the side holding the k-th element):
+
+sort2, sort3          - order two or three elements in place
+insertionSort         - small ranges, and unguardedInsertionSort when *(first-1) bounds the range
+partialInsertionSort  - insertion sort that gives up after a few moves, to detect sorted input
+heapSort              - 4-ary heap sort, the O(n*log(n)) fallback after too many bad pivots
+choosePivot           - median of three, or Tukey's ninther for large ranges, moved to *first
+partitionBlock        - branchless block partition (BlockQuicksort, Edelkamp & Weiss)
+partitionRight        - [< pivot] pivot [>= pivot], block partition for arithmetic types
+partitionLeft         - [<= pivot] pivot [> pivot], to split off a run of keys equal to the pivot
+
+All work on raw pointer ranges [first,last) with a comparator compare(a,b) meaning a before b.
+
+*/
+
+#ifndef PDQ_PARTITION_H
+#define PDQ_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace structures_and_algorithms::algorithms::arrays::pdq{
+
+constexpr size_t insertionThreshold = 24; //ranges this small are insertion sorted
+constexpr size_t nintherThreshold = 128; //ranges this large take the median of three medians as pivot
+constexpr size_t partialInsertionLimit = 8; //moves allowed when checking whether a range is already sorted
+constexpr size_t blockSize = 64; //elements classified at a time by the block partition
+constexpr size_t heapArity = 4; //children per node in the heap sort fallback
+
+template<typename T>
+void swap(T &a, T &b)
+{
+    T temp = std::move(a);
+    a = std::move(b);
+    b = std::move(temp);
+}
+
+
+//sort *a <= *b
+template<typename T,typename func>
+void sort2(T *a, T *b, const func &compare)
+{
+    if (compare(*b,*a))
+        swap(*a,*b);
+}
+
+//sort *a <= *b <= *c
+template<typename T,typename func>
+void sort3(T *a, T *b, T *c, const func &compare)
+{
+    sort2(a,b,compare);
+    sort2(b,c,compare);
+    sort2(a,b,compare);
+}
+
+//insertion sort [first,last)
+template<typename T,typename func>
+void insertionSort(T *first, T *last, const func &compare)
+{
+    if (first == last)
+        return;
+    for (T *current = first + 1; current != last; ++current){
+        T val = std::move(*current);
+        T *hole = current;
+        while ((hole != first) && compare(val,*(hole - 1))){
+            *hole = std::move(*(hole - 1));
+            --hole;
+        }
+        *hole = std::move(val);
+    }
+}
+
+//as above, but *(first-1) is no greater than any element of [first,last) - it stops the scan, so no bounds check
+template<typename T,typename func>
+void unguardedInsertionSort(T *first, T *last, const func &compare)
+{
+    if (first == last)
+        return;
+    for (T *current = first + 1; current != last; ++current){
+        T val = std::move(*current);
+        T *hole = current;
+        while (compare(val,*(hole - 1))){
+            *hole = std::move(*(hole - 1));
+            --hole;
+        }
+        *hole = std::move(val);
+    }
+}
+
+//insertion sort that gives up after partialInsertionLimit moves - true if [first,last) ended up sorted
+template<typename T,typename func>
+bool partialInsertionSort(T *first, T *last, const func &compare)
+{
+    if (first == last)
+        return true;
+    size_t moves = 0;
+    for (T *current = first + 1; current != last; ++current){
+        if (!compare(*current,*(current - 1)))
+            continue;
+        T val = std::move(*current);
+        T *hole = current;
+        do{
+            *hole = std::move(*(hole - 1));
+            --hole;
+        } while ((hole != first) && compare(val,*(hole - 1)));
+        *hole = std::move(val);
+        moves += current - hole;
+        if (moves > partialInsertionLimit)
+            return false;
+    }
+    return true;
+}
+
+//place val into hole at index i of the heap heap[0,n) - bottom-up with hole technique
+template<typename T,typename func>
+void sendDownBottomUp(T *heap, size_t i, size_t n, T val, const func &compare)
+{
+    size_t hole = i;
+    size_t child = heapArity * hole + 1;
+    while (child < n){ //walk hole down to a leaf along the extreme children
+        size_t extreme_index = child;
+        size_t last = std::min(child + heapArity,n);
+        for (size_t j = child + 1; j < last; ++j)
+            if (compare(heap[extreme_index],heap[j]))
+                extreme_index = j;
+        heap[hole] = std::move(heap[extreme_index]);
+        hole = extreme_index;
+        child = heapArity * hole + 1;
+    }
+    while (hole > i){ //walk hole back up until val fits
+        size_t parent = (hole - 1) / heapArity;
+        if (!compare(heap[parent],val))
+            break;
+        heap[hole] = std::move(heap[parent]);
+        hole = parent;
+    }
+    heap[hole] = std::move(val);
+}
+
+//heap sort [first,last) - the fallback once too many pivots were bad
+template<typename T,typename func>
+void heapSort(T *first, T *last, const func &compare)
+{
+    T *heap = first;
+    size_t n = last - first;
+    if (n < 2)
+        return;
+    for (size_t index = (n - 2) / heapArity + 1; index-- > 0;)
+        sendDownBottomUp(heap,index,n,std::move(heap[index]),compare);
+    for (; n > 1; --n){
+        T val = std::move(heap[n-1]);
+        heap[n-1] = std::move(heap[0]);
+        sendDownBottomUp(heap,0,n-1,std::move(val),compare);
+    }
+}
+
+//move the pivot to *first - median of first, middle and last element, or for large ranges the
+//median of three such medians (Tukey's ninther). Leaves *(last-1) >= pivot, which stops the scans below
+template<typename T,typename func>
+void choosePivot(T *first, T *last, const func &compare)
+{
+    size_t size = last - first;
+    size_t half = size / 2;
+    if (size > nintherThreshold){
+        sort3(first,first + half,last - 1,compare);
+        sort3(first + 1,first + (half - 1),last - 2,compare);
+        sort3(first + 2,first + (half + 1),last - 3,compare);
+        sort3(first + (half - 1),first + half,first + (half + 1),compare);
+        swap(*first,*(first + half));
+    }
+    else
+        sort3(first + half,first,last - 1,compare);
+}
+
+//swap num misplaced pairs found by partitionBlock - first + offsetsL[i] with last - offsetsR[i]
+//when the counts differ a cyclic permutation does the same with one move per element instead of three
+template<typename T>
+void swapOffsets(T *first, T *last, const unsigned char *offsetsL, const unsigned char *offsetsR, size_t num, bool useSwaps)
+{
+    if (useSwaps){
+        for (size_t i = 0; i < num; ++i)
+            swap(*(first + offsetsL[i]),*(last - offsetsR[i]));
+    }
+    else if (num > 0){
+        T *left = first + offsetsL[0];
+        T *right = last - offsetsR[0];
+        T temp = std::move(*left);
+        *left = std::move(*right);
+        for (size_t i = 1; i < num; ++i){
+            left = first + offsetsL[i];
+            *right = std::move(*left);
+            right = last - offsetsR[i];
+            *left = std::move(*right);
+        }
+        *right = std::move(temp);
+    }
+}
+
+//branchless partition of [first,last) around pivot, for first/last already past the elements that
+//were in place - BlockQuicksort (Edelkamp & Weiss). Blocks of blockSize elements are scanned from
+//each end, writing the offset of every element on the wrong side into a buffer and advancing the
+//buffer count by the comparison result (0 or 1) - no branch depends on the data, so no
+//mispredictions. Then the recorded elements are swapped pairwise. Returns the split point
+template<typename T,typename func>
+T* partitionBlock(T *first, T *last, const T &pivot, const func &compare)
+{
+    alignas(64) unsigned char offsetsL[blockSize];
+    alignas(64) unsigned char offsetsR[blockSize];
+    size_t numL = 0, numR = 0, startL = 0, startR = 0;
+
+    while (last - first > 2 * static_cast<ptrdiff_t>(blockSize)){
+        if (numL == 0){ //left block used up - classify the next
+            startL = 0;
+            for (size_t i = 0; i < blockSize; ++i){
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += !compare(first[i],pivot);
+            }
+        }
+        if (numR == 0){
+            startR = 0;
+            for (size_t i = 0; i < blockSize; ++i){
+                offsetsR[numR] = static_cast<unsigned char>(i + 1);
+                numR += compare(*(last - (i + 1)),pivot);
+            }
+        }
+        size_t num = std::min(numL,numR);
+        swapOffsets(first,last,offsetsL + startL,offsetsR + startR,num,numL == numR);
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0)
+            first += blockSize;
+        if (numR == 0)
+            last -= blockSize;
+    }
+
+    //what is left - at most one partly used block plus fewer than 2 blocks unclassified
+    size_t sizeL = 0, sizeR = 0;
+    size_t unknown = (last - first) - (((numR != 0) || (numL != 0)) ? blockSize : 0);
+    if (numR != 0){
+        sizeL = unknown;
+        sizeR = blockSize;
+    }
+    else if (numL != 0){
+        sizeL = blockSize;
+        sizeR = unknown;
+    }
+    else{
+        sizeL = unknown / 2;
+        sizeR = unknown - sizeL;
+    }
+    if ((numL == 0) && (sizeL != 0)){
+        startL = 0;
+        for (size_t i = 0; i < sizeL; ++i){
+            offsetsL[numL] = static_cast<unsigned char>(i);
+            numL += !compare(first[i],pivot);
+        }
+    }
+    if ((numR == 0) && (sizeR != 0)){
+        startR = 0;
+        for (size_t i = 0; i < sizeR; ++i){
+            offsetsR[numR] = static_cast<unsigned char>(i + 1);
+            numR += compare(*(last - (i + 1)),pivot);
+        }
+    }
+    size_t num = std::min(numL,numR);
+    swapOffsets(first,last,offsetsL + startL,offsetsR + startR,num,numL == numR);
+    numL -= num;
+    numR -= num;
+    startL += num;
+    startR += num;
+    if (numL == 0)
+        first += sizeL;
+    if (numR == 0)
+        last -= sizeR;
+
+    //one side still has misplaced elements - move them to the far end of the other
+    if (numL != 0){
+        while (numL-- > 0)
+            swap(*(first + offsetsL[startL + numL]),*--last);
+        first = last;
+    }
+    if (numR != 0){
+        while (numR-- > 0)
+            swap(*(last - offsetsR[startR + numR]),*first++);
+    }
+    return first;
+}
+
+//partition [first,last) around pivot *first into [< pivot] pivot [>= pivot]
+//returns the pivot position and whether the range was already partitioned (nothing had to move)
+template<typename T,typename func>
+std::pair<T*,bool> partitionRight(T *first, T *last, const func &compare)
+{
+    T *begin = first;
+    T pivot = std::move(*first);
+    while (compare(*++first,pivot)); //stops at *(last-1) at the latest, see choosePivot
+    if (first - 1 == begin)
+        while ((first < last) && !compare(*--last,pivot));
+    else
+        while (!compare(*--last,pivot)); //stops at *(first-1)
+    bool alreadyPartitioned = (first >= last);
+    if (!alreadyPartitioned){
+        swap(*first,*last);
+        ++first;
+        if constexpr (std::is_arithmetic_v<T>) //cheap comparisons - mispredictions dominate, go branchless
+            first = partitionBlock(first,last,pivot,compare);
+        else{
+            while (true){ //Hoare
+                while (compare(*first,pivot))
+                    ++first;
+                while (!compare(*--last,pivot));
+                if (first >= last)
+                    break;
+                swap(*first,*last);
+                ++first;
+            }
+        }
+    }
+    T *pivotPosition = first - 1;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return {pivotPosition,alreadyPartitioned};
+}
+
+//partition [first,last) around pivot *first into [<= pivot] pivot [> pivot]
+//used when the pivot equals the element before the range - everything left of it is then equal too, so done
+template<typename T,typename func>
+T* partitionLeft(T *first, T *last, const func &compare)
+{
+    T *begin = first;
+    T *end = last;
+    T pivot = std::move(*first);
+    while (compare(pivot,*--last)); //choosePivot left an element <= pivot in the range
+    if (last + 1 == end)
+        while ((first < last) && !compare(pivot,*++first));
+    else
+        while (!compare(pivot,*++first));
+    while (first < last){
+        swap(*first,*last);
+        while (compare(pivot,*--last));
+        while (!compare(pivot,*++first));
+    }
+    T *pivotPosition = last;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return pivotPosition;
+}
+
+}
+
+#endif /*PDQ_PARTITION_H*/
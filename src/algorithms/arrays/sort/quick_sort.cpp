@@ -31,24 +31,66 @@ Average performance O(n*log(n))
     e.g. on [2,4,1,3] (which would give [2,1,3,4] with pivot = 4 in index 2)
 3. Call the function on the array after the pivot
     e.g. on [8,7] (which would give [7,8] with pivot = 7 in index 0)
+
+quickSortIterative keeps the ranges still to sort on a stack, pushing the larger half first so
+the smaller is sorted next - the stack never holds more than log2(n) ranges.
+
+Both take the last element as pivot and partition with Lomuto's scheme: one unpredictable
+branch per element, O(n^2) on sorted input and on many repeated keys.
+
+pdqSort - pattern defeating quick sort (Peters), the partition replaced throughout:
+1. pivot is the median of first, middle and last element, or of three such medians (ninther)
+   for more than nintherThreshold elements. It is moved to the front
+2. branchless block partition (BlockQuicksort, Edelkamp & Weiss) for arithmetic types: scan a
+   block of 64 elements from each end, recording the offsets of misplaced elements with
+   "offsets[num] = i; num += compare(...)" - no branch on the data - then swap the recorded
+   pairs. Other types use a plain Hoare partition
+3. a partition leaving less than 1/8 on one side is bad: shuffle a few elements to break the
+   pattern, and after log2(n) bad partitions heap sort the range - O(n*log(n)) worst case
+4. a partition that moved nothing suggests sorted input: try an insertion sort that gives up
+   after 8 moves on each side - sorted and reverse sorted runs take O(n)
+5. if the pivot equals the element just before the range (the previous pivot), every key equal
+   to it is split off in one pass - repeated keys cost O(n) per distinct key
+6. ranges of < insertionThreshold elements are insertion sorted, without the bounds check
+   except for the leftmost range
+The pivot choice, partitions and fallbacks are in pdq_partition.hpp, shared with quick_select.cpp.
+
+quickSortParallel - fork-join over a work stealing pool (work_stealing_pool.hpp):
+1. a task partitions its range as pdqSort does, hands the larger side to the pool as a new
+   task and carries on with the smaller side. Idle threads steal the oldest, i.e. largest,
+   waiting ranges
+2. ranges of <= sequentialCutoff elements are finished by the task that holds them with pdqSort,
+   without spawning
+3. the first partitions are over most of the array, and one thread doing them would cap the
+   speed up (each level costs O(n) whatever the number of threads). Ranges of more than
+   parallelPartitionSize elements are partitioned by several tasks instead: each splits its own
+   chunk into less | not less than the pivot, then the "not less" elements left of the final
+   split point are swapped with the "less" elements right of it, again in parallel
+
+main() checks both against std::sort, times pdqSort against std::sort on random and patterned
+input, then quickSortParallel for 1, 2, 4 ... threads - n = 10^7 or the first command line
+argument.
 */
 
 #include <iostream>
 #include <vector>
-#include <queue>
+#include <stack>
+#include <algorithm>
+#include <chrono>
+#include <string>
 #include "random.hpp"
 #include "comparators.hpp"
+#include "parallel.hpp"
+#include "work_stealing_pool.hpp"
+#include "pdq_partition.hpp"
 
 using namespace structures_and_algorithms::random;
 using namespace structures_and_algorithms::comparators;
+using namespace structures_and_algorithms::algorithms::arrays::pdq;
+using namespace structures_and_algorithms::parallel;
 
-template<typename T>
-void swap(T &a, T &b)
-{
-    T temp = std::move(a);
-    a = std::move(b);
-    b = std::move(temp);
-}
+constexpr size_t sequentialCutoff = 1 << 14; //ranges this small are sorted by one task, no more spawning
+constexpr size_t parallelPartitionSize = 1 << 20; //ranges this large are partitioned by several tasks
 
 template<typename T,typename func>
 size_t partition(std::vector<T> &data, const size_t low, const size_t high, const func &compare){
@@ -91,21 +133,246 @@ void quickSort(std::vector<T> &data,const func compare = lessThan<T>){
 
 template<typename T,typename func = decltype(lessThan<T>)>
 void quickSortIterative(std::vector<T> &data, const func compare = lessThan<T>){
-    std::queue<std::pair<size_t,size_t> > partitions;
+    std::stack<std::pair<size_t,size_t> > partitions;
     partitions.push({0,data.size()-1});
     while (!partitions.empty()){
-        size_t low = partitions.front().first;
-        size_t high = partitions.front().second;
+        size_t low = partitions.top().first;
+        size_t high = partitions.top().second;
         partitions.pop();
          if ((low < high)&&(high < data.size())){
             size_t pivotIndex = partition(data,low,high,compare); // rearranges data and causes element at pivotIndex to be in the right place
-            partitions.push({low,pivotIndex-1});
-            partitions.push({pivotIndex+1,high});
+            if (pivotIndex - low > high - pivotIndex){ //larger half underneath - smaller is sorted next
+                partitions.push({low,pivotIndex-1});
+                partitions.push({pivotIndex+1,high});
+            }
+            else{
+                partitions.push({pivotIndex+1,high});
+                partitions.push({low,pivotIndex-1});
+            }
          }
     }
 }
 
-int main(/*int argc, char* argv[]*/)
+///////////////// PATTERN DEFEATING QUICK SORT ///////////////////////
+
+//pdqsort (Peters) main loop over [first,last). badAllowed - unbalanced partitions left before giving
+//up on quick sort. leftmost - false if *(first-1) is no greater than the range, which allows the
+//unguarded insertion sort and the equal key check
+template<typename T,typename func>
+void pdqSortLoop(T *first, T *last, size_t badAllowed, bool leftmost, const func &compare)
+{
+    while (true){
+        size_t size = last - first;
+        if (size < insertionThreshold){
+            if (leftmost)
+                insertionSort(first,last,compare);
+            else
+                unguardedInsertionSort(first,last,compare);
+            return;
+        }
+        choosePivot(first,last,compare);
+
+        //pivot equal to the element before the range - no element is smaller, so split off all
+        //the keys equal to it in one pass. Many repeated keys then cost O(n) per distinct key
+        if (!leftmost && !compare(*(first - 1),*first)){
+            first = partitionLeft(first,last,compare) + 1;
+            continue;
+        }
+
+        auto [pivotPosition,alreadyPartitioned] = partitionRight(first,last,compare);
+        size_t sizeL = pivotPosition - first;
+        size_t sizeR = last - (pivotPosition + 1);
+        if ((sizeL < size / 8) || (sizeR < size / 8)){ //bad pivot
+            if (--badAllowed == 0){ //too many - O(n*log(n)) guaranteed by heap sort
+                heapSort(first,last,compare);
+                return;
+            }
+            //swap a few elements around to break up the pattern that caused it
+            if (sizeL >= insertionThreshold){
+                swap(*first,*(first + sizeL / 4));
+                swap(*(pivotPosition - 1),*(pivotPosition - sizeL / 4));
+                if (sizeL > nintherThreshold){
+                    swap(*(first + 1),*(first + (sizeL / 4 + 1)));
+                    swap(*(first + 2),*(first + (sizeL / 4 + 2)));
+                    swap(*(pivotPosition - 2),*(pivotPosition - (sizeL / 4 + 1)));
+                    swap(*(pivotPosition - 3),*(pivotPosition - (sizeL / 4 + 2)));
+                }
+            }
+            if (sizeR >= insertionThreshold){
+                swap(*(pivotPosition + 1),*(pivotPosition + (1 + sizeR / 4)));
+                swap(*(last - 1),*(last - sizeR / 4));
+                if (sizeR > nintherThreshold){
+                    swap(*(pivotPosition + 2),*(pivotPosition + (2 + sizeR / 4)));
+                    swap(*(pivotPosition + 3),*(pivotPosition + (3 + sizeR / 4)));
+                    swap(*(last - 2),*(last - (1 + sizeR / 4)));
+                    swap(*(last - 3),*(last - (2 + sizeR / 4)));
+                }
+            }
+        }
+        //nothing moved - the range may be (nearly) sorted already, check cheaply
+        else if (alreadyPartitioned && partialInsertionSort(first,pivotPosition,compare)
+                                    && partialInsertionSort(pivotPosition + 1,last,compare))
+            return;
+
+        pdqSortLoop(first,pivotPosition,badAllowed,leftmost,compare);
+        first = pivotPosition + 1;
+        leftmost = false;
+    }
+}
+
+//number of bad partitions pdqSortLoop allows on n elements - log2(n)
+inline size_t badPartitionsAllowed(size_t n)
+{
+    size_t log2 = 0;
+    while (n >>= 1)
+        ++log2;
+    return std::max<size_t>(1,log2);
+}
+
+//entry point
+template<typename T,typename func = decltype(lessThan<T>)>
+void pdqSort(std::vector<T> &data, const func compare = lessThan<T>)
+{
+    if (data.size() < 2)
+        return;
+    pdqSortLoop(data.data(),data.data() + data.size(),badPartitionsAllowed(data.size()),true,compare);
+}
+
+///////////////// PARALLEL ///////////////////////
+
+//partitionRight with numChunks tasks on the pool - pivot *first
+template<typename T,typename func>
+T* partitionParallel(T *first, T *last, const func &compare, WorkStealingPool &pool, const size_t numChunks)
+{
+    const T pivot = *first;
+    const size_t n = last - (first + 1);
+    std::vector<T*> begins(numChunks + 1), middles(numChunks);
+    for (size_t c = 0; c <= numChunks; ++c)
+        begins[c] = first + 1 + n * c / numChunks;
+
+    //1. chunk c -> [begins[c],middles[c]) less than pivot, [middles[c],begins[c+1]) not
+    TaskGroup group;
+    for (size_t c = 0; c < numChunks; ++c)
+        pool.submit(group,[&,c](){
+            T *middle = begins[c];
+            for (T *current = begins[c]; current != begins[c+1]; ++current)
+                if (compare(*current,pivot))
+                    swap(*current,*middle++);
+            middles[c] = middle;
+        });
+    pool.wait(group);
+
+    //2. misplaced elements - "not less" before split, "less" from split on - as runs
+    T *split = first + 1;
+    for (size_t c = 0; c < numChunks; ++c)
+        split += middles[c] - begins[c];
+    std::vector<std::pair<T*,T*> > leftRuns, rightRuns;
+    for (size_t c = 0; c < numChunks; ++c){
+        if (middles[c] < std::min(begins[c+1],split))
+            leftRuns.emplace_back(middles[c],std::min(begins[c+1],split));
+        if (std::max(begins[c],split) < middles[c])
+            rightRuns.emplace_back(std::max(begins[c],split),middles[c]);
+    }
+    size_t numMisplaced = 0;
+    for (const auto &run : leftRuns)
+        numMisplaced += run.second - run.first;
+
+    //3. swap the k-th misplaced on the left with the k-th on the right, k split between tasks
+    auto seek = [](const std::vector<std::pair<T*,T*> > &runs, size_t k, size_t &run){ //k-th element of the runs
+        for (run = 0; k >= static_cast<size_t>(runs[run].second - runs[run].first); ++run)
+            k -= runs[run].second - runs[run].first;
+        return runs[run].first + k;
+    };
+    for (size_t c = 0; c < numChunks; ++c){
+        size_t begin = numMisplaced * c / numChunks, end = numMisplaced * (c + 1) / numChunks;
+        if (begin == end)
+            continue;
+        pool.submit(group,[&,begin,end](){
+            size_t leftRun, rightRun;
+            T *left = seek(leftRuns,begin,leftRun), *right = seek(rightRuns,begin,rightRun);
+            for (size_t k = begin; k < end; ++k){
+                swap(*left++,*right++);
+                if ((left == leftRuns[leftRun].second) && (leftRun + 1 < leftRuns.size()))
+                    left = leftRuns[++leftRun].first;
+                if ((right == rightRuns[rightRun].second) && (rightRun + 1 < rightRuns.size()))
+                    right = rightRuns[++rightRun].first;
+            }
+        });
+    }
+    pool.wait(group);
+
+    swap(*first,*(split - 1)); //move pivot into its correct position
+    return split - 1;
+}
+
+//sort [first,last), submitting the larger side of each partition to the pool - pdqSortLoop below sequentialCutoff
+template<typename T,typename func>
+void quickSortTask(T *first, T *last, size_t badAllowed, bool leftmost, const func &compare, WorkStealingPool &pool, TaskGroup &group)
+{
+    auto spawn = [&](T *subFirst, T *subLast, bool subLeftmost){
+        pool.submit(group,[subFirst,subLast,badAllowed,subLeftmost,&compare,&pool,&group](){
+            quickSortTask(subFirst,subLast,badAllowed,subLeftmost,compare,pool,group);
+        });
+    };
+    while (static_cast<size_t>(last - first) > sequentialCutoff){
+        size_t size = last - first;
+        choosePivot(first,last,compare);
+        if (!leftmost && !compare(*(first - 1),*first)){ //repeated key - split off all copies, see pdqSortLoop
+            first = partitionLeft(first,last,compare) + 1;
+            continue;
+        }
+        size_t numChunks = std::min<size_t>(pool.numThreads() + 1,size / parallelPartitionSize);
+        T *pivotPosition = (numChunks > 1) ? partitionParallel(first,last,compare,pool,numChunks) : partitionRight(first,last,compare).first;
+        size_t sizeL = pivotPosition - first;
+        size_t sizeR = last - (pivotPosition + 1);
+        if (((sizeL < size / 8) || (sizeR < size / 8)) && (--badAllowed == 0)){
+            heapSort(first,last,compare);
+            return;
+        }
+        if (sizeL < sizeR){
+            spawn(pivotPosition + 1,last,false);
+            last = pivotPosition;
+        }
+        else{
+            spawn(first,pivotPosition,leftmost);
+            first = pivotPosition + 1;
+            leftmost = false;
+        }
+    }
+    pdqSortLoop(first,last,badAllowed,leftmost,compare);
+}
+
+//entry point - sort on an existing pool
+template<typename T,typename func = decltype(lessThan<T>)>
+void quickSortParallel(std::vector<T> &data, WorkStealingPool &pool, const func compare = lessThan<T>)
+{
+    if (data.size() < 2)
+        return;
+    TaskGroup group;
+    T *first = data.data(), *last = data.data() + data.size();
+    pool.submit(group,[&](){quickSortTask(first,last,badPartitionsAllowed(data.size()),true,compare,pool,group);});
+    pool.wait(group);
+}
+
+//entry point - numThreads including the calling thread
+template<typename T,typename func = decltype(lessThan<T>)>
+void quickSortParallel(std::vector<T> &data, const uint32_t numThreads = defaultThreads(), const func compare = lessThan<T>)
+{
+    WorkStealingPool pool(std::max(1u,numThreads) - 1);
+    quickSortParallel(data,pool,compare);
+}
+
+template<typename Sorter>
+double timeSort(std::vector<int32_t> data, Sorter sorter, bool &sorted)
+{
+    auto start = std::chrono::steady_clock::now();
+    sorter(data);
+    auto end = std::chrono::steady_clock::now();
+    sorted = std::is_sorted(data.begin(),data.end());
+    return std::chrono::duration<double,std::milli>(end-start).count();
+}
+
+int main(int argc, char* argv[])
 {
     typedef int32_t T;
     const int32_t N = 10;
@@ -126,5 +393,80 @@ int main(/*int argc, char* argv[]*/)
     for (auto & x: data)
         std::cout<<x<<std::endl;
 
+    //pdqSort on patterned input - run lengths around the block size and insertion threshold
+    auto pattern = [&rnd](size_t n, const std::string &name){
+        std::vector<T> values(n);
+        for (size_t i = 0; i < n; ++i){
+            if (name == "random")
+                values[i] = static_cast<T>(2147483647.0*rnd());
+            else if (name == "sorted")
+                values[i] = i;
+            else if (name == "reversed")
+                values[i] = n - i;
+            else if (name == "equal")
+                values[i] = 7;
+            else if (name == "organ pipe")
+                values[i] = std::min(i,n - i);
+            else if (name == "few unique")
+                values[i] = static_cast<T>(16*rnd());
+            else if (name == "sawtooth")
+                values[i] = i % 1000;
+            else //sorted with a few random swaps
+                values[i] = i;
+        }
+        if (name == "nearly sorted")
+            for (size_t s = 0; s < n / 100; ++s)
+                std::swap(values[static_cast<size_t>(n*rnd()) % n],values[static_cast<size_t>(n*rnd()) % n]);
+        return values;
+    };
+    const std::vector<std::string> patterns = {"random","sorted","reversed","equal","organ pipe","few unique","sawtooth","nearly sorted"};
+    bool pdqAgrees = true;
+    for (size_t n : {0,1,2,23,24,25,129,1000,100000})
+        for (const auto & name : patterns){
+            std::vector<T> values = pattern(n,name);
+            std::vector<T> expected = values;
+            std::sort(expected.begin(),expected.end());
+            pdqSort(values);
+            pdqAgrees = pdqAgrees && (values == expected);
+        }
+    std::cout<<std::endl<<"pdqSort agrees: "<<pdqAgrees<<std::endl;
+
+    //parallel version - small ranges and one large one, against std::sort
+    bool agrees = true;
+    for (size_t n : {0,1,2,17,1000,100000,3000000}){
+        for (const auto & name : patterns){
+            std::vector<T> values = pattern(n,name);
+            std::vector<T> expected = values;
+            std::sort(expected.begin(),expected.end());
+            quickSortParallel(values,4);
+            agrees = agrees && (values == expected);
+        }
+    }
+    std::cout<<std::endl<<"parallel version agrees: "<<agrees<<std::endl;
+
+    size_t n = (argc > 1) ? std::stoull(argv[1]) : 10000000;
+    std::cout<<std::endl<<"n = "<<n<<std::endl<<"input,std::sort (ms),pdqSort (ms)"<<std::endl;
+    for (const auto & name : patterns){
+        std::vector<T> values = pattern(n,name);
+        bool okStd, okPdq;
+        double tStd = timeSort(values,[](std::vector<T> &d){std::sort(d.begin(),d.end());},okStd);
+        double tPdq = timeSort(values,[](std::vector<T> &d){pdqSort(d);},okPdq);
+        std::cout<<name<<","<<tStd<<","<<tPdq;
+        if (!(okStd && okPdq))
+            std::cout<<" (NOT SORTED)";
+        std::cout<<std::endl;
+    }
+
+    std::vector<T> bench = pattern(n,"random");
+    std::cout<<std::endl<<"threads,quickSortParallel (ms)"<<std::endl;
+    for (uint32_t threads = 1; threads <= defaultThreads(); threads *= 2){
+        bool ok;
+        double t = timeSort(bench,[threads](std::vector<T> &d){quickSortParallel(d,threads);},ok);
+        std::cout<<threads<<","<<t;
+        if (!ok)
+            std::cout<<" (NOT SORTED)";
+        std::cout<<std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
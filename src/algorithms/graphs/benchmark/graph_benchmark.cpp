@@ -0,0 +1,247 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Graph benchmark harness
+
+Times the search, cluster and shortest path implementations over seeded synthetic graphs
+(graph_generators.hpp) of 10^3, 10^4, ... up to maxVertices vertices and writes one CSV row
+per (graph, algorithm):
+
+generator,vertices,edges,algorithm,threads,ms,edges_per_second,peak_rss_mb,check
+
+edges     - stored (directed) edges, every undirected edge counts twice
+edges/sec - edges / time, whether or not the algorithm reaches all of them
+peak_rss  - peak resident set during the run (graph included): VmHWM is reset through
+            /proc/self/clear_refs before each run, where the kernel allows it, otherwise the
+            process wide peak from getrusage. "n/a" on Windows
+check     - a result to compare between variants and runs: vertices reached for bfs and
+            dijkstra, number of clusters, whether the (absent) search key was found
+
+Graphs:
+rmat     - R-MAT, 2^round(log2 n) vertices, degree/2 undirected edges per vertex
+grid     - road like lattice, round(sqrt n)^2 vertices, 10% of edges removed
+er       - Erdos-Renyi G(n,m), degree/2 undirected edges per vertex
+ba       - Barabasi-Albert, degree/2 edges per new vertex
+
+Every graph is stored as a CSRGraph, with weights in [1,16]. The searches look for a key that
+is not there, so they visit every vertex. The recursive searches only run up to
+recursionLimit vertices - their stack depth grows with the queue length.
+
+Usage: graph_benchmark [maxVertices = 10^6] [csv file = stdout] [threads] [degree = 16] [seed = 1]
+
+10^8 vertices needs maxVertices = 100000000 and tens of GB of memory - the edge list and the
+graph are both held while each graph is built.
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
+#include "parallel.hpp"
+#include "graph_generators.hpp"
+#include "breadth_first_search_iterative.hpp"
+#include "breadth_first_search_recursive.hpp"
+#include "depth_first_search_iterative.hpp"
+#include "depth_first_search_recursive.hpp"
+#include "breadth_first_search_parallel.hpp"
+#include "cluster_dfs_iterative.hpp"
+#include "dijkstra.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::parallel;
+using namespace structures_and_algorithms::algorithms::graphs;
+
+typedef uint32_t T;
+typedef uint32_t U;
+
+constexpr uint32_t recursionLimit = 1000;
+constexpr U maxWeight = 16;
+
+//peak resident set in bytes since the last resetPeakRSS - 0 if it cannot be measured
+size_t peakRSS()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status,line))
+        if (line.compare(0,6,"VmHWM:") == 0)
+            return std::stoull(line.substr(6)) * 1024;
+#ifndef _WIN32
+    rusage usage;
+    getrusage(RUSAGE_SELF,&usage);
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#else
+    return 0;
+#endif
+}
+
+void resetPeakRSS()
+{
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs)
+        clearRefs<<"5"; //reset VmHWM to the current resident set
+}
+
+class Benchmark{
+    std::ostream &out;
+    const uint32_t numThreads;
+    std::string generator;
+    uint32_t N = 0;
+    size_t numEdges = 0;
+    uint32_t source = 0; //bfs and dijkstra start - an end of the first edge, so never isolated
+public:
+    Benchmark(std::ostream &out_, const uint32_t numThreads_):out(out_),numThreads(numThreads_)
+    {
+        out<<"generator,vertices,edges,algorithm,threads,ms,edges_per_second,peak_rss_mb,check"<<std::endl;
+    }
+
+    void setGraph(const std::string &generator_, const uint32_t N_, const generators::EdgeList<U> &edges)
+    {
+        generator = generator_;
+        N = N_;
+        numEdges = edges.size();
+        source = edges.empty() ? 0 : std::get<0>(edges.front());
+    }
+
+    //run fn() -> check once and write its row
+    template<typename Fn>
+    void run(const std::string &algorithm, const uint32_t threads, Fn &&fn)
+    {
+        resetPeakRSS();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t check = fn();
+        auto end = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double,std::milli>(end-start).count();
+        double rate = (ms > 0) ? numEdges / (ms / 1000) : 0;
+        size_t peak = peakRSS();
+        out<<generator<<","<<N<<","<<numEdges<<","<<algorithm<<","<<threads<<","<<ms<<","
+           <<static_cast<uint64_t>(rate)<<",";
+        if (peak)
+            out<<peak / (1024.0*1024.0);
+        else
+            out<<"n/a";
+        out<<","<<check<<std::endl;
+        std::cerr<<generator<<" "<<N<<" "<<algorithm<<": "<<ms<<" ms"<<std::endl;
+    }
+
+    //every algorithm over one graph - each builds its own CSRGraph from the edge list, one at a time
+    void runAll(const generators::EdgeList<U> &edges)
+    {
+        auto reached = [](const std::vector<int32_t> &distance){
+            return static_cast<uint64_t>(std::count_if(distance.begin(),distance.end(),[](int32_t d){return d >= 0;}));
+        };
+        {
+            GraphBFSI<T,U,CSRGraph<T,U> > graph(N,edges);
+            SearchWorkspace workspace;
+            run("bfs_iterative",1,[&](){return graph.search(N,workspace);});
+        }
+        {
+            GraphDFSI<T,U,CSRGraph<T,U> > graph(N,edges);
+            SearchWorkspace workspace;
+            run("dfs_iterative",1,[&](){return graph.search(N,workspace);});
+        }
+        if (N <= recursionLimit){
+            GraphBFSR<T,U,CSRGraph<T,U> > bfsGraph(N,edges);
+            GraphDFSR<T,U,CSRGraph<T,U> > dfsGraph(N,edges);
+            SearchWorkspace workspace;
+            run("bfs_recursive",1,[&](){return bfsGraph.search(N,workspace);});
+            run("dfs_recursive",1,[&](){return dfsGraph.search(N,workspace);});
+        }
+        {
+            GraphBFSP<T,U,CSRGraph<T,U> > graph(N,edges);
+            run("bfs_sequential",1,[&](){return reached(graph.bfsSequential(source).distance);});
+            run("bfs_direction_optimising",numThreads,[&](){return reached(graph.bfs(source,true,numThreads).distance);});
+        }
+        {
+            GraphCluster<T,U,CSRGraph<T,U> > graph(N,edges);
+            run("clusters",1,[&](){return graph.getClusters().numClusters;});
+            run("clusters_parallel",numThreads,[&](){return graph.getClustersParallel(numThreads).numClusters;});
+        }
+        {
+            typedef DijkstraGraph<T,U,CSRGraph<T,U> > Graph;
+            Graph graph(N,edges);
+            typename Graph::Workspace workspace;
+            auto countReached = [&](const std::vector<U> &distances){
+                return static_cast<uint64_t>(std::count_if(distances.begin(),distances.end(),[](U d){return d != Graph::unreachable;}));
+            };
+            run("dijkstra",1,[&](){return countReached(graph.dijkstraHeap(source).distances);});
+            graph.dijkstraHeap(source,-1,workspace); //first use sizes the workspace
+            run("dijkstra_workspace",1,[&](){
+                graph.dijkstraHeap(source,-1,workspace);
+                uint64_t count = 0;
+                for (uint32_t v = 0; v < N; ++v)
+                    count += (workspace.labels.distance(v) != Graph::unreachable);
+                return count;
+            });
+        }
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    uint64_t maxVertices = (argc > 1) ? std::stoull(argv[1]) : 1000000;
+    std::unique_ptr<std::ofstream> file;
+    if ((argc > 2) && (std::string(argv[2]) != "-"))
+        file = std::make_unique<std::ofstream>(argv[2]);
+    uint32_t numThreads = (argc > 3) ? std::stoul(argv[3]) : defaultThreads();
+    uint32_t degree = (argc > 4) ? std::stoul(argv[4]) : 16;
+    uint32_t seed = (argc > 5) ? std::stoul(argv[5]) : 1;
+    if (file && !(*file)){
+        std::cerr<<"cannot open "<<argv[2]<<std::endl;
+        return 1;
+    }
+    maxVertices = std::min<uint64_t>(maxVertices,std::numeric_limits<uint32_t>::max() / 2);
+    const uint32_t halfDegree = std::max<uint32_t>(1,degree / 2);
+
+    Benchmark benchmark(file ? *file : std::cout,numThreads);
+    for (uint64_t n = 1000; n <= maxVertices; n *= 10){
+        uint32_t scale = static_cast<uint32_t>(std::lround(std::log2(static_cast<double>(n))));
+        uint32_t side = static_cast<uint32_t>(std::lround(std::sqrt(static_cast<double>(n))));
+        std::vector<std::tuple<std::string,uint32_t,std::function<generators::EdgeList<U>()> > > graphs = {
+            {"rmat",1u << scale,[&](){return generators::rmat<U>(scale,halfDegree,seed,maxWeight,numThreads);}},
+            {"grid",side*side,[&](){return generators::grid<U>(side,side,seed,maxWeight,0.9,numThreads);}},
+            {"er",static_cast<uint32_t>(n),[&](){return generators::erdosRenyi<U>(n,halfDegree*n,seed,maxWeight,numThreads);}},
+            {"ba",static_cast<uint32_t>(n),[&](){return generators::barabasiAlbert<U>(n,halfDegree,seed,maxWeight);}}
+        };
+        for (const auto &[name,numVertices,generate] : graphs){
+            generators::EdgeList<U> edges;
+            benchmark.setGraph(name,numVertices,edges);
+            benchmark.run("generate",numThreads,[&](){
+                edges = generate();
+                benchmark.setGraph(name,numVertices,edges); //rate for the generate row is edges generated per second
+                return edges.size();
+            });
+            benchmark.runAll(edges);
+        }
+    }
+    return 0;
+}
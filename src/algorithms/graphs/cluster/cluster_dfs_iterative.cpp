@@ -19,68 +19,22 @@
 
 /*
 
-Finds all connected clusters on a graph with iterative DFS
-
-Input: Graph
-Output: vector of cluster membersip (intger) for all nodes
-
-Time: O(log(V))
-Space: O(log(V))
+Connected clusters of a random graph - sequential DFS and parallel Afforest, checked and timed
 
 */
 
 #include <iostream>
-#include <memory>
 #include <vector>
-#include <stack>
+#include <chrono>
 #include "graph.hpp"
+#include "csr_graph.hpp"
 #include "random.hpp"
+#include "parallel.hpp"
+#include "cluster_dfs_iterative.hpp"
 
 using namespace structures_and_algorithms::structures::graphs;
 using namespace structures_and_algorithms::random;
-
-struct clusterInfo{
-    std::vector<uint32_t> clusterList;
-    uint32_t numClusters;
-};
-
-template<typename T,typename U>
-class GraphCluster : public Graph<T,U>{
-    void search(
-        std::vector<uint32_t> &visited, /*vector recording visitation/cluster*/ 
-        uint32_t u,/*search from node*/
-        uint32_t cluster /*cluster index being recorded*/)
-    {
-        std::stack<int32_t> to_visit;
-        to_visit.push(u);
-        while (!to_visit.empty()){
-            uint32_t current = to_visit.top();
-            to_visit.pop();
-            visited[current]=cluster; //record we've visited u        
-            for (auto it=this->edges[current].begin();it!=this->edges[current].end();++it)// loop over adjacency list of u
-                if (!visited[it->first])
-                    to_visit.push(it->first);
-        }
-    }
-public:
-    GraphCluster(const uint32_t N):Graph<T,U>(N){}
-
-    //entry point function - start from all possible nodes
-    clusterInfo getClusters()
-    {
-        uint32_t N = this->numVertices();
-        std::vector<uint32_t> visited(N,0); // set up visitation/cluster record
-        uint32_t cluster = 0;
-        
-        for (size_t i = 0; i < N; ++i){
-            if (!visited[i]){
-                ++cluster;
-                search(visited,i,cluster); //perform the search from i (if not visited) - return if found
-            }
-        }
-        return {visited,cluster};
-    }
-};
+using namespace structures_and_algorithms::algorithms::graphs;
 
 int main(/*int argc, char* argv[]*/)
 {
@@ -120,5 +74,31 @@ int main(/*int argc, char* argv[]*/)
         std::cout<<std::endl;
     }
 
+    clusterInfo clustersParallel = graph.getClustersParallel();
+    std::cout<<"parallel version agrees: "<<((clustersParallel.numClusters == clusters.numClusters) && (clustersParallel.clusterList == clusters.clusterList))<<std::endl;
+
+    //larger random graph
+    const uint32_t bigN = 1000000;
+    GraphCluster<T,U> bigGraph(bigN);
+    for (uint32_t e = 0; e < bigN; ++e){
+        uint32_t u = bigN*rnd();
+        uint32_t v = bigN*rnd();
+        bigGraph.addEdgeUndirected(u,v);
+    }
+    auto start = std::chrono::steady_clock::now();
+    clusterInfo bigClusters = bigGraph.getClusters();
+    auto mid = std::chrono::steady_clock::now();
+    clusterInfo bigClustersParallel = bigGraph.getClustersParallel();
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<std::endl<<bigN<<" vertices, "<<bigClusters.numClusters<<" clusters"<<std::endl;
+    std::cout<<"getClusters         : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"getClustersParallel : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"agree: "<<((bigClustersParallel.numClusters == bigClusters.numClusters) && (bigClustersParallel.clusterList == bigClusters.clusterList))<<std::endl<<std::endl;
+
+    //same search over the packed CSR representation
+    GraphCluster<T,U,CSRGraph<T,U> > csrGraph(graph);
+    clusterInfo csrClusters = csrGraph.getClusters();
+    std::cout<<"csr graph agrees: "<<((csrClusters.numClusters == clusters.numClusters) && (csrClusters.clusterList == clusters.clusterList))<<std::endl;
+
     return 0;
 }
\ No newline at end of file
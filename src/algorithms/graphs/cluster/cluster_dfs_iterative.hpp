@@ -0,0 +1,175 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Finds all connected clusters on a graph with iterative DFS
+
+Input: Graph
+Output: vector of cluster membersip (intger) for all nodes
+
+Time: O(log(V))
+Space: O(log(V))
+
+Parallel version - getClustersParallel - uses the Afforest approach (Sutton et al.) over a
+lock free union-find (ConcurrentUnionFind), assuming the graph is undirected (every edge
+stored in both directions):
+
+1. Link every vertex to its first couple of neighbours, in parallel - on most graphs this
+   already joins the bulk of the vertices into one large component
+2. Sample some vertices to find which component that is
+3. For every vertex *not* in the large component, link it to all its remaining neighbours, in
+   parallel - edges between two vertices of the large component are skipped entirely, and an
+   edge from the large component to elsewhere is still seen from the other end
+4. Label components 1,2,... in order of their lowest vertex, same as getClusters
+
+*/
+
+#ifndef CLUSTER_DFS_ITERATIVE_H
+#define CLUSTER_DFS_ITERATIVE_H
+
+#include <vector>
+#include <stack>
+#include <unordered_map>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "random.hpp"
+#include "union_find.hpp"
+#include "parallel.hpp"
+
+namespace structures_and_algorithms::algorithms::graphs{
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::structures::disjoint_sets;
+using namespace structures_and_algorithms::parallel;
+
+struct clusterInfo{
+    std::vector<uint32_t> clusterList;
+    uint32_t numClusters;
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph or CSRGraph
+class GraphCluster : public Base{
+    void search(
+        std::vector<uint32_t> &visited, /*vector recording visitation/cluster*/ 
+        uint32_t u,/*search from node*/
+        uint32_t cluster /*cluster index being recorded*/)
+    {
+        std::stack<int32_t> to_visit;
+        to_visit.push(u);
+        visited[u]=cluster;
+        while (!to_visit.empty()){
+            uint32_t current = to_visit.top();
+            to_visit.pop();
+            for (const auto & neighbourData : this->neighbours(current)){// loop over adjacency list of u
+                if (!visited[neighbourData.first]){
+                    visited[neighbourData.first]=cluster; //record when pushed so each vertex is pushed once
+                    to_visit.push(neighbourData.first);
+                }
+            }
+        }
+    }
+public:
+    GraphCluster(const uint32_t N):Base(N){}
+    GraphCluster(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    GraphCluster(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    //entry point function - start from all possible nodes
+    clusterInfo getClusters()
+    {
+        uint32_t N = this->numVertices();
+        std::vector<uint32_t> visited(N,0); // set up visitation/cluster record
+        uint32_t cluster = 0;
+        
+        for (size_t i = 0; i < N; ++i){
+            if (!visited[i]){
+                ++cluster;
+                search(visited,i,cluster); //perform the search from i (if not visited) - return if found
+            }
+        }
+        return {visited,cluster};
+    }
+
+    //parallel Afforest - same result as getClusters for undirected graphs
+    clusterInfo getClustersParallel(uint32_t numThreads = defaultThreads(), uint32_t neighbourRounds = 2)
+    {
+        uint32_t N = this->numVertices();
+        ConcurrentUnionFind sets(N);
+
+        //1. link to first neighbourRounds neighbours
+        parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t u = begin; u < end; ++u){
+                uint32_t k = 0;
+                for (const auto & neighbourData : this->neighbours(u)){
+                    if (k++ == neighbourRounds)
+                        break;
+                    sets.unite(u,neighbourData.first);
+                }
+            }
+        });
+
+        //2. sample for the largest component
+        uint32_t largest = -1;
+        if (N){
+            std::unordered_map<uint32_t,uint32_t> counts;
+            RndUniform rnd(12345);
+            uint32_t bestCount = 0;
+            for (uint32_t i = 0; i < 1024; ++i){
+                uint32_t root = sets.find(static_cast<uint32_t>(N*rnd()) % N);
+                if (++counts[root] > bestCount){
+                    bestCount = counts[root];
+                    largest = root;
+                }
+            }
+        }
+
+        //3. remaining edges of vertices outside it
+        parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t u = begin; u < end; ++u){
+                if (sets.find(u) == largest)
+                    continue;
+                uint32_t k = 0;
+                for (const auto & neighbourData : this->neighbours(u))
+                    if (k++ >= neighbourRounds)
+                        sets.unite(u,neighbourData.first);
+            }
+        });
+
+        //4. label components by lowest vertex
+        std::vector<uint32_t> roots(N);
+        parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t u = begin; u < end; ++u)
+                roots[u] = sets.find(u);
+        });
+        std::vector<uint32_t> label(N,0), clusterList(N);
+        uint32_t cluster = 0;
+        for (uint32_t u = 0; u < N; ++u){
+            if (!label[roots[u]])
+                label[roots[u]] = ++cluster;
+            clusterList[u] = label[roots[u]];
+        }
+        return {std::move(clusterList),cluster};
+    }
+};
+
+}
+
+#endif /*CLUSTER_DFS_ITERATIVE_H*/
@@ -0,0 +1,123 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Cluster membership of a graph receiving a stream of new edges
+
+Input: stream of edges
+Output: cluster queries answered as edges arrive
+
+Rather than re-running a DFS cluster search (cluster_dfs_iterative.cpp) after each batch of
+edges, every edge is fed to IncrementalConnectivity (a union-find) as it arrives, and queries
+are answered in near constant time. Batches may be inserted from many threads.
+
+We check against a from-scratch DFS labelling at the end.
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <stack>
+#include <chrono>
+#include "graph.hpp"
+#include "incremental_connectivity.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::disjoint_sets;
+using namespace structures_and_algorithms::random;
+
+//from scratch labelling for comparison - as GraphCluster::getClusters
+template<typename T,typename U>
+std::vector<uint32_t> clustersDFS(const Graph<T,U> &graph, uint32_t &numClusters)
+{
+    uint32_t N = graph.numVertices();
+    std::vector<uint32_t> visited(N,0);
+    numClusters = 0;
+    for (uint32_t i = 0; i < N; ++i){
+        if (visited[i])
+            continue;
+        ++numClusters;
+        std::stack<uint32_t> to_visit;
+        to_visit.push(i);
+        visited[i] = numClusters;
+        while (!to_visit.empty()){
+            uint32_t current = to_visit.top();
+            to_visit.pop();
+            for (const auto & neighbourData : graph.neighbours(current)){
+                if (!visited[neighbourData.first]){
+                    visited[neighbourData.first] = numClusters;
+                    to_visit.push(neighbourData.first);
+                }
+            }
+        }
+    }
+    return visited;
+}
+
+int main(/*int argc, char* argv[]*/)
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    const uint32_t N = 10;
+    RndUniform rnd;
+
+    IncrementalConnectivity clusters(N);
+    std::cout<<"edge  -> clusters"<<std::endl;
+    for (uint32_t e = 0; e < 8; ++e){
+        uint32_t u = N*rnd();
+        uint32_t v = N*rnd();
+        clusters.addEdge(u,v);
+        std::cout<<u<<" "<<v<<" -> "<<clusters.numClusters()<<std::endl;
+    }
+    std::cout<<"0 and 1 in same cluster: "<<clusters.sameCluster(0,1)<<std::endl;
+    std::cout<<"cluster of 0: "<<clusters.clusterOf(0)<<std::endl;
+    std::cout<<"out of range vertex rejected: "<<((!clusters.sameCluster(0,N)) && (clusters.clusterOf(N) == N))<<std::endl;
+
+    //stream of batches, querying in between
+    const uint32_t bigN = 1000000;
+    const uint32_t batchSize = 100000;
+    const uint32_t numBatches = 10;
+    IncrementalConnectivity bigClusters(bigN);
+    Graph<T,U> graph(bigN);
+    double ingestMs = 0;
+    for (uint32_t b = 0; b < numBatches; ++b){
+        std::vector<std::pair<uint32_t,uint32_t> > batch(batchSize);
+        for (auto & e : batch){
+            e = {static_cast<uint32_t>(bigN*rnd()),static_cast<uint32_t>(bigN*rnd())};
+            graph.addEdgeUndirected(e.first,e.second);
+        }
+        auto start = std::chrono::steady_clock::now();
+        bigClusters.addEdges(batch);
+        auto end = std::chrono::steady_clock::now();
+        ingestMs += std::chrono::duration<double,std::milli>(end-start).count();
+        std::cout<<"after batch "<<b<<": "<<bigClusters.numClusters()<<" clusters"<<std::endl;
+    }
+
+    uint32_t numClustersDFS = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> labelsDFS = clustersDFS(graph,numClustersDFS);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<"incremental: "<<ingestMs/numBatches<<" ms per batch of "<<batchSize<<" edges"<<std::endl;
+    std::cout<<"from scratch DFS: "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms per recompute"<<std::endl;
+    std::cout<<"agree: "<<((numClustersDFS == bigClusters.numClusters()) && (labelsDFS == bigClusters.labels()))<<std::endl;
+
+    return 0;
+}
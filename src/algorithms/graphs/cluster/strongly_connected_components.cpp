@@ -0,0 +1,583 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Strongly connected components (SCC) and topological sort of directed graphs - no recursion
+
+A strongly connected component is a maximal set of vertices where every vertex can reach
+every other. All searches here keep their own explicit stack, so depth is bounded by memory,
+not the call stack - a single path of 10^8 vertices is fine.
+
+tarjan - one DFS. Each vertex gets an index in visit order and a lowlink, the lowest index
+reachable through its DFS subtree plus one back/cross edge into a vertex still on the
+component stack. A vertex whose lowlink equals its own index is the root of an SCC, which is
+everything above it on the component stack. The recursion becomes a stack of
+(vertex, next neighbour) frames; "on the component stack" is "visited and no component yet"
+so no extra array is needed.
+
+kosaraju - DFS recording post order, then DFS on the transposed graph taking roots in
+reverse post order: each search of the second pass finds exactly one SCC. Needs the reverse
+edges - a transposed CSRGraph from TransposeCache, built on first use and kept with the graph -
+but both passes are plain stack searches.
+
+topologicalSort - Kahn's algorithm: repeatedly output vertices with no remaining incoming
+edges. If some vertices are never output the graph has a cycle.
+
+getSCCParallel - forward-backward (FW-BW) with trimming (Hong et al.)
+
+1. Trim: a vertex with no incoming or no outgoing edges inside its set is an SCC by itself -
+   repeat a few parallel rounds (removes most vertices of sparse real graphs)
+2. Pick a pivot (high in x out degree), find its forward reachable set FW and backward
+   reachable set BW with level synchronous parallel BFS. FW ∩ BW is the pivot's SCC.
+   Every other SCC lies entirely inside FW \ BW, BW \ FW or the rest.
+3. Those three sets are independent - threads take sets from a shared queue and repeat the
+   FW-BW split on each with a sequential search.
+
+Step 2 uses all threads on the (usually giant) first SCC, step 3 is task parallel over the
+many small ones that remain.
+
+All methods label components 1,2,... in order of their lowest vertex, as getClusters does,
+so results can be compared directly.
+
+Time: O(V+E) (tarjan, kosaraju, topologicalSort), O((V+E) log V) expected (FW-BW)
+Space: O(V) (tarjan, topologicalSort), O(V+E) (kosaraju, FW-BW - the transposed graph)
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "transpose_cache.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+struct componentInfo{
+    std::vector<uint32_t> componentList;
+    uint32_t numComponents;
+};
+
+struct topologicalInfo{
+    std::vector<uint32_t> order; //all vertices if acyclic, otherwise those not behind a cycle
+    bool acyclic;
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph or CSRGraph
+class GraphSCC : public Base{
+    static constexpr uint32_t UNSET = std::numeric_limits<uint32_t>::max();
+
+    TransposeCache<T,U> transpose; //incoming edges - built on first use, rebuilt if the graph changes
+
+    //relabel arbitrary distinct component ids to 1,2,... by lowest vertex
+    static componentInfo relabel(std::vector<uint32_t> &&component, const uint32_t maxId)
+    {
+        std::vector<uint32_t> label(maxId,0);
+        uint32_t count = 0;
+        for (auto &c : component){
+            if (!label[c])
+                label[c] = ++count;
+            c = label[c];
+        }
+        return {std::move(component),count};
+    }
+
+    //DFS frame - the vertex and where we are in its adjacency list
+    typedef decltype(std::declval<const Base&>().neighbours(0).begin()) NeighbourIt;
+    struct Frame{
+        uint32_t vertex;
+        NeighbourIt next, end;
+    };
+
+    Frame frame(const uint32_t u) const
+    {
+        const auto &range = this->neighbours(u);
+        return {u,range.begin(),range.end()};
+    }
+
+public:
+    GraphSCC(const uint32_t N):Base(N){}
+    GraphSCC(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    GraphSCC(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    componentInfo tarjan() const
+    {
+        uint32_t N = this->numVertices();
+        std::vector<uint32_t> index(N,UNSET), lowlink(N), component(N,UNSET);
+        std::vector<uint32_t> componentStack;
+        std::vector<Frame> callStack;
+        uint32_t counter = 0;
+
+        for (uint32_t s = 0; s < N; ++s){
+            if (index[s] != UNSET)
+                continue;
+            index[s] = lowlink[s] = counter++;
+            componentStack.push_back(s);
+            callStack.push_back(frame(s));
+            while (!callStack.empty()){
+                Frame &top = callStack.back();
+                uint32_t u = top.vertex;
+                if (top.next != top.end){
+                    uint32_t w = (*top.next).first;
+                    ++top.next;
+                    if (index[w] == UNSET){ //"recurse" - top is invalidated by push_back
+                        index[w] = lowlink[w] = counter++;
+                        componentStack.push_back(w);
+                        callStack.push_back(frame(w));
+                    }
+                    else if (component[w] == UNSET) //still on the component stack
+                        lowlink[u] = std::min(lowlink[u],index[w]);
+                    continue;
+                }
+                //all neighbours done - "return"
+                callStack.pop_back();
+                if (lowlink[u] == index[u]){
+                    uint32_t w;
+                    do {
+                        w = componentStack.back();
+                        componentStack.pop_back();
+                        component[w] = u;
+                    } while (w != u);
+                }
+                if (!callStack.empty()){
+                    uint32_t parent = callStack.back().vertex;
+                    lowlink[parent] = std::min(lowlink[parent],lowlink[u]);
+                }
+            }
+        }
+        return relabel(std::move(component),N);
+    }
+
+    componentInfo kosaraju() const
+    {
+        uint32_t N = this->numVertices();
+        //1. post order of a DFS over the graph
+        std::vector<uint32_t> postOrder;
+        postOrder.reserve(N);
+        {
+            std::vector<char> visited(N,0);
+            std::vector<Frame> callStack;
+            for (uint32_t s = 0; s < N; ++s){
+                if (visited[s])
+                    continue;
+                visited[s] = 1;
+                callStack.push_back(frame(s));
+                while (!callStack.empty()){
+                    Frame &top = callStack.back();
+                    if (top.next != top.end){
+                        uint32_t w = (*top.next).first;
+                        ++top.next;
+                        if (!visited[w]){
+                            visited[w] = 1;
+                            callStack.push_back(frame(w));
+                        }
+                        continue;
+                    }
+                    postOrder.push_back(top.vertex);
+                    callStack.pop_back();
+                }
+            }
+        }
+        //2. searches on the transpose in reverse post order - one SCC each
+        auto incoming = transpose.get(*this);
+        const CSRGraph<T,U> &reverse = *incoming;
+        std::vector<uint32_t> component(N,UNSET), toVisit;
+        for (auto it = postOrder.rbegin(); it != postOrder.rend(); ++it){
+            uint32_t root = *it;
+            if (component[root] != UNSET)
+                continue;
+            component[root] = root;
+            toVisit.push_back(root);
+            while (!toVisit.empty()){
+                uint32_t v = toVisit.back();
+                toVisit.pop_back();
+                for (const auto & sourceData : reverse.neighbours(v)){
+                    uint32_t w = sourceData.first;
+                    if (component[w] == UNSET){
+                        component[w] = root;
+                        toVisit.push_back(w);
+                    }
+                }
+            }
+        }
+        return relabel(std::move(component),N);
+    }
+
+    //Kahn's algorithm - ties broken by lowest vertex first out of the queue (FIFO)
+    topologicalInfo topologicalSort() const
+    {
+        uint32_t N = this->numVertices();
+        std::vector<uint32_t> inDegree(N,0);
+        for (uint32_t u = 0; u < N; ++u)
+            for (const auto & neighbourData : this->neighbours(u))
+                ++inDegree[neighbourData.first];
+        std::vector<uint32_t> order;
+        order.reserve(N);
+        for (uint32_t u = 0; u < N; ++u)
+            if (!inDegree[u])
+                order.push_back(u);
+        for (size_t head = 0; head < order.size(); ++head) //order doubles as the queue
+            for (const auto & neighbourData : this->neighbours(order[head]))
+                if (!--inDegree[neighbourData.first])
+                    order.push_back(neighbourData.first);
+        bool acyclic = (order.size() == N);
+        return {std::move(order),acyclic};
+    }
+
+    //parallel forward-backward SCC with trimming
+    componentInfo getSCCParallel(uint32_t numThreads = defaultThreads(), const uint32_t trimRounds = 3, const size_t queueTaskSize = 4096) const
+    {
+        uint32_t N = this->numVertices();
+        numThreads = std::max<uint32_t>(1,numThreads);
+        const uint32_t DONE = UNSET;
+        auto incoming = transpose.get(*this);
+        const CSRGraph<T,U> &reverse = *incoming;
+        //set each vertex is in - vertices of different sets are never in the same SCC
+        //written only by the thread owning the vertex's set, read by others (hence atomic)
+        std::vector<std::atomic<uint32_t> > set(N);
+        std::vector<uint32_t> component(N,UNSET);
+        std::atomic<uint32_t> nextSet(1);
+        parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t v = begin; v < end; ++v)
+                set[v].store(0,std::memory_order_relaxed);
+        });
+        auto setOf = [&](const uint32_t v){return set[v].load(std::memory_order_relaxed);};
+        auto finish = [&](const uint32_t v, const uint32_t id){
+            component[v] = id;
+            set[v].store(DONE,std::memory_order_relaxed);
+        };
+
+        //1. trim vertices with no in or out edges inside their set
+        for (uint32_t round = 0; round < trimRounds; ++round){
+            std::atomic<bool> changed(false);
+            parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+                bool trimmed = false;
+                for (size_t v = begin; v < end; ++v){
+                    uint32_t s = setOf(v);
+                    if (s == DONE)
+                        continue;
+                    bool hasOut = false, hasIn = false;
+                    for (const auto & neighbourData : this->neighbours(v)){
+                        if (setOf(neighbourData.first) == s){
+                            hasOut = true;
+                            break;
+                        }
+                    }
+                    if (hasOut){
+                        for (const auto & sourceData : reverse.neighbours(v)){
+                            if (setOf(sourceData.first) == s){
+                                hasIn = true;
+                                break;
+                            }
+                        }
+                    }
+                    if (!hasOut || !hasIn){
+                        finish(v,v);
+                        trimmed = true;
+                    }
+                }
+                if (trimmed)
+                    changed.store(true,std::memory_order_relaxed);
+            },4096);
+            if (!changed)
+                break;
+        }
+
+        //2. giant SCC - pivot with the largest in x out degree, parallel BFS both ways
+        uint32_t pivot = UNSET;
+        uint64_t best = 0;
+        for (uint32_t v = 0; v < N; ++v){
+            if (setOf(v) == DONE)
+                continue;
+            uint64_t score = (reverse.neighbours(v).size() + 1) * static_cast<uint64_t>(this->neighbours(v).size() + 1);
+            if ((pivot == UNSET) || (score > best)){
+                pivot = v;
+                best = score;
+            }
+        }
+        if (pivot != UNSET){
+            const uint32_t FW = nextSet++, BW = nextSet++, SCC = nextSet++;
+            //level synchronous BFS from pivot moving vertices from set "from" to set "to"
+            auto parallelBFS = [&](bool forward, const uint32_t from, const uint32_t alsoFrom, const uint32_t to, const uint32_t alsoTo){
+                std::vector<uint32_t> frontier{pivot};
+                std::vector<std::vector<uint32_t> > next(numThreads);
+                auto claim = [&](const uint32_t w, std::vector<uint32_t> &out){
+                    uint32_t expected = from;
+                    if (set[w].compare_exchange_strong(expected,to,std::memory_order_relaxed)){
+                        out.push_back(w);
+                        return;
+                    }
+                    if ((alsoFrom != from) && (expected == alsoFrom) && set[w].compare_exchange_strong(expected,alsoTo,std::memory_order_relaxed))
+                        out.push_back(w);
+                };
+                while (!frontier.empty()){
+                    parallelFor(frontier.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+                        for (size_t i = begin; i < end; ++i){
+                            uint32_t u = frontier[i];
+                            if (forward){
+                                for (const auto & neighbourData : this->neighbours(u))
+                                    claim(neighbourData.first,next[t]);
+                            }
+                            else {
+                                for (const auto & sourceData : reverse.neighbours(u))
+                                    claim(sourceData.first,next[t]);
+                            }
+                        }
+                    },256);
+                    frontier.clear();
+                    for (auto &part : next){
+                        frontier.insert(frontier.end(),part.begin(),part.end());
+                        part.clear();
+                    }
+                }
+            };
+            set[pivot].store(FW,std::memory_order_relaxed);
+            parallelBFS(true,0,0,FW,FW);
+            set[pivot].store(SCC,std::memory_order_relaxed);
+            parallelBFS(false,0,FW,BW,SCC);
+            parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+                for (size_t v = begin; v < end; ++v)
+                    if (setOf(v) == SCC)
+                        finish(v,pivot);
+            });
+        }
+
+        //3. remaining sets, task parallel
+        std::deque<std::vector<uint32_t> > queue;
+        {
+            std::vector<uint32_t> first;
+            std::vector<std::vector<uint32_t> > bySet(4);
+            for (uint32_t v = 0; v < N; ++v){
+                uint32_t s = setOf(v);
+                if (s != DONE)
+                    bySet[s].push_back(v);
+            }
+            for (auto &vertices : bySet)
+                if (!vertices.empty())
+                    queue.push_back(std::move(vertices));
+        }
+        std::mutex lock;
+        std::condition_variable wake;
+        uint32_t active = 0;
+
+        //FW-BW split of one set - sequential, returns the up to three remaining sets
+        auto split = [&](std::vector<uint32_t> &vertices, std::vector<std::vector<uint32_t> > &out){
+            if (vertices.size() == 1){
+                finish(vertices[0],vertices[0]);
+                return;
+            }
+            const uint32_t s = setOf(vertices[0]);
+            const uint32_t FW = nextSet.fetch_add(3,std::memory_order_relaxed), BW = FW + 1, SCC = FW + 2;
+            const uint32_t root = vertices[0];
+            std::vector<uint32_t> toVisit{root};
+            set[root].store(FW,std::memory_order_relaxed);
+            while (!toVisit.empty()){
+                uint32_t u = toVisit.back();
+                toVisit.pop_back();
+                for (const auto & neighbourData : this->neighbours(u)){
+                    uint32_t w = neighbourData.first;
+                    if (setOf(w) == s){
+                        set[w].store(FW,std::memory_order_relaxed);
+                        toVisit.push_back(w);
+                    }
+                }
+            }
+            toVisit.push_back(root);
+            set[root].store(SCC,std::memory_order_relaxed);
+            while (!toVisit.empty()){
+                uint32_t u = toVisit.back();
+                toVisit.pop_back();
+                for (const auto & sourceData : reverse.neighbours(u)){
+                    uint32_t w = sourceData.first;
+                    uint32_t sw = setOf(w);
+                    if ((sw == s) || (sw == FW)){
+                        set[w].store(sw == s ? BW : SCC,std::memory_order_relaxed);
+                        toVisit.push_back(w);
+                    }
+                }
+            }
+            std::vector<uint32_t> rest, forward, backward;
+            for (uint32_t v : vertices){
+                uint32_t sv = setOf(v);
+                if (sv == SCC)
+                    finish(v,root);
+                else if (sv == FW)
+                    forward.push_back(v);
+                else if (sv == BW)
+                    backward.push_back(v);
+                else
+                    rest.push_back(v);
+            }
+            for (auto *part : {&rest,&forward,&backward})
+                if (!part->empty())
+                    out.push_back(std::move(*part));
+        };
+
+        auto worker = [&](){
+            std::vector<std::vector<uint32_t> > local, produced;
+            std::unique_lock<std::mutex> guard(lock);
+            while (true){
+                wake.wait(guard,[&](){return !queue.empty() || !active;});
+                if (queue.empty())
+                    break;
+                local.push_back(std::move(queue.front()));
+                queue.pop_front();
+                ++active;
+                guard.unlock();
+                while (!local.empty()){
+                    std::vector<uint32_t> vertices = std::move(local.back());
+                    local.pop_back();
+                    split(vertices,produced);
+                    for (auto &part : produced){
+                        if (part.size() >= queueTaskSize){ //share big sets
+                            std::lock_guard<std::mutex> shareGuard(lock);
+                            queue.push_back(std::move(part));
+                            wake.notify_one();
+                        }
+                        else
+                            local.push_back(std::move(part));
+                    }
+                    produced.clear();
+                }
+                guard.lock();
+                if (!--active && queue.empty())
+                    wake.notify_all();
+            }
+        };
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < numThreads; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &thread : threads)
+            thread.join();
+
+        return relabel(std::move(component),N);
+    }
+};
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    RndUniform rnd;
+
+    //small example: {0,1,2} cycle -> {3,4} cycle -> 5, plus 6 on its own pointing at 0
+    GraphSCC<T,U> graph(7);
+    graph.addEdge(0,1);
+    graph.addEdge(1,2);
+    graph.addEdge(2,0);
+    graph.addEdge(2,3);
+    graph.addEdge(3,4);
+    graph.addEdge(4,3);
+    graph.addEdge(4,5);
+    graph.addEdge(6,0);
+
+    componentInfo components = graph.tarjan();
+    std::cout<<components.numComponents<<" strongly connected components"<<std::endl;
+    for (uint32_t c = 1; c <= components.numComponents; ++c){
+        std::cout<<c<<" : ";
+        for (size_t i = 0; i < components.componentList.size(); ++i)
+            if (components.componentList[i] == c)
+                std::cout<<i<<" ";
+        std::cout<<std::endl;
+    }
+    componentInfo kosarajuComponents = graph.kosaraju();
+    componentInfo parallelComponents = graph.getSCCParallel();
+    std::cout<<"kosaraju agrees: "<<(kosarajuComponents.componentList == components.componentList)<<std::endl;
+    std::cout<<"parallel agrees: "<<(parallelComponents.componentList == components.componentList)<<std::endl;
+    std::cout<<"has topological order: "<<graph.topologicalSort().acyclic<<std::endl;
+    graph.addEdge(5,6); //closes the cycle 0 -> ... -> 6 -> 0, one SCC - the cached transpose must follow
+    std::cout<<"after adding 5 -> 6: "<<graph.tarjan().numComponents<<" (tarjan), "<<graph.kosaraju().numComponents
+             <<" (kosaraju), "<<graph.getSCCParallel().numComponents<<" (parallel)"<<std::endl;
+
+    //random sparse directed graph - a giant SCC plus many small ones
+    const uint32_t N = 2000000;
+    std::vector<std::pair<uint32_t,uint32_t> > edgeList(2*N);
+    for (auto & [u,v] : edgeList){
+        u = N*rnd();
+        v = N*rnd();
+    }
+    GraphSCC<T,U,CSRGraph<T,U> > big(N,edgeList);
+    auto timed = [](auto &&f){
+        auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        auto end = std::chrono::steady_clock::now();
+        return std::make_pair(result,std::chrono::duration<double,std::milli>(end-start).count());
+    };
+    auto [tarjanResult,tarjanTime] = timed([&](){return big.tarjan();});
+    auto [kosarajuResult,kosarajuTime] = timed([&](){return big.kosaraju();});
+    auto [parallelResult,parallelTime] = timed([&](){return big.getSCCParallel();});
+    uint32_t giant = 0;
+    {
+        std::vector<uint32_t> sizes(tarjanResult.numComponents + 1,0);
+        for (uint32_t c : tarjanResult.componentList)
+            giant = std::max(giant,++sizes[c]);
+    }
+    std::cout<<std::endl<<N<<" vertices, "<<big.numEdges()<<" edges: "<<tarjanResult.numComponents<<" SCCs, largest "<<giant<<std::endl;
+    std::cout<<"tarjan         : "<<tarjanTime<<" ms"<<std::endl;
+    std::cout<<"kosaraju       : "<<kosarajuTime<<" ms"<<std::endl;
+    std::cout<<"getSCCParallel : "<<parallelTime<<" ms ("<<defaultThreads()<<" threads)"<<std::endl;
+    std::cout<<"agree: "<<((kosarajuResult.componentList == tarjanResult.componentList) && (parallelResult.componentList == tarjanResult.componentList))<<std::endl;
+
+    //one cycle through every vertex - a recursive DFS would need N stack frames
+    const uint32_t cycleN = 10000000;
+    std::vector<std::pair<uint32_t,uint32_t> > cycle(cycleN);
+    for (uint32_t u = 0; u < cycleN; ++u)
+        cycle[u] = {u,(u + 1) % cycleN};
+    GraphSCC<T,U,CSRGraph<T,U> > deep(cycleN,cycle);
+    cycle = {};
+    componentInfo deepComponents = deep.tarjan();
+    std::cout<<std::endl<<cycleN<<" vertex cycle: "<<deepComponents.numComponents<<" SCC (tarjan), "
+             <<deep.kosaraju().numComponents<<" (kosaraju), "<<deep.getSCCParallel().numComponents<<" (parallel)"<<std::endl;
+
+    //topological sort of a random DAG - edges only from lower to higher vertex
+    const uint32_t dagN = 1000000;
+    std::vector<std::pair<uint32_t,uint32_t> > dagEdges(4*dagN);
+    for (auto & [u,v] : dagEdges){
+        u = dagN*rnd();
+        v = dagN*rnd();
+        if (u > v)
+            std::swap(u,v);
+    }
+    GraphSCC<T,U,CSRGraph<T,U> > dag(dagN,dagEdges);
+    topologicalInfo sorted = dag.topologicalSort();
+    std::vector<uint32_t> position(dagN);
+    for (uint32_t i = 0; i < sorted.order.size(); ++i)
+        position[sorted.order[i]] = i;
+    bool valid = sorted.acyclic;
+    for (const auto & [u,v] : dagEdges)
+        valid = valid && ((u == v) || (position[u] < position[v]));
+    std::cout<<"topological order of "<<dagN<<" vertex DAG valid: "<<valid<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,620 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Maximum flow / minimum cut - push-relabel (highest label) and Dinic
+
+Edge weights are read as capacities. The maximum flow from s to t equals the capacity of the
+minimum cut: the cheapest set of edges whose removal disconnects t from s.
+
+Both algorithms work on the residual network: every edge u -> v of capacity c becomes an arc
+u -> v with residual capacity c and a paired arc v -> u with residual capacity 0. Sending f
+along an arc moves f of residual capacity to its pair (so flow can later be "undone").
+The arcs are held CSR style - all arcs out of a vertex contiguous, each with the index of its
+pair.
+
+Push-relabel (Goldberg-Tarjan): flood the network from s and let excess drain towards t.
+
+    height h(v) - a lower bound on the residual distance to t; h(s) = |V|, h(t) = 0
+    excess e(v) - inflow minus outflow, may be positive (a "preflow")
+    push     - an active vertex (e > 0) sends min(e, residual) along an arc to a vertex one lower
+    relabel  - no such arc: raise h(v) to 1 + the lowest residual neighbour
+
+Heuristics that make it fast in practice:
+
+1) highest label - always discharge the active vertex with the greatest height
+   (O(V^2 sqrt(E)) bound). Active vertices are kept in per height buckets
+2) global relabel - every so often set exact heights h(v) = residual distance to t with a
+   reverse BFS from t, since relabels only raise heights one step at a time
+3) gap - if no vertex is left at some height k, vertices above k can never reach t. Lift them
+   to |V| at once, which takes them out of play
+
+Only the first phase is run - once no active vertex can reach t, e(t) is the maximum flow
+value and the minimum cut is fixed (the leftover excess would only be returned to s).
+
+Dinic: repeat - BFS from s for level(v) = residual distance, then send a blocking flow along
+arcs going up exactly one level. The DFS for augmenting paths is iterative (explicit arc stack,
+per vertex current arc pointer) so deep networks cannot overflow the call stack. O(V^2 E), and
+O(E sqrt(V)) on unit capacity networks.
+
+Minimum cut: after either, the vertices that can still reach t in the residual network form the
+sink side. Every original edge from the source side to the sink side is saturated, and their
+capacities sum to the maximum flow.
+
+DIMACS max flow format (readDimacs) - 1 based vertices:
+
+    c comment
+    p max <vertices> <arcs>
+    n <vertex> s
+    n <vertex> t
+    a <from> <to> <capacity>
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+
+//struct for a minimum s-t cut
+template<typename U>
+struct MinCut{
+    U value;                                              //capacity of the cut = maximum flow
+    std::vector<char> sourceSide;                         //1 for vertices on the s side
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edges;  //cut edges (u,v,capacity), u on the s side
+};
+
+//residual network - arcs out of v at [first[v], first[v+1])
+template<typename U>
+class FlowNetwork{
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    uint32_t N;
+    std::vector<uint64_t> first;
+    std::vector<uint32_t> head;     //target of each arc
+    std::vector<uint64_t> pair;     //index of the reverse arc
+    std::vector<U> capacity;        //original capacity (0 for reverse arcs)
+    std::vector<U> residual;
+
+    //push-relabel state
+    std::vector<uint32_t> height;
+    std::vector<U> excess;
+    std::vector<uint64_t> current;                        //current arc
+    std::vector<uint32_t> activeHead, activeNext;         //active vertices by height - singly linked
+    std::vector<uint32_t> levelHead, levelNext, levelPrev;//all vertices by height (< N) - doubly linked
+    uint32_t maxActive, maxLevel;
+
+    void addActive(const uint32_t v)
+    {
+        activeNext[v] = activeHead[height[v]];
+        activeHead[height[v]] = v;
+        maxActive = std::max(maxActive,height[v]);
+    }
+
+    void addLevel(const uint32_t v)
+    {
+        const uint32_t h = height[v];
+        levelPrev[v] = NONE;
+        levelNext[v] = levelHead[h];
+        if (levelHead[h] != NONE)
+            levelPrev[levelHead[h]] = v;
+        levelHead[h] = v;
+        maxLevel = std::max(maxLevel,h);
+    }
+
+    void removeLevel(const uint32_t v)
+    {
+        if (levelPrev[v] != NONE)
+            levelNext[levelPrev[v]] = levelNext[v];
+        else
+            levelHead[height[v]] = levelNext[v];
+        if (levelNext[v] != NONE)
+            levelPrev[levelNext[v]] = levelPrev[v];
+    }
+
+    //reverse BFS from t over arcs with residual capacity - exact heights, rebuilds all buckets
+    void globalRelabel(const uint32_t s, const uint32_t t)
+    {
+        std::fill(height.begin(),height.end(),N);
+        std::fill(activeHead.begin(),activeHead.end(),NONE);
+        std::fill(levelHead.begin(),levelHead.end(),NONE);
+        maxActive = maxLevel = 0;
+        std::vector<uint32_t> queue{t};
+        height[t] = 0;
+        for (size_t i = 0; i < queue.size(); ++i){
+            uint32_t w = queue[i];
+            for (uint64_t a = first[w]; a < first[w + 1]; ++a){
+                uint32_t v = head[a];
+                if ((height[v] == N) && (v != s) && (residual[pair[a]] > U())){ //v -> w has capacity left
+                    height[v] = height[w] + 1;
+                    queue.push_back(v);
+                    current[v] = first[v];
+                    addLevel(v);
+                    if (excess[v] > U())
+                        addActive(v);
+                }
+            }
+        }
+    }
+
+    //sink side of the residual network - vertices that can reach t
+    std::vector<char> reachesSink(const uint32_t t) const
+    {
+        std::vector<char> reaches(N,0);
+        std::vector<uint32_t> queue{t};
+        reaches[t] = 1;
+        for (size_t i = 0; i < queue.size(); ++i){
+            uint32_t w = queue[i];
+            for (uint64_t a = first[w]; a < first[w + 1]; ++a){
+                uint32_t v = head[a];
+                if (!reaches[v] && (residual[pair[a]] > U())){
+                    reaches[v] = 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        return reaches;
+    }
+
+public:
+    template<typename G>
+    FlowNetwork(const G &graph):N(graph.numVertices()),first(N + 1,0)
+    {
+        for (uint32_t u = 0; u < N; ++u){
+            for (const auto & neighbourData : graph.neighbours(u)){
+                ++first[u + 1];
+                ++first[neighbourData.first + 1];
+            }
+        }
+        for (uint32_t v = 0; v < N; ++v)
+            first[v + 1] += first[v];
+        head.resize(first[N]);
+        pair.resize(first[N]);
+        capacity.resize(first[N]);
+        std::vector<uint64_t> position(first.begin(),first.end() - 1);
+        for (uint32_t u = 0; u < N; ++u){
+            for (const auto & neighbourData : graph.neighbours(u)){
+                uint32_t v = neighbourData.first;
+                uint64_t forward = position[u]++, backward = position[v]++;
+                head[forward] = v;
+                head[backward] = u;
+                pair[forward] = backward;
+                pair[backward] = forward;
+                capacity[forward] = neighbourData.second;
+                capacity[backward] = U();
+            }
+        }
+    }
+
+    size_t numArcs() const noexcept
+    {
+        return head.size();
+    }
+
+    //highest label push-relabel, first phase - returns the maximum flow value
+    U pushRelabel(const uint32_t s, const uint32_t t)
+    {
+        residual = capacity;
+        height.assign(N,0);
+        excess.assign(N,U());
+        current.assign(first.begin(),first.end() - 1);
+        activeHead.assign(N + 1,NONE);
+        activeNext.assign(N,NONE);
+        levelHead.assign(N + 1,NONE);
+        levelNext.assign(N,NONE);
+        levelPrev.assign(N,NONE);
+        if ((s >= N) || (t >= N) || (s == t))
+            return U();
+        //saturate every arc out of s
+        for (uint64_t a = first[s]; a < first[s + 1]; ++a){
+            U delta = residual[a];
+            residual[a] -= delta;
+            residual[pair[a]] += delta;
+            excess[head[a]] += delta;
+        }
+        globalRelabel(s,t);
+        height[s] = N;
+
+        const size_t relabelPeriod = 6*static_cast<size_t>(N) + head.size()/2; //work between global relabels (as in hipr)
+        size_t work = 0;
+        while (maxActive > 0 || activeHead[0] != NONE){
+            uint32_t v = activeHead[maxActive];
+            if (v == NONE){
+                if (maxActive == 0)
+                    break;
+                --maxActive;
+                continue;
+            }
+            activeHead[maxActive] = activeNext[v];
+            if (height[v] >= N) //lifted by a gap since it was queued
+                continue;
+            //discharge v
+            while (excess[v] > U()){
+                uint64_t a = current[v];
+                const uint64_t end = first[v + 1];
+                for (; a < end; ++a){
+                    uint32_t w = head[a];
+                    if ((residual[a] > U()) && (height[w] + 1 == height[v])){
+                        U delta = std::min(excess[v],residual[a]);
+                        if ((w != t) && (excess[w] == U()))
+                            addActive(w);
+                        residual[a] -= delta;
+                        residual[pair[a]] += delta;
+                        excess[v] -= delta;
+                        excess[w] += delta;
+                        if (excess[v] == U())
+                            break;
+                    }
+                }
+                current[v] = a;
+                if (excess[v] == U())
+                    break;
+                //relabel
+                const uint32_t oldHeight = height[v];
+                uint32_t newHeight = N;
+                uint64_t newCurrent = first[v];
+                for (uint64_t b = first[v]; b < end; ++b){
+                    if ((residual[b] > U()) && (height[head[b]] + 1 < newHeight)){
+                        newHeight = height[head[b]] + 1;
+                        newCurrent = b;
+                    }
+                }
+                work += 12 + end - first[v];
+                removeLevel(v);
+                if (levelHead[oldHeight] == NONE){ //gap - everything above oldHeight is cut off from t
+                    for (uint32_t h = oldHeight + 1; h <= maxLevel; ++h){
+                        for (uint32_t u = levelHead[h]; u != NONE; u = levelNext[u])
+                            height[u] = N;
+                        levelHead[h] = NONE;
+                        activeHead[h] = NONE;
+                    }
+                    maxLevel = oldHeight ? oldHeight - 1 : 0;
+                    height[v] = N;
+                    break;
+                }
+                height[v] = newHeight;
+                if (newHeight >= N)
+                    break;
+                current[v] = newCurrent;
+                addLevel(v);
+            }
+            if (work > relabelPeriod){
+                work = 0;
+                globalRelabel(s,t);
+            }
+        }
+        return excess[t];
+    }
+
+    //Dinic - returns the maximum flow value
+    U dinic(const uint32_t s, const uint32_t t)
+    {
+        residual = capacity;
+        if ((s >= N) || (t >= N) || (s == t))
+            return U();
+        std::vector<uint32_t> level(N), queue;
+        std::vector<uint64_t> path; //arcs from s
+        current.resize(N);
+        U flow = U();
+        while (true){
+            //levels
+            std::fill(level.begin(),level.end(),NONE);
+            level[s] = 0;
+            queue.assign(1,s);
+            for (size_t i = 0; (i < queue.size()) && (level[t] == NONE); ++i){
+                uint32_t u = queue[i];
+                for (uint64_t a = first[u]; a < first[u + 1]; ++a){
+                    if ((residual[a] > U()) && (level[head[a]] == NONE)){
+                        level[head[a]] = level[u] + 1;
+                        queue.push_back(head[a]);
+                    }
+                }
+            }
+            if (level[t] == NONE)
+                return flow;
+            std::copy(first.begin(),first.end() - 1,current.begin());
+            //blocking flow - iterative DFS
+            path.clear();
+            uint32_t u = s;
+            while (true){
+                if (u == t){
+                    U delta = residual[path[0]];
+                    for (uint64_t a : path)
+                        delta = std::min(delta,residual[a]);
+                    size_t retreatTo = path.size();
+                    for (size_t i = 0; i < path.size(); ++i){
+                        residual[path[i]] -= delta;
+                        residual[pair[path[i]]] += delta;
+                        if ((residual[path[i]] == U()) && (retreatTo == path.size()))
+                            retreatTo = i; //first saturated arc - continue from its tail
+                    }
+                    flow += delta;
+                    path.resize(retreatTo);
+                    u = path.empty() ? s : head[path.back()];
+                    continue;
+                }
+                uint64_t &a = current[u];
+                for (; a < first[u + 1]; ++a)
+                    if ((residual[a] > U()) && (level[head[a]] == level[u] + 1))
+                        break;
+                if (a < first[u + 1]){ //advance
+                    path.push_back(a);
+                    u = head[a];
+                    continue;
+                }
+                //dead end - retreat
+                level[u] = NONE;
+                if (path.empty())
+                    break;
+                path.pop_back();
+                u = path.empty() ? s : head[path.back()];
+                ++current[u];
+            }
+        }
+    }
+
+    //after pushRelabel or dinic
+    MinCut<U> minCut(const uint32_t t) const
+    {
+        MinCut<U> cut{U(),std::vector<char>(N,0),{}};
+        if (t >= N)
+            return cut;
+        std::vector<char> sinkSide = reachesSink(t);
+        for (uint32_t u = 0; u < N; ++u)
+            cut.sourceSide[u] = !sinkSide[u];
+        for (uint32_t u = 0; u < N; ++u){
+            if (!cut.sourceSide[u])
+                continue;
+            for (uint64_t a = first[u]; a < first[u + 1]; ++a){
+                if (sinkSide[head[a]] && (capacity[a] > U())){
+                    cut.edges.emplace_back(u,head[a],capacity[a]);
+                    cut.value += capacity[a];
+                }
+            }
+        }
+        return cut;
+    }
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //T value at nodes, U edge capacities, Base adjacency storage (Graph or CSRGraph)
+class MaxFlowGraph : public Base
+{
+public:
+    MaxFlowGraph(): Base(){}
+    MaxFlowGraph(const uint32_t N): Base(N){}
+    MaxFlowGraph(const Graph<T,U> &graph): Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    MaxFlowGraph(const uint32_t N, const EdgeList &edgeList): Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    U pushRelabel(const uint32_t source, const uint32_t sink) const
+    {
+        FlowNetwork<U> network(*this);
+        return network.pushRelabel(source,sink);
+    }
+
+    U dinic(const uint32_t source, const uint32_t sink) const
+    {
+        FlowNetwork<U> network(*this);
+        return network.dinic(source,sink);
+    }
+
+    MinCut<U> minCut(const uint32_t source, const uint32_t sink, const bool useDinic = false) const
+    {
+        FlowNetwork<U> network(*this);
+        if (useDinic)
+            network.dinic(source,sink);
+        else
+            network.pushRelabel(source,sink);
+        return network.minCut(sink);
+    }
+};
+
+//DIMACS max flow problem - edges (u,v,capacity) 0 based, false if not a valid file (including
+//vertices out of range, negative capacities and n lines with a role other than s or t)
+template<typename U>
+bool readDimacs(const std::string &fileName, uint32_t &N, uint32_t &source, uint32_t &sink, std::vector<std::tuple<uint32_t,uint32_t,U> > &edges)
+{
+    std::ifstream in(fileName);
+    if (!in)
+        return false;
+    N = 0;
+    source = sink = std::numeric_limits<uint32_t>::max();
+    edges.clear();
+    std::string line;
+    while (std::getline(in,line)){
+        std::istringstream fields(line);
+        char type;
+        if (!(fields>>type) || (type == 'c'))
+            continue;
+        if (type == 'p'){
+            std::string problem;
+            size_t numArcs;
+            if (!(fields>>problem>>N>>numArcs) || (problem != "max"))
+                return false;
+            edges.reserve(numArcs);
+        }
+        else if (type == 'n'){
+            uint32_t v;
+            char role;
+            if (!(fields>>v>>role) || (v < 1) || (v > N) || ((role != 's') && (role != 't')))
+                return false;
+            (role == 's' ? source : sink) = v - 1;
+        }
+        else if (type == 'a'){
+            uint32_t u, v;
+            U c;
+            if (!(fields>>u>>v) || (u < 1) || (v < 1) || (u > N) || (v > N))
+                return false;
+            if (!(fields>>std::ws) || (fields.peek() == '-') || !(fields>>c)) //negative capacity - unsigned U would read it wrapped around
+                return false;
+            edges.emplace_back(u - 1,v - 1,c);
+        }
+    }
+    return (source < N) && (sink < N);
+}
+
+//write a max flow problem in DIMACS format
+template<typename U>
+void writeDimacs(const std::string &fileName, const uint32_t N, const uint32_t source, const uint32_t sink,
+                 const std::vector<std::tuple<uint32_t,uint32_t,U> > &edges, const std::string &comment)
+{
+    std::ofstream out(fileName);
+    out<<"c "<<comment<<"\n";
+    out<<"p max "<<N<<" "<<edges.size()<<"\n";
+    out<<"n "<<source + 1<<" s\n";
+    out<<"n "<<sink + 1<<" t\n";
+    for (const auto & [u,v,c] : edges)
+        out<<"a "<<u + 1<<" "<<v + 1<<" "<<c<<"\n";
+}
+
+template<typename U>
+void benchmark(const std::string &fileName)
+{
+    typedef size_t T;
+    uint32_t N = 0, source = 0, sink = 0;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+    if (!readDimacs(fileName,N,source,sink,edges)){
+        std::cout<<"could not read "<<fileName<<std::endl;
+        return;
+    }
+    MaxFlowGraph<T,U,CSRGraph<T,U> > graph(N,edges);
+    FlowNetwork<U> network(graph);
+    auto start = std::chrono::steady_clock::now();
+    U pushRelabelFlow = network.pushRelabel(source,sink);
+    auto mid = std::chrono::steady_clock::now();
+    MinCut<U> cut = network.minCut(sink);
+    U dinicFlow = network.dinic(source,sink);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<std::endl<<fileName<<": "<<N<<" vertices, "<<edges.size()<<" arcs, max flow "<<pushRelabelFlow<<std::endl;
+    std::cout<<"push-relabel : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"dinic        : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"min cut of "<<cut.edges.size()<<" edges, agree: "<<((pushRelabelFlow == dinicFlow) && (cut.value == pushRelabelFlow))<<std::endl;
+}
+
+auto main(int argc, char* argv[])->int
+{
+    typedef size_t T;
+    typedef int64_t U;
+    namespace fs = std::filesystem;
+
+    //small example (CLRS) - max flow 23
+    MaxFlowGraph<T,U> graph(6);
+    graph.addEdge(0,1,16);
+    graph.addEdge(0,2,13);
+    graph.addEdge(1,3,12);
+    graph.addEdge(2,1,4);
+    graph.addEdge(2,4,14);
+    graph.addEdge(3,2,9);
+    graph.addEdge(3,5,20);
+    graph.addEdge(4,3,7);
+    graph.addEdge(4,5,4);
+    std::cout<<"max flow 0 -> 5, push-relabel: "<<graph.pushRelabel(0,5)<<", dinic: "<<graph.dinic(0,5)<<std::endl;
+    MinCut<U> cut = graph.minCut(0,5);
+    std::cout<<"min cut "<<cut.value<<" :";
+    for (const auto & [u,v,c] : cut.edges)
+        std::cout<<" "<<u<<"->"<<v<<" ("<<c<<")";
+    std::cout<<std::endl;
+
+    //random small networks - both algorithms and the cut must agree
+    RndUniform rnd;
+    bool agree = true;
+    for (uint32_t trial = 0; trial < 200; ++trial){
+        const uint32_t smallN = 2 + 30*rnd();
+        MaxFlowGraph<T,U> small(smallN);
+        for (uint32_t e = 0; e < 4*smallN; ++e)
+            small.addEdge(static_cast<uint32_t>(smallN*rnd()),static_cast<uint32_t>(smallN*rnd()),static_cast<U>(1 + 20*rnd()));
+        U flow = small.pushRelabel(0,smallN - 1);
+        agree = agree && (flow == small.dinic(0,smallN - 1)) && (small.minCut(0,smallN - 1).value == flow)
+                      && (small.minCut(0,smallN - 1,true).value == flow);
+    }
+    std::cout<<"random networks agree: "<<agree<<std::endl;
+
+    //benchmarks - DIMACS files given on the command line, or generated ones
+    if (argc > 1){
+        for (int i = 1; i < argc; ++i)
+            benchmark<U>(argv[i]);
+        return 0;
+    }
+    {
+        //layered: source -> layer 0 -> ... -> layer L-1 -> sink, random arcs between consecutive layers
+        const uint32_t layers = 100, width = 2000;
+        const uint32_t N = layers*width + 2, source = N - 2, sink = N - 1;
+        std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+        for (uint32_t i = 0; i < width; ++i){
+            edges.emplace_back(source,i,static_cast<U>(1 + 1000*rnd()));
+            edges.emplace_back((layers - 1)*width + i,sink,static_cast<U>(1 + 1000*rnd()));
+        }
+        for (uint32_t l = 0; l + 1 < layers; ++l)
+            for (uint32_t i = 0; i < width; ++i)
+                for (uint32_t k = 0; k < 4; ++k)
+                    edges.emplace_back(l*width + i,(l + 1)*width + static_cast<uint32_t>(width*rnd()),static_cast<U>(1 + 1000*rnd()));
+        writeDimacs((fs::temp_directory_path() / "max_flow_layered.max").string(),N,source,sink,edges,"random layered network");
+    }
+    {
+        //grid: source feeds the left column, right column drains to the sink, random capacities both ways
+        const uint32_t side = 200;
+        const uint32_t N = side*side + 2, source = N - 2, sink = N - 1;
+        std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+        for (uint32_t r = 0; r < side; ++r){
+            edges.emplace_back(source,r*side,static_cast<U>(1000));
+            edges.emplace_back(r*side + side - 1,sink,static_cast<U>(1000));
+            for (uint32_t c = 0; c < side; ++c){
+                uint32_t u = r*side + c;
+                if (c + 1 < side){
+                    edges.emplace_back(u,u + 1,static_cast<U>(1 + 100*rnd()));
+                    edges.emplace_back(u + 1,u,static_cast<U>(1 + 100*rnd()));
+                }
+                if (r + 1 < side){
+                    edges.emplace_back(u,u + side,static_cast<U>(1 + 100*rnd()));
+                    edges.emplace_back(u + side,u,static_cast<U>(1 + 100*rnd()));
+                }
+            }
+        }
+        writeDimacs((fs::temp_directory_path() / "max_flow_grid.max").string(),N,source,sink,edges,"random grid network");
+    }
+    benchmark<U>((fs::temp_directory_path() / "max_flow_layered.max").string());
+    benchmark<U>((fs::temp_directory_path() / "max_flow_grid.max").string());
+
+    //malformed files - a negative capacity, and an n line that is neither s nor t
+    const std::string badFile = (fs::temp_directory_path() / "max_flow_bad.max").string();
+    bool rejected = true;
+    for (const char *arc : {"a 1 2 -5","a 1 2 5\nn 2 x"}){
+        std::ofstream(badFile)<<"p max 2 1\nn 1 s\nn 2 t\n"<<arc<<"\n";
+        uint32_t N = 0, source = 0, sink = 0;
+        std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+        std::vector<std::tuple<uint32_t,uint32_t,uint32_t> > unsignedEdges;
+        rejected = rejected && !readDimacs(badFile,N,source,sink,edges) && !readDimacs(badFile,N,source,sink,unsignedEdges);
+    }
+    fs::remove(badFile);
+    std::cout<<std::endl<<"malformed files rejected: "<<rejected<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,627 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Bellman-Ford (parallel, SPFA style) and Johnson's all pairs shortest paths
+
+Edge weights may be negative. Dijkstra (see dijkstra.cpp) then fails - a settled vertex can
+still be improved later through a negative edge.
+
+Bellman-Ford:
+
+Repeatedly relax every edge. After round k every vertex has at most its shortest distance over
+paths of k edges or fewer, so with no negative cycle |V|-1 rounds suffice. Two standard
+improvements:
+
+1) only relax edges out of vertices whose distance changed in the previous round (the
+   "frontier", as in SPFA) - most rounds touch a small part of the graph
+2) stop as soon as the frontier is empty, usually long before |V|-1 rounds
+
+The frontier is processed in parallel. Distances are std::atomic and lowered with
+compare-exchange (improvements found within a round are seen by the rest of that round, which
+only helps), and a per vertex flag makes sure a vertex joins the next frontier once.
+
+Negative cycles: distances along a reachable negative cycle never stop falling, so if the
+frontier is still non-empty after |V| rounds there is a negative cycle reachable from the start.
+
+Predecessors are recovered afterwards by a search from the start along "tight" edges
+(dist[u] + w == dist[v]). Picking any tight edge into v is not enough: a cycle of zero weight
+edges is all tight and could make predecessors loop.
+
+Johnson's all pairs shortest paths:
+
+1) add a virtual vertex q with a 0 weight edge to every vertex, and find h(v) = dist(q,v) with
+   Bellman-Ford. Here: start every distance at 0 with every vertex in the frontier, same thing.
+2) reweight w'(u,v) = w(u,v) + h(u) - h(v). By the triangle inequality w' >= 0, and every u -> v
+   path changes by exactly h(u) - h(v), so shortest paths are unchanged.
+3) Dijkstra from every source on w', in parallel (threads take sources from a shared counter)
+4) dist(u,v) = dist'(u,v) - h(u) + h(v)
+
+O(|V||E| log |V|) total. The |V|^2 result doesn't have to fit in RAM. Each row is written
+straight into a memory mapped file (DistanceMatrix), which the OS writes back in the background.
+Without mmap (Windows) the matrix is held in memory instead, read whole by open() and written
+to the file by sync() and close(). Unreachable pairs hold numeric_limits<U>::max().
+
+Matrix file format:
+
+    char[8]  "SAAMATRX"
+    uint32   version (1)
+    uint32   sizeof(U)
+    uint64   N
+    uint64   0 (padding, data starts 8 byte aligned)
+    U        distances[N][N], row u = distances from u
+
+*/
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tuple>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "heap.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+//struct for route info from origin vertex
+template<typename U>
+struct Routes{
+    size_t origin;
+    std::vector<U> distances;    //numeric_limits<U>::max() if unreachable
+    std::vector<int32_t> previous;
+    bool negativeCycle;          //distances are meaningless if true
+    size_t rounds;               //Bellman-Ford rounds run
+};
+
+//N x N matrix of distances in a memory mapped file (a buffer written back on sync/close without mmap)
+template<typename U>
+class DistanceMatrix{
+    static constexpr char magic[8] = {'S','A','A','M','A','T','R','X'};
+    static constexpr size_t headerSize = 32;
+    size_t length = 0;
+    uint64_t N = 0;
+    U *data = nullptr;
+#ifndef _WIN32
+    void *address = nullptr;
+
+    bool map(int fd, int protection)
+    {
+        void *mapped = ::mmap(nullptr,length,protection,MAP_SHARED,fd,0);
+        ::close(fd); //the mapping keeps the file alive
+        if (mapped == MAP_FAILED)
+            return false;
+        address = mapped;
+        data = reinterpret_cast<U*>(static_cast<char*>(address) + headerSize);
+        return true;
+    }
+#else
+    //no mmap - the whole file (header included) in an 8 byte aligned buffer
+    std::unique_ptr<uint64_t[]> address;
+    std::string writeBack; //file sync() writes to, empty when opened read only
+
+    void allocate()
+    {
+        address.reset(new uint64_t[(length + 7) / 8]());
+        data = reinterpret_cast<U*>(reinterpret_cast<char*>(address.get()) + headerSize);
+    }
+#endif
+
+    //file size for an N x N matrix - false if it does not fit in size_t/off_t
+    static bool matrixLength(const uint64_t N_, size_t &bytes)
+    {
+#ifndef _WIN32
+        const uint64_t maxBytes = static_cast<uint64_t>(std::numeric_limits<off_t>::max());
+#else
+        const uint64_t maxBytes = std::min<uint64_t>(std::numeric_limits<size_t>::max(),std::numeric_limits<std::streamoff>::max());
+#endif
+        if ((N_ != 0) && (N_ > (maxBytes - headerSize) / sizeof(U) / N_))
+            return false;
+        bytes = headerSize + N_*N_*sizeof(U);
+        return true;
+    }
+
+    char* header()
+    {
+#ifndef _WIN32
+        return static_cast<char*>(address);
+#else
+        return reinterpret_cast<char*>(address.get());
+#endif
+    }
+
+public:
+    DistanceMatrix(){}
+    DistanceMatrix(const DistanceMatrix&) = delete;
+    DistanceMatrix& operator=(const DistanceMatrix&) = delete;
+    ~DistanceMatrix()
+    {
+        close();
+    }
+
+    //new file (replacing any existing one) for an N x N matrix, mapped read/write
+    bool create(const std::string &fileName, const uint64_t N_)
+    {
+        close();
+        size_t bytes = 0;
+        if (!matrixLength(N_,bytes))
+            return false;
+#ifndef _WIN32
+        int fd = ::open(fileName.c_str(),O_RDWR|O_CREAT|O_TRUNC,0644);
+        if (fd < 0)
+            return false;
+        if (::ftruncate(fd,bytes) != 0){
+            ::close(fd);
+            return false;
+        }
+        length = bytes;
+        if (!map(fd,PROT_READ|PROT_WRITE)){ //closes fd either way
+            length = 0;
+            return false;
+        }
+#else
+        if (!std::ofstream(fileName,std::ios::binary))
+            return false;
+        length = bytes;
+        allocate();
+        writeBack = fileName;
+#endif
+        N = N_;
+        const uint32_t version = 1;
+        const uint32_t weightSize = sizeof(U);
+        std::memcpy(header(),magic,8);
+        std::memcpy(header() + 8,&version,sizeof(version));
+        std::memcpy(header() + 12,&weightSize,sizeof(weightSize));
+        std::memcpy(header() + 16,&N,sizeof(N));
+        return true;
+    }
+
+    //existing file, mapped read only - writing through row() is then an error
+    bool open(const std::string &fileName)
+    {
+        close();
+        char fileHeader[headerSize];
+        uint32_t version = 0, weightSize = 0;
+        uint64_t N_ = 0;
+        size_t bytes = 0;
+#ifndef _WIN32
+        int fd = ::open(fileName.c_str(),O_RDONLY);
+        if (fd < 0)
+            return false;
+        if ((::pread(fd,fileHeader,headerSize,0) != static_cast<ssize_t>(headerSize)) || (std::memcmp(fileHeader,magic,8) != 0)){
+            ::close(fd);
+            return false;
+        }
+        std::memcpy(&version,fileHeader + 8,sizeof(version));
+        std::memcpy(&weightSize,fileHeader + 12,sizeof(weightSize));
+        std::memcpy(&N_,fileHeader + 16,sizeof(N_));
+        if ((version != 1) || (weightSize != sizeof(U)) || (!matrixLength(N_,bytes)) || (::lseek(fd,0,SEEK_END) < static_cast<off_t>(bytes))){
+            ::close(fd);
+            return false;
+        }
+        length = bytes;
+        if (!map(fd,PROT_READ)){ //closes fd either way
+            length = 0;
+            return false;
+        }
+#else
+        std::ifstream file(fileName,std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        const std::streamoff fileSize = file.tellg();
+        file.seekg(0);
+        if ((fileSize < static_cast<std::streamoff>(headerSize)) || !file.read(fileHeader,headerSize) || (std::memcmp(fileHeader,magic,8) != 0))
+            return false;
+        std::memcpy(&version,fileHeader + 8,sizeof(version));
+        std::memcpy(&weightSize,fileHeader + 12,sizeof(weightSize));
+        std::memcpy(&N_,fileHeader + 16,sizeof(N_));
+        if ((version != 1) || (weightSize != sizeof(U)) || (!matrixLength(N_,bytes)) || (fileSize < static_cast<std::streamoff>(bytes)))
+            return false;
+        length = bytes;
+        allocate();
+        file.seekg(0);
+        if (!file.read(header(),length)){
+            close();
+            return false;
+        }
+#endif
+        N = N_;
+        return true;
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (address)
+            ::munmap(address,length);
+        address = nullptr;
+#else
+        if (address)
+            sync();
+        address.reset();
+        writeBack.clear();
+#endif
+        data = nullptr;
+        length = 0;
+        N = 0;
+    }
+
+    bool isOpen() const noexcept
+    {
+        return address != nullptr;
+    }
+
+    uint64_t size() const noexcept
+    {
+        return N;
+    }
+
+    U* row(const uint64_t u)
+    {
+        return data + u*N;
+    }
+
+    const U& operator()(const uint64_t u, const uint64_t v) const
+    {
+        return data[u*N + v];
+    }
+
+    //flush to disk now rather than whenever the OS gets round to it (without mmap, the only write)
+    bool sync()
+    {
+#ifndef _WIN32
+        return (!address) || (::msync(address,length,MS_SYNC) == 0);
+#else
+        if ((!address) || writeBack.empty())
+            return true;
+        std::ofstream file(writeBack,std::ios::binary);
+        return static_cast<bool>(file.write(header(),length));
+#endif
+    }
+};
+
+//Extend Graph class
+template<typename T,typename U,typename Base = Graph<T,U> > //T value at nodes, U edge weights, Base adjacency storage (Graph or CSRGraph)
+class BellmanFordGraph : public Base
+{
+    //encapsulation of vertex index and distance with comparison overloads for heap version
+    struct IndexWeight
+    {
+        size_t vertex;
+        U weight;
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+        IndexWeight(){}
+        template<typename V,typename W>
+        IndexWeight(V &&v_, W &&w_):vertex(std::forward<V>(v_)),weight(std::forward<W>(w_)){}
+    };
+
+    //frontier rounds until nothing changes - returns rounds run, or maxRounds + 1 if still changing (negative cycle)
+    size_t relaxRounds(std::vector<std::atomic<U> > &distances, std::vector<uint32_t> frontier, const size_t maxRounds, uint32_t numThreads) const
+    {
+        const size_t N = this->numVertices();
+        const U infinity = std::numeric_limits<U>::max();
+        numThreads = std::max<uint32_t>(1,numThreads);
+        std::vector<std::atomic<uint8_t> > queued(N);
+        for (auto &q : queued)
+            q.store(0,std::memory_order_relaxed);
+        std::vector<std::vector<uint32_t> > next(numThreads); //per thread next frontier
+        size_t rounds = 0;
+        while (!frontier.empty()){
+            if (rounds == maxRounds)
+                return maxRounds + 1;
+            ++rounds;
+            parallelFor(frontier.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+                for (size_t i = begin; i < end; ++i){
+                    uint32_t u = frontier[i];
+                    U du = distances[u].load(std::memory_order_relaxed);
+                    if (du == infinity)
+                        continue;
+                    for (const auto & neighbourData : this->neighbours(u)){
+                        U newDist = du + neighbourData.second;
+                        U oldDist = distances[neighbourData.first].load(std::memory_order_relaxed);
+                        while (newDist < oldDist){ //atomic min
+                            if (distances[neighbourData.first].compare_exchange_weak(oldDist,newDist,std::memory_order_relaxed)){
+                                if (!queued[neighbourData.first].exchange(1,std::memory_order_relaxed))
+                                    next[t].push_back(neighbourData.first);
+                                break;
+                            }
+                        }
+                    }
+                }
+            },256);
+            frontier.clear();
+            for (auto &threadNext : next){
+                for (uint32_t v : threadNext)
+                    queued[v].store(0,std::memory_order_relaxed);
+                frontier.insert(frontier.end(),threadNext.begin(),threadNext.end());
+                threadNext.clear();
+            }
+        }
+        return rounds;
+    }
+
+    //shortest path tree along tight edges
+    std::vector<int32_t> previousFromDistances(size_t startVertex, const std::vector<U> &distances) const
+    {
+        std::vector<int32_t> previous(this->numVertices(),-1);
+        previous[startVertex] = startVertex;
+        std::vector<uint32_t> stack = {static_cast<uint32_t>(startVertex)};
+        while (!stack.empty()){
+            uint32_t u = stack.back();
+            stack.pop_back();
+            for (const auto & neighbourData : this->neighbours(u)){
+                if ((previous[neighbourData.first] < 0) && (distances[u] + neighbourData.second == distances[neighbourData.first])){
+                    previous[neighbourData.first] = u;
+                    stack.push_back(neighbourData.first);
+                }
+            }
+        }
+        return previous;
+    }
+
+public:
+    BellmanFordGraph(): Base(){}
+    BellmanFordGraph(const uint32_t N): Base(N){}
+    BellmanFordGraph(const Graph<T,U> &graph): Base(graph){} //e.g. Base = CSRGraph<T,U>
+
+    //distance and routes to all nodes
+    Routes<U> bellmanFord(size_t startVertex, uint32_t numThreads = defaultThreads()) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        const size_t N = this->numVertices();
+        std::vector<std::atomic<U> > distances(N);
+        for (auto &d : distances)
+            d.store(std::numeric_limits<U>::max(),std::memory_order_relaxed);
+        distances[startVertex].store(0,std::memory_order_relaxed);
+        size_t rounds = relaxRounds(distances,{static_cast<uint32_t>(startVertex)},N,numThreads);
+
+        Routes<U> routes{startVertex,std::vector<U>(N),{},rounds > N,std::min(rounds,N)};
+        for (size_t i = 0; i < N; ++i)
+            routes.distances[i] = distances[i].load(std::memory_order_relaxed);
+        if (!routes.negativeCycle)
+            routes.previous = previousFromDistances(startVertex,routes.distances);
+        return routes;
+    }
+
+    //textbook version - every edge, every round, stopping early when a round changes nothing
+    Routes<U> bellmanFordSequential(size_t startVertex) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        const size_t N = this->numVertices();
+        const U infinity = std::numeric_limits<U>::max();
+        Routes<U> routes{startVertex,std::vector<U>(N,infinity),{},false,0};
+        routes.distances[startVertex] = 0;
+        bool changed = true;
+        while (changed && (routes.rounds <= N)){
+            changed = false;
+            ++routes.rounds;
+            for (uint32_t u = 0; u < N; ++u){
+                if (routes.distances[u] == infinity)
+                    continue;
+                for (const auto & neighbourData : this->neighbours(u)){
+                    if (routes.distances[u] + neighbourData.second < routes.distances[neighbourData.first]){
+                        routes.distances[neighbourData.first] = routes.distances[u] + neighbourData.second;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        routes.negativeCycle = changed;
+        if (!routes.negativeCycle)
+            routes.previous = previousFromDistances(startVertex,routes.distances);
+        return routes;
+    }
+
+    //all pairs into a memory mapped matrix file - false on a negative cycle or I/O error
+    bool johnson(const std::string &fileName, uint32_t numThreads = defaultThreads()) const
+    {
+        static_assert(std::is_signed_v<U>,"Johnson's algorithm needs signed edge weights");
+        const uint32_t N = this->numVertices();
+        const U infinity = std::numeric_limits<U>::max();
+
+        //1) potentials h(v) - distances from a virtual vertex joined to all others
+        std::vector<std::atomic<U> > potentials(N);
+        std::vector<uint32_t> everyVertex(N);
+        for (uint32_t u = 0; u < N; ++u){
+            potentials[u].store(0,std::memory_order_relaxed);
+            everyVertex[u] = u;
+        }
+        if (relaxRounds(potentials,everyVertex,N + 1,numThreads) > N + 1)
+            return false;
+        std::vector<U> h(N);
+        for (uint32_t u = 0; u < N; ++u)
+            h[u] = potentials[u].load(std::memory_order_relaxed);
+
+        //2) reweighted, non negative copy
+        std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList;
+        for (uint32_t u = 0; u < N; ++u)
+            for (const auto & neighbourData : this->neighbours(u))
+                edgeList.emplace_back(u,neighbourData.first,neighbourData.second + h[u] - h[neighbourData.first]);
+        CSRGraph<T,U> reweighted(N,edgeList);
+        edgeList = {};
+
+        DistanceMatrix<U> matrix;
+        if (!matrix.create(fileName,N))
+            return false;
+
+        //3) Dijkstra from every source, each writing its own row of the matrix
+        std::atomic<uint32_t> nextSource(0);
+        auto worker = [&](){
+            std::vector<uint32_t> settledStamp(N,UINT32_MAX); //source that settled the vertex last
+            for (uint32_t s = nextSource.fetch_add(1); s < N; s = nextSource.fetch_add(1)){
+                U *row = matrix.row(s);
+                std::fill(row,row + N,infinity);
+                row[s] = 0;
+                Heap<IndexWeight> distancesHeap;
+                distancesHeap.insert({s,0});
+                while(!distancesHeap.isEmpty()){
+                    IndexWeight currentVertex = distancesHeap.getRoot();
+                    distancesHeap.removeRoot();
+                    if (settledStamp[currentVertex.vertex] == s) //stale heap entry
+                        continue;
+                    settledStamp[currentVertex.vertex] = s;
+                    for (const auto & neighbourData : reweighted.neighbours(currentVertex.vertex)){
+                        U newDist = currentVertex.weight + neighbourData.second;
+                        if ((settledStamp[neighbourData.first] != s) && (newDist < row[neighbourData.first])){
+                            row[neighbourData.first] = newDist;
+                            distancesHeap.insert({neighbourData.first,newDist});
+                        }
+                    }
+                }
+                //4) undo the reweighting
+                for (uint32_t v = 0; v < N; ++v)
+                    if (row[v] != infinity)
+                        row[v] = row[v] - h[s] + h[v];
+            }
+        };
+        numThreads = std::max<uint32_t>(1,std::min<uint32_t>(numThreads,N));
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < numThreads; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &thread : threads)
+            thread.join();
+        return matrix.sync();
+    }
+};
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    int32_t N = 5;
+    BellmanFordGraph<T,U> graph(N); //classic example with negative edges, no negative cycle
+    graph.addEdge(0,1,6);
+    graph.addEdge(0,3,7);
+    graph.addEdge(1,2,5);
+    graph.addEdge(1,3,8);
+    graph.addEdge(1,4,-4);
+    graph.addEdge(2,1,-2);
+    graph.addEdge(3,2,-3);
+    graph.addEdge(3,4,9);
+    graph.addEdge(4,0,2);
+    graph.addEdge(4,2,7);
+
+    //start vertex
+    int32_t v = 0;
+    Routes<U> routes = graph.bellmanFord(v);
+    std::cout<<"distances and paths from vertex "<<routes.origin<<" after "<<routes.rounds<<" rounds"<<std::endl;
+    for (size_t i=0;i<routes.distances.size();++i){
+        std::cout<<i<<": "<<routes.distances[i]<<std::endl<<"path (reversed) : ";
+        int32_t u = i;
+        std::cout<<u<<" ";
+        while ((u != v)&&(u>=0)){
+            std::cout<<routes.previous[u]<<" ";
+            u = routes.previous[u];
+        }
+        std::cout<<std::endl<<std::endl;
+    }
+    graph.addEdge(2,3,1); //3 -> 2 -> 3 now has weight -2
+    std::cout<<"negative cycle detected: "<<graph.bellmanFord(v).negativeCycle<<" (sequential: "<<graph.bellmanFordSequential(v).negativeCycle
+             <<", johnson refuses: "<<!graph.johnson((std::filesystem::temp_directory_path() / "unused.mat").string())<<")"<<std::endl;
+    std::filesystem::remove(std::filesystem::temp_directory_path() / "unused.mat");
+
+    //larger random graph - weights c(u,v) + p(v) - p(u) are often negative, but every cycle has the positive weight sum of c
+    const uint32_t bigN = 100000;
+    const uint32_t bigE = 1000000;
+    RndUniform rnd;
+    std::vector<U> p(bigN);
+    for (auto &x : p)
+        x = 200*rnd();
+    BellmanFordGraph<T,U,CSRGraph<T,U> > bigGraph;
+    {
+        Graph<T,U> build(bigN);
+        size_t negative = 0;
+        for (uint32_t e = 0; e < bigE; ++e){
+            uint32_t a = bigN*rnd();
+            uint32_t b = bigN*rnd();
+            U w = static_cast<U>(1 + 99*rnd()) + p[b] - p[a];
+            if (build.addEdge(a,b,w))
+                negative += (w < 0);
+        }
+        bigGraph = BellmanFordGraph<T,U,CSRGraph<T,U> >(build);
+        std::cout<<std::endl<<bigN<<" vertices, "<<bigGraph.numEdges()<<" edges ("<<negative<<" negative), "<<std::thread::hardware_concurrency()<<" threads"<<std::endl;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Routes<U> sequential = bigGraph.bellmanFordSequential(0);
+    auto mid = std::chrono::steady_clock::now();
+    Routes<U> parallel = bigGraph.bellmanFord(0);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<"bellmanFordSequential : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms, "<<sequential.rounds<<" rounds"<<std::endl;
+    std::cout<<"bellmanFord           : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms, "<<parallel.rounds<<" rounds"<<std::endl;
+    bool treeValid = true;
+    for (uint32_t u = 0; u < bigN; ++u)
+        if ((u != 0) && (parallel.previous[u] >= 0))
+            treeValid = treeValid && (parallel.distances[parallel.previous[u]] < std::numeric_limits<U>::max());
+    std::cout<<"distances agree: "<<(sequential.distances == parallel.distances)<<", predecessors valid: "<<treeValid<<std::endl;
+
+    //all pairs on a smaller graph
+    const uint32_t smallN = 2000;
+    Graph<T,U> smallBuild(smallN);
+    for (uint32_t e = 0; e < 10*smallN; ++e){
+        uint32_t a = smallN*rnd();
+        uint32_t b = smallN*rnd();
+        smallBuild.addEdge(a,b,static_cast<U>(1 + 99*rnd()) + p[b] - p[a]);
+    }
+    BellmanFordGraph<T,U,CSRGraph<T,U> > smallGraph(smallBuild);
+    std::string fileName = (std::filesystem::temp_directory_path() / "johnson.mat").string();
+    start = std::chrono::steady_clock::now();
+    bool written = smallGraph.johnson(fileName);
+    end = std::chrono::steady_clock::now();
+    std::cout<<std::endl<<"johnson "<<smallN<<" x "<<smallN<<" -> "<<fileName<<" ("<<std::filesystem::file_size(fileName)<<" bytes) "
+             <<written<<" in "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+    DistanceMatrix<U> matrix;
+    bool agree = matrix.open(fileName) && (matrix.size() == smallN);
+    for (uint32_t s = 0; (s < smallN) && agree; s += 97){
+        Routes<U> row = smallGraph.bellmanFord(s);
+        for (uint32_t t = 0; t < smallN; ++t)
+            agree = agree && (matrix(s,t) == row.distances[t]);
+    }
+    std::cout<<"matrix rows agree with Bellman-Ford: "<<agree<<std::endl;
+    matrix.close();
+    std::filesystem::remove(fileName);
+
+    return 0;
+}
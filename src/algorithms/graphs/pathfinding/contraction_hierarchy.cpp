@@ -0,0 +1,730 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Contraction hierarchies - shortest path queries on static graphs after preprocessing
+
+Restrictions:
+    Edge weights must be positive
+
+Preprocessing ("contraction"):
+
+Vertices are removed ("contracted") one at a time in some order, least important first. When v is
+removed, for every pair of remaining neighbours u -> v -> x we must preserve the distance from u
+to x, so we add a "shortcut" edge u -> x with weight w(u,v) + w(v,x) - unless a "witness" path
+u -> ... -> x avoiding v, no longer than that, already exists. The witness search is a small
+Dijkstra from u over the remaining graph, limited in distance and in number of vertices settled
+(giving up just adds a possibly unnecessary shortcut, which is harmless).
+
+The order matters a great deal. We pick the vertex with the lowest priority,
+
+    priority = (shortcuts needed) - (edges removed) + (neighbours already contracted)
+
+i.e. prefer vertices whose removal doesn't grow the graph, spread evenly over the graph. Priorities
+change as neighbours are contracted, so they are updated lazily - take the lowest from the heap,
+recompute it, and only contract if it is still no larger than the next lowest.
+
+The rank of a vertex is its position in the order. Every edge in the final hierarchy (original
+or shortcut) goes either "up" to a higher rank or "down" to a lower one.
+
+Query:
+
+Any shortest path can now be replaced by one going only up from the start, then only down to the
+end. So we run a bidirectional Dijkstra where the forward search only follows upward edges out of
+a vertex and the backward search only follows upward edges into a vertex. Both searches stay
+within the small "upward" part of the graph, typically a few hundred vertices even for continental
+road networks. The best route is the minimum over vertices reached from both sides, and each side
+can stop once its heap holds nothing shorter than that.
+
+Shortcuts record the vertex they bypass ("middle") so the route is unpacked recursively into
+original edges.
+
+File format (all little endian binary, via save()/load()):
+
+    char[4]  "CHGR"
+    uint32   version (1)
+    uint32   sizeof(U)
+    uint32   N
+    uint32   rank[N]
+    then for the upward forward graph followed by the upward backward graph:
+    uint64   numEdges
+    uint64   offsets[N+1]
+    uint32   targets[numEdges]
+    U        weights[numEdges]
+    int32    middles[numEdges]   (-1 for an original edge)
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "heap.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+
+//struct for a single route between two vertices
+template<typename U>
+struct Route{
+    size_t origin;
+    size_t target;
+    U distance;                 //numeric_limits<U>::max() if unreachable
+    std::vector<uint32_t> path; //origin ... target, empty if unreachable
+    size_t numExpanded;         //vertices taken from the heaps
+};
+
+template<typename U> //U edge weights
+class ContractionHierarchy{
+    //encapsulation of vertex index and distance with comparison overloads for heap version
+    struct IndexWeight
+    {
+        size_t vertex;
+        U weight;
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+        IndexWeight(){}
+        template<typename V,typename W>
+        IndexWeight(V &&v_, W &&w_):vertex(std::forward<V>(v_)),weight(std::forward<W>(w_)){}
+    };
+
+    //entry for the contraction order heap
+    struct IndexPriority
+    {
+        uint32_t vertex;
+        int32_t priority;
+        bool operator< (const IndexPriority& A) const { return (this->priority < A.priority)||((this->priority == A.priority)&&(this->vertex < A.vertex));};
+        bool operator> (const IndexPriority& A) const { return A < *this;};
+    };
+
+    struct Edge{
+        uint32_t target;
+        U weight;
+        int32_t middle; //bypassed vertex for shortcuts, -1 otherwise
+    };
+
+    //upward edges in CSR form
+    struct UpwardGraph{
+        std::vector<uint64_t> offsets;
+        std::vector<uint32_t> targets;
+        std::vector<U> weights;
+        std::vector<int32_t> middles;
+    };
+
+    static constexpr U infinity = std::numeric_limits<U>::max();
+    static constexpr uint32_t witnessSettleLimit = 500;
+
+    uint32_t N = 0;
+    std::vector<uint32_t> rank;
+    UpwardGraph forward;  //u -> v with rank[v] > rank[u], listed under u
+    UpwardGraph backward; //v -> u with rank[v] > rank[u], listed under u
+
+    /////////////////// preprocessing ///////////////////
+
+    struct Builder{
+        std::vector<std::vector<Edge> > out, in;
+        std::vector<bool> contracted;
+        std::vector<uint32_t> contractedNeighbours;
+        std::vector<U> witnessDistances;
+        std::vector<uint32_t> witnessTouched;
+    };
+
+    static void addOrImprove(std::vector<Edge> &edges, const Edge &edge)
+    {
+        for (auto &e : edges){
+            if (e.target == edge.target){ //keep only the shortest parallel edge
+                if (edge.weight < e.weight)
+                    e = edge;
+                return;
+            }
+        }
+        edges.push_back(edge);
+    }
+
+    //bounded Dijkstra from source over uncontracted vertices, ignoring skip
+    static void witnessSearch(Builder &b, uint32_t source, uint32_t skip, U maxDistance)
+    {
+        for (uint32_t u : b.witnessTouched)
+            b.witnessDistances[u] = infinity;
+        b.witnessTouched.clear();
+        Heap<IndexWeight> heap;
+        heap.insert({source,0});
+        b.witnessDistances[source] = 0;
+        b.witnessTouched.push_back(source);
+        uint32_t settled = 0;
+        while ((!heap.isEmpty()) && (settled < witnessSettleLimit)){
+            IndexWeight current = heap.getRoot();
+            heap.removeRoot();
+            if (current.weight > b.witnessDistances[current.vertex])
+                continue;
+            if (current.weight > maxDistance)
+                break;
+            ++settled;
+            for (const Edge &e : b.out[current.vertex]){
+                if ((e.target == skip) || b.contracted[e.target])
+                    continue;
+                U newDist = current.weight + e.weight;
+                if (newDist < b.witnessDistances[e.target]){
+                    if (b.witnessDistances[e.target] == infinity)
+                        b.witnessTouched.push_back(e.target);
+                    b.witnessDistances[e.target] = newDist;
+                    heap.insert({e.target,newDist});
+                }
+            }
+        }
+    }
+
+    //shortcuts needed to contract v - added to the graph unless simulate
+    static int32_t contract(Builder &b, uint32_t v, bool simulate)
+    {
+        int32_t shortcuts = 0;
+        U maxOut = 0;
+        for (const Edge &e : b.out[v])
+            if (!b.contracted[e.target])
+                maxOut = std::max(maxOut,e.weight);
+        std::vector<std::pair<uint32_t,Edge> > added;
+        for (const Edge &inEdge : b.in[v]){
+            uint32_t u = inEdge.target;
+            if (b.contracted[u])
+                continue;
+            witnessSearch(b,u,v,inEdge.weight + maxOut);
+            for (const Edge &outEdge : b.out[v]){
+                uint32_t x = outEdge.target;
+                if ((x == u) || b.contracted[x])
+                    continue;
+                U viaV = inEdge.weight + outEdge.weight;
+                if (b.witnessDistances[x] <= viaV) //witness found
+                    continue;
+                ++shortcuts;
+                if (!simulate)
+                    added.push_back({u,Edge{x,viaV,static_cast<int32_t>(v)}});
+            }
+        }
+        for (const auto &shortcut : added){
+            addOrImprove(b.out[shortcut.first],shortcut.second);
+            addOrImprove(b.in[shortcut.second.target],Edge{shortcut.first,shortcut.second.weight,shortcut.second.middle});
+        }
+        return shortcuts;
+    }
+
+    static int32_t priority(Builder &b, uint32_t v)
+    {
+        int32_t removed = 0;
+        for (const Edge &e : b.out[v])
+            removed += !b.contracted[e.target];
+        for (const Edge &e : b.in[v])
+            removed += !b.contracted[e.target];
+        return contract(b,v,true) - removed + static_cast<int32_t>(b.contractedNeighbours[v]);
+    }
+
+    static void toUpward(UpwardGraph &graph, const std::vector<std::vector<Edge> > &edges)
+    {
+        graph.offsets.assign(1,0);
+        for (const auto &list : edges){
+            for (const Edge &e : list){
+                graph.targets.push_back(e.target);
+                graph.weights.push_back(e.weight);
+                graph.middles.push_back(e.middle);
+            }
+            graph.offsets.push_back(graph.targets.size());
+        }
+    }
+
+    /////////////////// query ///////////////////
+
+    //edge a -> b in the hierarchy (either direction of rank), minimum weight
+    const int32_t* findEdge(uint32_t a, uint32_t b, U &weight) const
+    {
+        const UpwardGraph &graph = (rank[a] < rank[b]) ? forward : backward;
+        uint32_t from = (rank[a] < rank[b]) ? a : b;
+        uint32_t to = (rank[a] < rank[b]) ? b : a;
+        const int32_t *best = nullptr;
+        for (uint64_t e = graph.offsets[from]; e < graph.offsets[from + 1]; ++e){
+            if ((graph.targets[e] == to) && ((!best) || (graph.weights[e] < weight))){
+                weight = graph.weights[e];
+                best = &graph.middles[e];
+            }
+        }
+        return best;
+    }
+
+    //append original path a -> b (excluding a) to path
+    void unpack(uint32_t a, uint32_t b, std::vector<uint32_t> &path) const
+    {
+        U weight = 0;
+        const int32_t *middle = findEdge(a,b,weight);
+        if ((!middle) || (*middle < 0)){
+            path.push_back(b);
+            return;
+        }
+        unpack(a,*middle,path);
+        unpack(*middle,b,path);
+    }
+
+    //one step of the upward search on one side - returns false if the root was stale
+    bool expand(const UpwardGraph &graph, Heap<IndexWeight> &heap, std::vector<U> &distances, std::vector<int32_t> &previous,
+                const std::vector<U> &otherDistances, std::vector<uint32_t> &touched, U &best, int32_t &meet) const
+    {
+        IndexWeight current = heap.getRoot();
+        heap.removeRoot();
+        if (current.weight > distances[current.vertex])
+            return false;
+        if ((otherDistances[current.vertex] != infinity) && (current.weight + otherDistances[current.vertex] < best)){
+            best = current.weight + otherDistances[current.vertex];
+            meet = current.vertex;
+        }
+        for (uint64_t e = graph.offsets[current.vertex]; e < graph.offsets[current.vertex + 1]; ++e){
+            uint32_t v = graph.targets[e];
+            U newDist = current.weight + graph.weights[e];
+            if (newDist < distances[v]){
+                if ((distances[v] == infinity) && (otherDistances[v] == infinity))
+                    touched.push_back(v);
+                distances[v] = newDist;
+                previous[v] = current.vertex;
+                heap.insert({v,newDist});
+            }
+        }
+        return true;
+    }
+
+
+    template<typename V>
+    static void writeVector(std::ofstream &file, const std::vector<V> &data)
+    {
+        file.write(reinterpret_cast<const char*>(data.data()),data.size()*sizeof(V));
+    }
+
+    template<typename V>
+    static bool readVector(std::ifstream &file, std::vector<V> &data, size_t size)
+    {
+        data.resize(size);
+        file.read(reinterpret_cast<char*>(data.data()),size*sizeof(V));
+        return static_cast<bool>(file);
+    }
+
+    //structure query() and unpack() rely on: offsets run 0 ... numEdges without decreasing,
+    //every edge goes up in rank (upward = rank[target] > rank[source]) and every shortcut bypasses
+    //a vertex ranked below both ends - so unpacking always terminates
+    bool validUpward(const UpwardGraph &graph) const
+    {
+        if ((graph.offsets.size() != static_cast<size_t>(N) + 1) || (graph.offsets[0] != 0) || (graph.offsets[N] != graph.targets.size()))
+            return false;
+        for (uint32_t u = 0; u < N; ++u){
+            if (graph.offsets[u] > graph.offsets[u + 1])
+                return false;
+            for (uint64_t e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e){
+                uint32_t v = graph.targets[e];
+                int32_t middle = graph.middles[e];
+                if ((v >= N) || (rank[v] <= rank[u]))
+                    return false;
+                if ((middle >= 0) && ((static_cast<uint32_t>(middle) >= N) || (rank[middle] >= rank[u])))
+                    return false;
+                if (middle < -1)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    //scratch state for query() - one per thread, reused between queries
+    //distances/previous are reset only where the last query touched them
+    struct QueryWorkspace{
+        std::vector<U> distancesF, distancesB;
+        std::vector<int32_t> previousF, previousB;
+        std::vector<uint32_t> touched;
+
+        void reset(const uint32_t N)
+        {
+            if (distancesF.size() != N){
+                distancesF.assign(N,infinity);
+                distancesB.assign(N,infinity);
+                previousF.assign(N,-1);
+                previousB.assign(N,-1);
+                touched.clear();
+            }
+            for (uint32_t u : touched){
+                distancesF[u] = distancesB[u] = infinity;
+                previousF[u] = previousB[u] = -1;
+            }
+            touched.clear();
+        }
+    };
+
+    ContractionHierarchy(){}
+
+    //preprocess any graph exposing numVertices() and neighbours() (Graph, CSRGraph, ...)
+    template<typename G>
+    ContractionHierarchy(const G &graph):N(graph.numVertices()),rank(N,0)
+    {
+        Builder b;
+        b.out.resize(N);
+        b.in.resize(N);
+        b.contracted.assign(N,false);
+        b.contractedNeighbours.assign(N,0);
+        b.witnessDistances.assign(N,infinity);
+        for (uint32_t u = 0; u < N; ++u){
+            for (const auto & neighbourData : graph.neighbours(u)){
+                if (neighbourData.first == u)
+                    continue;
+                addOrImprove(b.out[u],Edge{neighbourData.first,neighbourData.second,-1});
+                addOrImprove(b.in[neighbourData.first],Edge{u,neighbourData.second,-1});
+            }
+        }
+
+        Heap<IndexPriority> order;
+        for (uint32_t v = 0; v < N; ++v)
+            order.insert(IndexPriority{v,priority(b,v)});
+
+        //upward edges of each vertex, fixed at the moment it is contracted
+        std::vector<std::vector<Edge> > upOut(N), upIn(N);
+        uint32_t nextRank = 0;
+        while (!order.isEmpty()){
+            IndexPriority current = order.getRoot();
+            order.removeRoot();
+            int32_t updated = priority(b,current.vertex); //lazy update
+            if ((!order.isEmpty()) && (IndexPriority{current.vertex,updated} > order.getRoot())){
+                order.insert(IndexPriority{current.vertex,updated});
+                continue;
+            }
+            uint32_t v = current.vertex;
+            contract(b,v,false);
+            for (const Edge &e : b.out[v]){
+                if (!b.contracted[e.target]){
+                    upOut[v].push_back(e);
+                    ++b.contractedNeighbours[e.target];
+                }
+            }
+            for (const Edge &e : b.in[v]){
+                if (!b.contracted[e.target]){
+                    upIn[v].push_back(e);
+                    ++b.contractedNeighbours[e.target];
+                }
+            }
+            b.contracted[v] = true;
+            rank[v] = nextRank++;
+            //drop edges into v so later witness searches and simulations don't wade through them
+            auto intoV = [v](const Edge &e){return e.target == v;};
+            for (const Edge &e : upOut[v])
+                b.in[e.target].erase(std::remove_if(b.in[e.target].begin(),b.in[e.target].end(),intoV),b.in[e.target].end());
+            for (const Edge &e : upIn[v])
+                b.out[e.target].erase(std::remove_if(b.out[e.target].begin(),b.out[e.target].end(),intoV),b.out[e.target].end());
+            std::vector<Edge>().swap(b.out[v]); //no longer needed
+            std::vector<Edge>().swap(b.in[v]);
+        }
+        toUpward(forward,upOut);
+        toUpward(backward,upIn);
+    }
+
+    uint32_t numVertices() const noexcept
+    {
+        return N;
+    }
+
+    size_t numEdges() const noexcept
+    {
+        return forward.targets.size() + backward.targets.size();
+    }
+
+    //allocates O(N) scratch per call - use the workspace overload for many queries
+    Route<U> query(uint32_t startVertex, uint32_t endVertex) const
+    {
+        QueryWorkspace workspace;
+        return query(startVertex,endVertex,workspace);
+    }
+
+    //the hierarchy is only read, so threads may query concurrently with a workspace each
+    Route<U> query(uint32_t startVertex, uint32_t endVertex, QueryWorkspace &workspace) const
+    {
+        Route<U> route{startVertex,endVertex,infinity,{},0};
+        //test for OOB
+        if ((startVertex >= N)||(endVertex >= N))
+            return route;
+        workspace.reset(N);
+        std::vector<U> &distancesF = workspace.distancesF, &distancesB = workspace.distancesB;
+        std::vector<int32_t> &previousF = workspace.previousF, &previousB = workspace.previousB;
+        std::vector<uint32_t> &touched = workspace.touched;
+        distancesF[startVertex] = 0;
+        distancesB[endVertex] = 0;
+        touched.push_back(startVertex);
+        touched.push_back(endVertex);
+        Heap<IndexWeight> heapF, heapB;
+        heapF.insert({startVertex,0});
+        heapB.insert({endVertex,0});
+        U best = infinity;
+        int32_t meet = -1;
+
+        while (true){
+            bool forwardActive = (!heapF.isEmpty()) && (heapF.getRoot().weight < best);
+            bool backwardActive = (!heapB.isEmpty()) && (heapB.getRoot().weight < best);
+            if (!forwardActive && !backwardActive)
+                break;
+            if (forwardActive && ((!backwardActive) || (heapF.getRoot().weight <= heapB.getRoot().weight)))
+                route.numExpanded += expand(forward,heapF,distancesF,previousF,distancesB,touched,best,meet);
+            else
+                route.numExpanded += expand(backward,heapB,distancesB,previousB,distancesF,touched,best,meet);
+        }
+        if (meet < 0)
+            return route;
+        route.distance = best;
+        std::vector<uint32_t> up, down; //hierarchy vertices start ... meet and meet ... end
+        for (int32_t u = meet; u >= 0; u = previousF[u])
+            up.push_back(u);
+        std::reverse(up.begin(),up.end());
+        for (int32_t u = previousB[meet]; u >= 0; u = previousB[u])
+            down.push_back(u);
+        route.path.push_back(startVertex);
+        for (size_t i = 1; i < up.size(); ++i)
+            unpack(up[i-1],up[i],route.path);
+        uint32_t last = meet;
+        for (uint32_t u : down){
+            unpack(last,u,route.path);
+            last = u;
+        }
+        return route;
+    }
+
+    bool save(const std::string &fileName) const
+    {
+        std::ofstream file(fileName,std::ios::binary);
+        if (!file)
+            return false;
+        const uint32_t version = 1;
+        const uint32_t weightSize = sizeof(U);
+        file.write("CHGR",4);
+        file.write(reinterpret_cast<const char*>(&version),sizeof(version));
+        file.write(reinterpret_cast<const char*>(&weightSize),sizeof(weightSize));
+        file.write(reinterpret_cast<const char*>(&N),sizeof(N));
+        writeVector(file,rank);
+        for (const UpwardGraph *graph : {&forward,&backward}){
+            uint64_t numEdges = graph->targets.size();
+            file.write(reinterpret_cast<const char*>(&numEdges),sizeof(numEdges));
+            writeVector(file,graph->offsets);
+            writeVector(file,graph->targets);
+            writeVector(file,graph->weights);
+            writeVector(file,graph->middles);
+        }
+        return static_cast<bool>(file);
+    }
+
+    //false, leaving this hierarchy unchanged, if the file is unreadable, truncated or inconsistent
+    bool load(const std::string &fileName)
+    {
+        std::ifstream file(fileName,std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        const uint64_t fileSize = file.tellg();
+        file.seekg(0);
+        char magic[4];
+        uint32_t version = 0, weightSize = 0, numVertices = 0;
+        file.read(magic,4);
+        file.read(reinterpret_cast<char*>(&version),sizeof(version));
+        file.read(reinterpret_cast<char*>(&weightSize),sizeof(weightSize));
+        file.read(reinterpret_cast<char*>(&numVertices),sizeof(numVertices));
+        if ((!file) || (std::string(magic,4) != "CHGR") || (version != 1) || (weightSize != sizeof(U)))
+            return false;
+        //sizes are checked against what is left of the file before allocating
+        auto remaining = [&](){return fileSize - static_cast<uint64_t>(file.tellg());};
+        if (static_cast<uint64_t>(numVertices) * sizeof(uint32_t) > remaining())
+            return false;
+        ContractionHierarchy<U> loaded;
+        loaded.N = numVertices;
+        if (!readVector(file,loaded.rank,numVertices))
+            return false;
+        std::vector<bool> rankUsed(numVertices,false); //ranks must be a permutation of 0 ... N-1
+        for (uint32_t r : loaded.rank){
+            if ((r >= numVertices) || rankUsed[r])
+                return false;
+            rankUsed[r] = true;
+        }
+        const uint64_t bytesPerEdge = sizeof(uint32_t) + sizeof(U) + sizeof(int32_t);
+        for (UpwardGraph *graph : {&loaded.forward,&loaded.backward}){
+            uint64_t numEdges = 0;
+            file.read(reinterpret_cast<char*>(&numEdges),sizeof(numEdges));
+            if ((!file) || (remaining() / sizeof(uint64_t) < static_cast<uint64_t>(numVertices) + 1))
+                return false;
+            if ((!readVector(file,graph->offsets,numVertices + 1)) || (numEdges > remaining() / bytesPerEdge))
+                return false;
+            if ((!readVector(file,graph->targets,numEdges)) || (!readVector(file,graph->weights,numEdges)) || (!readVector(file,graph->middles,numEdges)))
+                return false;
+            if (!loaded.validUpward(*graph))
+                return false;
+        }
+        *this = std::move(loaded);
+        return true;
+    }
+};
+
+//plain Dijkstra for comparison
+template<typename T,typename U>
+U dijkstraDistance(const CSRGraph<T,U> &graph, uint32_t startVertex, uint32_t endVertex)
+{
+    struct Entry{
+        uint32_t vertex;
+        U weight;
+        bool operator< (const Entry& A) const { return this->weight < A.weight;};
+        bool operator> (const Entry& A) const { return this->weight > A.weight;};
+    };
+    std::vector<U> distances(graph.numVertices(),std::numeric_limits<U>::max());
+    distances[startVertex] = 0;
+    Heap<Entry> heap;
+    heap.insert(Entry{startVertex,0});
+    while (!heap.isEmpty()){
+        Entry current = heap.getRoot();
+        heap.removeRoot();
+        if (current.vertex == endVertex)
+            return current.weight;
+        if (current.weight > distances[current.vertex])
+            continue;
+        for (const auto & neighbourData : graph.neighbours(current.vertex)){
+            U newDist = current.weight + neighbourData.second;
+            if (newDist < distances[neighbourData.first]){
+                distances[neighbourData.first] = newDist;
+                heap.insert(Entry{neighbourData.first,newDist});
+            }
+        }
+    }
+    return std::numeric_limits<U>::max();
+}
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    int32_t N = 9;    // number of vertices in graph
+    Graph<T,U> graph(N); //uses ./sample_graph.jpeg
+    graph.addEdgeUndirected(0,1,4);
+    graph.addEdgeUndirected(0,7,8);
+    graph.addEdgeUndirected(1,7,11);
+    graph.addEdgeUndirected(1,2,8);
+    graph.addEdgeUndirected(7,6,1);
+    graph.addEdgeUndirected(7,8,7);
+    graph.addEdgeUndirected(8,2,2);
+    graph.addEdgeUndirected(6,8,6);
+    graph.addEdgeUndirected(6,5,2);
+    graph.addEdgeUndirected(2,3,7);
+    graph.addEdgeUndirected(2,5,4);
+    graph.addEdgeUndirected(5,3,14);
+    graph.addEdgeUndirected(3,4,9);
+    graph.addEdgeUndirected(5,4,10);
+
+    ContractionHierarchy<U> ch(graph);
+    std::cout<<"hierarchy has "<<ch.numEdges()<<" upward edges"<<std::endl;
+    for (uint32_t v = 1; v < 9; ++v){
+        Route<U> route = ch.query(0,v);
+        std::cout<<"0 -> "<<v<<" : "<<route.distance<<", path : ";
+        for (auto u : route.path)
+            std::cout<<u<<" ";
+        std::cout<<std::endl;
+    }
+
+    //road-like grid with random weights
+    const uint32_t side = 150;
+    RndUniform rnd;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList;
+    for (uint32_t r = 0; r < side; ++r){
+        for (uint32_t c = 0; c < side; ++c){
+            uint32_t u = r*side + c;
+            if (c + 1 < side){
+                U w = 10 + 90*rnd();
+                edgeList.emplace_back(u,u + 1,w);
+                edgeList.emplace_back(u + 1,u,w);
+            }
+            if (r + 1 < side){
+                U w = 10 + 90*rnd();
+                edgeList.emplace_back(u,u + side,w);
+                edgeList.emplace_back(u + side,u,w);
+            }
+        }
+    }
+    CSRGraph<T,U> road(side*side,edgeList);
+
+    auto start = std::chrono::steady_clock::now();
+    ContractionHierarchy<U> roadCH(road);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<std::endl<<side*side<<" vertices, "<<road.numEdges()<<" edges -> "<<roadCH.numEdges()<<" upward edges, preprocessing "
+             <<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+
+    std::string fileName = (std::filesystem::temp_directory_path() / "road.ch").string();
+    ContractionHierarchy<U> loadedCH;
+    bool roundTrip = roadCH.save(fileName) && loadedCH.load(fileName);
+    std::cout<<"saved and loaded "<<fileName<<": "<<roundTrip<<std::endl;
+
+    //damaged copies must be refused - truncated, and one target pointing past N
+    bool rejected = true;
+    {
+        std::filesystem::resize_file(fileName,std::filesystem::file_size(fileName) / 2);
+        ContractionHierarchy<U> damaged;
+        rejected = rejected && !damaged.load(fileName);
+        roadCH.save(fileName);
+        std::fstream file(fileName,std::ios::binary | std::ios::in | std::ios::out);
+        uint64_t firstTarget = 16 + 4*static_cast<uint64_t>(side*side) + 8 + 8*(static_cast<uint64_t>(side*side) + 1);
+        uint32_t badTarget = side*side + 5;
+        file.seekp(firstTarget);
+        file.write(reinterpret_cast<const char*>(&badTarget),sizeof(badTarget));
+        file.close();
+        rejected = rejected && !damaged.load(fileName);
+    }
+    std::filesystem::remove(fileName);
+    std::cout<<"damaged files rejected: "<<rejected<<std::endl;
+
+    const uint32_t numQueries = 200;
+    bool agree = true;
+    double chMs = 0, dijkstraMs = 0;
+    size_t expanded = 0;
+    ContractionHierarchy<U>::QueryWorkspace workspace;
+    for (uint32_t q = 0; q < numQueries; ++q){
+        uint32_t s = side*side*rnd();
+        uint32_t t = side*side*rnd();
+        start = std::chrono::steady_clock::now();
+        Route<U> route = loadedCH.query(s,t,workspace);
+        end = std::chrono::steady_clock::now();
+        chMs += std::chrono::duration<double,std::milli>(end-start).count();
+        start = std::chrono::steady_clock::now();
+        U expected = dijkstraDistance(road,s,t);
+        end = std::chrono::steady_clock::now();
+        dijkstraMs += std::chrono::duration<double,std::milli>(end-start).count();
+        expanded += route.numExpanded;
+        //check distance and that the unpacked path really has that length
+        U pathLength = 0;
+        for (size_t i = 1; i < route.path.size(); ++i){
+            U w = std::numeric_limits<U>::max();
+            for (const auto & neighbourData : road.neighbours(route.path[i-1]))
+                if (neighbourData.first == route.path[i])
+                    w = std::min(w,neighbourData.second);
+            pathLength += w;
+        }
+        agree = agree && (route.distance == expected) && (pathLength == expected) && (route.path.front() == s) && (route.path.back() == t);
+    }
+    std::cout<<numQueries<<" random queries, agree with Dijkstra: "<<agree<<std::endl;
+    std::cout<<"contraction hierarchy : "<<chMs/numQueries<<" ms/query, "<<expanded/numQueries<<" vertices expanded"<<std::endl;
+    std::cout<<"dijkstra              : "<<dijkstraMs/numQueries<<" ms/query"<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,396 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Delta-stepping shortest paths (parallel) and batched multi-source Dijkstra
+
+Dijkstra (see dijkstra.cpp) settles exactly one vertex at a time, so there is nothing to do in
+parallel. Delta-stepping (Meyer & Sanders) relaxes that: tentative distances are grouped into
+buckets of width delta,
+
+    bucket i holds vertices with tentative distance in [i*delta, (i+1)*delta)
+
+and every vertex in the lowest non-empty bucket is processed at once. Edges are split into
+
+    light : weight <= delta - can move a vertex into the *current* bucket
+    heavy : weight >  delta - can only ever move a vertex into a *later* bucket
+
+So for the current bucket we:
+
+1. Relax the light edges of every vertex in it, in parallel, repeating while relaxations refill it
+2. Relax the heavy edges of every vertex that was settled in it, in parallel, once
+3. Move on to the next non-empty bucket
+
+delta = 1 (integer weights) is Dijkstra with ties processed together; delta = infinity is
+Bellman-Ford. In between we trade some re-relaxation work for parallelism.
+
+Buckets are a cyclic array of maxWeight/delta + 2 slots rather than one per possible distance:
+every vertex still to be settled is within maxWeight of the current bucket, so memory depends on
+the weight range, not on how long the paths get.
+
+Tentative distances are std::atomic and lowered with compare-exchange, so threads racing to
+improve the same vertex is fine. Successful relaxations are collected per thread and merged into
+the buckets between phases. Predecessors are recovered afterwards from the final distances.
+
+For many sources (distance tables) it is better to run independent single-source searches
+concurrently instead - shortestPathsBatch does this, one heap Dijkstra per source, with threads
+taking sources from a shared counter.
+
+Restrictions:
+    Edge weights must be positive
+
+*/
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "heap.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+//struct for route info from origin vertex
+template<typename U>
+struct Routes{
+    size_t origin;
+    std::vector<U> distances;
+    std::vector<int32_t> previous;
+};
+
+//Extend Graph class
+template<typename T,typename U,typename Base = Graph<T,U> > //T value at nodes, U edge weights, Base adjacency storage (Graph or CSRGraph)
+class DeltaSteppingGraph : public Base
+{
+    //encapsulation of vertex index and distance with comparison overloads for heap version
+    struct IndexWeight
+    {
+        size_t vertex;
+        U weight;
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+        IndexWeight(){}
+        template<typename V,typename W>
+        IndexWeight(V &&v_, W &&w_):vertex(std::forward<V>(v_)),weight(std::forward<W>(w_)){}
+    };
+
+    //relax edges of vertices[begin,end) passing filter - record improvements as (bucket,vertex)
+    template<typename EdgeFilter>
+    void relax(const std::vector<uint32_t> &vertices, size_t begin, size_t end,
+               std::vector<std::atomic<U> > &distances, const U delta,
+               EdgeFilter &&useEdge, std::vector<std::pair<size_t,uint32_t> > &requests) const
+    {
+        for (size_t i = begin; i < end; ++i){
+            uint32_t u = vertices[i];
+            U du = distances[u].load(std::memory_order_relaxed);
+            for (const auto & neighbourData : this->neighbours(u)){
+                if (!useEdge(neighbourData.second))
+                    continue;
+                U newDist = du + neighbourData.second;
+                U oldDist = distances[neighbourData.first].load(std::memory_order_relaxed);
+                while (newDist < oldDist){ //atomic min
+                    if (distances[neighbourData.first].compare_exchange_weak(oldDist,newDist,std::memory_order_relaxed)){
+                        requests.push_back({static_cast<size_t>(newDist / delta),neighbourData.first});
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    //any neighbour u with dist[u] + w == dist[v] is a valid previous vertex for v
+    std::vector<int32_t> previousFromDistances(size_t startVertex, const std::vector<U> &distances, uint32_t numThreads) const
+    {
+        const U infinity = std::numeric_limits<U>::max();
+        std::vector<std::atomic<int32_t> > previous(this->numVertices());
+        for (auto &p : previous)
+            p.store(-1,std::memory_order_relaxed);
+        parallelFor(this->numVertices(),numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t u = begin; u < end; ++u){
+                if (distances[u] == infinity)
+                    continue;
+                for (const auto & neighbourData : this->neighbours(u))
+                    if ((neighbourData.first != startVertex) && (distances[u] + neighbourData.second == distances[neighbourData.first]))
+                        previous[neighbourData.first].store(u,std::memory_order_relaxed);
+            }
+        });
+        std::vector<int32_t> result(previous.size());
+        for (size_t i = 0; i < previous.size(); ++i)
+            result[i] = previous[i].load(std::memory_order_relaxed);
+        result[startVertex] = startVertex;
+        return result;
+    }
+
+public:
+    DeltaSteppingGraph(): Base(){}
+    DeltaSteppingGraph(const uint32_t N): Base(N){}
+    DeltaSteppingGraph(const Graph<T,U> &graph): Base(graph){} //e.g. Base = CSRGraph<T,U>
+
+    U maxEdgeWeight() const
+    {
+        U maxWeight = 0;
+        for (uint32_t u = 0; u < this->numVertices(); ++u)
+            for (const auto & neighbourData : this->neighbours(u))
+                maxWeight = std::max(maxWeight,neighbourData.second);
+        return maxWeight;
+    }
+
+    //bucket width heuristic - max edge weight / average degree, at least 1
+    U defaultDelta() const
+    {
+        size_t numEdges = 0;
+        for (uint32_t u = 0; u < this->numVertices(); ++u)
+            numEdges += this->neighbours(u).size();
+        if (!numEdges)
+            return static_cast<U>(1);
+        U delta = static_cast<U>(maxEdgeWeight() * this->numVertices() / numEdges);
+        return std::max(delta,static_cast<U>(1));
+    }
+
+    //distance and routes to all nodes
+    Routes<U> deltaStepping(size_t startVertex, U delta = 0, uint32_t numThreads = defaultThreads()) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        if (delta <= 0)
+            delta = defaultDelta();
+        numThreads = std::max<uint32_t>(1,numThreads);
+        const size_t N = this->numVertices();
+        const U infinity = std::numeric_limits<U>::max();
+
+        std::vector<std::atomic<U> > distances(N);
+        for (auto &d : distances)
+            d.store(infinity,std::memory_order_relaxed);
+        distances[startVertex].store(0,std::memory_order_relaxed);
+
+        //cyclic buckets - absolute bucket b lives in slot b % numBuckets. Everything still to be
+        //settled is within maxWeight of the current bucket, so no two live buckets share a slot
+        const size_t numBuckets = static_cast<size_t>(maxEdgeWeight() / delta) + 2;
+        std::vector<std::vector<uint32_t> > buckets(numBuckets);
+        buckets[0].push_back(static_cast<uint32_t>(startVertex));
+        std::vector<std::vector<std::pair<size_t,uint32_t> > > requests(numThreads); //per thread (bucket,vertex)
+        std::vector<uint32_t> frontier, settled;
+        std::vector<size_t> inFrontier(N,-1), settledIn(N,-1); //phase/bucket stamps to avoid duplicates
+        size_t phase = 0;
+
+        auto mergeRequests = [&](){
+            for (auto & threadRequests : requests){
+                for (const auto & request : threadRequests)
+                    buckets[request.first % numBuckets].push_back(request.second);
+                threadRequests.clear();
+            }
+        };
+        auto isLight = [delta](const U w){return w <= delta;};
+        auto isHeavy = [delta](const U w){return w > delta;};
+
+        size_t current = 0;
+        while (true){
+            std::vector<uint32_t> &bucket = buckets[current % numBuckets];
+            settled.clear();
+            while (!bucket.empty()){
+                //take the bucket, dropping stale entries (moved to an earlier bucket) and duplicates
+                frontier.clear();
+                for (uint32_t v : bucket){
+                    size_t vBucket = static_cast<size_t>(distances[v].load(std::memory_order_relaxed) / delta);
+                    if ((vBucket == current) && (inFrontier[v] != phase)){
+                        inFrontier[v] = phase;
+                        frontier.push_back(v);
+                        if (settledIn[v] != current){
+                            settledIn[v] = current;
+                            settled.push_back(v);
+                        }
+                    }
+                }
+                bucket.clear();
+                ++phase;
+                parallelFor(frontier.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+                    relax(frontier,begin,end,distances,delta,isLight,requests[t]);
+                });
+                mergeRequests();
+            }
+            parallelFor(settled.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+                relax(settled,begin,end,distances,delta,isHeavy,requests[t]);
+            });
+            mergeRequests();
+            //next non-empty bucket - done once a full turn finds none
+            size_t step = 1;
+            while ((step < numBuckets) && buckets[(current + step) % numBuckets].empty())
+                ++step;
+            if (step == numBuckets)
+                break;
+            current += step;
+        }
+
+        std::vector<U> result(N);
+        for (size_t i = 0; i < N; ++i)
+            result[i] = distances[i].load(std::memory_order_relaxed);
+        std::vector<int32_t> previous = previousFromDistances(startVertex,result,numThreads);
+        return {startVertex,std::move(result),std::move(previous)};
+    }
+
+    //sequential heap Dijkstra - as dijkstra.cpp, unreachable vertices have distance numeric_limits<U>::max()
+    Routes<U> dijkstraHeap(size_t startVertex) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        std::vector<bool> visited(this->numVertices(),false);
+        std::vector<U> distances(this->numVertices(),std::numeric_limits<U>::max());
+        distances[startVertex] = static_cast<U>(0); //zero distance to itself
+        std::vector<int32_t> previous(this->numVertices(),-1);
+        previous[startVertex] = startVertex;
+        Heap<IndexWeight> distancesHeap;
+        distancesHeap.insert({startVertex,0});
+
+        while(!distancesHeap.isEmpty()){
+            IndexWeight currentVertex = distancesHeap.getRoot();
+            distancesHeap.removeRoot();
+            if (visited[currentVertex.vertex]) //stale heap entry
+                continue;
+            visited[currentVertex.vertex] = true;
+            for (const auto & neighbourData : this->neighbours(currentVertex.vertex)){
+                U newDist = currentVertex.weight + neighbourData.second;
+                if ((!visited[neighbourData.first]) && (newDist < distances[neighbourData.first])){
+                    distances[neighbourData.first] = newDist;
+                    previous[neighbourData.first] = currentVertex.vertex;
+                    distancesHeap.insert({neighbourData.first,newDist});
+                }
+            }
+        }
+        return {startVertex,std::move(distances),std::move(previous)};
+    }
+
+    //many sources at once - independent Dijkstra searches spread over threads
+    std::vector<Routes<U> > shortestPathsBatch(const std::vector<size_t> &sources, uint32_t numThreads = defaultThreads()) const
+    {
+        std::vector<Routes<U> > results(sources.size());
+        std::atomic<size_t> next(0);
+        auto worker = [&](){
+            for (size_t i = next.fetch_add(1); i < sources.size(); i = next.fetch_add(1))
+                results[i] = dijkstraHeap(sources[i]);
+        };
+        numThreads = std::max<uint32_t>(1,std::min<size_t>(numThreads,sources.size()));
+        std::vector<std::thread> threads;
+        for (uint32_t t = 1; t < numThreads; ++t)
+            threads.emplace_back(worker);
+        worker();
+        for (auto &thread : threads)
+            thread.join();
+        return results;
+    }
+};
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    int32_t N = 9;    // number of vertices in graph
+    DeltaSteppingGraph<T,U> graph(N); //uses ./sample_graph.jpeg
+    graph.addEdgeUndirected(0,1,4);
+    graph.addEdgeUndirected(0,7,8);
+    graph.addEdgeUndirected(1,7,11);
+    graph.addEdgeUndirected(1,2,8);
+    graph.addEdgeUndirected(7,6,1);
+    graph.addEdgeUndirected(7,8,7);
+    graph.addEdgeUndirected(8,2,2);
+    graph.addEdgeUndirected(6,8,6);
+    graph.addEdgeUndirected(6,5,2);
+    graph.addEdgeUndirected(2,3,7);
+    graph.addEdgeUndirected(2,5,4);
+    graph.addEdgeUndirected(5,3,14);
+    graph.addEdgeUndirected(3,4,9);
+    graph.addEdgeUndirected(5,4,10);
+
+    //start vertex
+    int32_t v = 0;
+
+    std::cout<<"delta-stepping, delta = "<<graph.defaultDelta()<<std::endl;
+    Routes<U> routes = graph.deltaStepping(v);
+    std::cout<<"distances and paths from vertex "<<routes.origin<<std::endl;
+    for (size_t i=0;i<routes.distances.size();++i){
+        std::cout<<i<<": "<<routes.distances[i]<<std::endl<<"path (reversed) : ";
+        int32_t u = i;
+        std::cout<<u<<" ";
+        while ((u != v)&&(u>=0)){
+            std::cout<<routes.previous[u]<<" ";
+            u = routes.previous[u];
+        }
+        std::cout<<std::endl<<std::endl;
+    }
+
+    //larger random graph - compare against sequential Dijkstra
+    const uint32_t bigN = 200000;
+    const uint32_t bigE = 2000000;
+    RndUniform rnd;
+    DeltaSteppingGraph<T,U> bigGraph(bigN);
+    for (uint32_t e = 0; e < bigE; ++e)
+        bigGraph.addEdge(bigN*rnd(),bigN*rnd(),static_cast<U>(1 + 99*rnd()));
+
+    auto start = std::chrono::steady_clock::now();
+    Routes<U> sequential = bigGraph.dijkstraHeap(0);
+    auto mid = std::chrono::steady_clock::now();
+    Routes<U> parallel = bigGraph.deltaStepping(0);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<bigN<<" vertices, "<<bigE<<" edges, "<<std::thread::hardware_concurrency()<<" threads"<<std::endl;
+    std::cout<<"dijkstraHeap  : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"deltaStepping : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"distances agree: "<<(sequential.distances == parallel.distances)<<std::endl;
+
+    //same search over the packed CSR representation
+    DeltaSteppingGraph<T,U,CSRGraph<T,U> > csrGraph(bigGraph);
+    start = std::chrono::steady_clock::now();
+    Routes<U> parallelCSR = csrGraph.deltaStepping(0);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"deltaStepping (csr) : "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+    std::cout<<"distances agree: "<<(sequential.distances == parallelCSR.distances)<<std::endl;
+
+    std::vector<size_t> sources = {0,1,2,3,4,5,6,7};
+    start = std::chrono::steady_clock::now();
+    std::vector<Routes<U> > batch = bigGraph.shortestPathsBatch(sources);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"shortestPathsBatch ("<<sources.size()<<" sources): "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+    std::cout<<"batch source 0 agrees: "<<(batch[0].distances == sequential.distances)<<std::endl;
+
+    //long paths with a small delta - distances reach 10^8 buckets, held in 5002 cyclic slots
+    const uint32_t chainN = 20001;
+    Graph<T,U> chainBuild(chainN);
+    for (uint32_t u = 0; u + 1 < chainN; ++u)
+        chainBuild.addEdgeUndirected(u,u + 1,5000);
+    DeltaSteppingGraph<T,U,CSRGraph<T,U> > chain(chainBuild);
+    start = std::chrono::steady_clock::now();
+    Routes<U> chainRoutes = chain.deltaStepping(0,1);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"chain of "<<chainN<<" vertices, delta 1, distance "<<chainRoutes.distances[chainN - 1]<<": "
+             <<std::chrono::duration<double,std::milli>(end-start).count()<<" ms, agrees: "
+             <<(chainRoutes.distances == chain.dijkstraHeap(0).distances)<<std::endl;
+
+    return 0;
+}
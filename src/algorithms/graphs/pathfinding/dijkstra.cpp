@@ -19,192 +19,31 @@
 
 /*
 
-Dijkstra Shortest paths algorithm.
-
-Greedy algorithm for finding shortest paths/and their lengths from a specified vertex, 
-to all other vertices on a graph.
-
-Complexity: 
-    Using naive search   : O(|V|^2)            - implemented
-    Using min-heap       : O((|V|+|E|)log |V|) - implemented
-    Using Fibonnaci heap : O(|E|+|V|log |V|)   - not implemented
-
-Restrictions:
-    Edge weights must be positive
-
-Fundamentally exploits the property that:
-
-    The minimum distance to a vertex from the origin must be the distance from the origin 
-    to one of its neighbours to the origin, plus the distance from the neighbour to the vertex.
-
-Consequently, by starting at the origin and working our way out, we can visit vertices with
-established minimum distances and thus determine possible minimum distances to all the current 
-vertex's neighbours by comparing the current tentative values associated with the neighbours 
-with the current vertex distance + the known inter-neighbour distances.
-
-The minimum updated distance is then a candidate for the shortest route to any given vertex, as 
-it is the smallest path out from the origin found so far.
-
-So, we:
-
-1. Visit all vertices eventually, starting at the origin - with distance to origin 0.
-2. Know that the distance we have recorded to the current vertex is minimal
-3. Update proposed minimal distances to all neighbours of the current vertex using edge weights
-4. Remove the current vertex from the possible traversal candidates (we know its minimal distance)
-5. Visit the vertex with the smallest minimal distance is an unvisited set - this is now known to 
-   be the minimal distance
-   It has to be minimal, because of the key property above and the fact we tested all other edges
-   from its minimal neighbour - we can't find a shorter way to this vertex as it would at least
-   incur an edge weight greater than the immediate step we just took.
-6. iterate until all vertices visited
-
-The key optimisation part of the algorithm is in the "visit vertex with smallest minimum distance". 
-By using a priority queue, e.g. through a heap, we can improve this - by keeping small values at the front. 
-We need to extend a regular minHeap because we need to access the neighbours of the minium element within 
-the heap, updated them, and then re-heapify the heap - i.e. send new smallest values to the front.
-
-Here we do this with class "IndexedHeap" which hashes elements in the heap to their index in the underlying 
-array. We need to update key functions like "swap" so these hashed indices swap when data in the heap is 
-moved around in sendUp(),sendDown() etc. calls.
+Shortest routes on a sample graph and a large random graph - Dijkstra, bidirectional and A*
 
 */
 
 #include <iostream>
-#include <utility>
 #include <vector>
-#include <unordered_map>
-#include <cmath>
+#include <chrono>
 #include "graph.hpp"
-#include "heap.hpp"
-#include "indexedheap.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
+#include "random.hpp"
+#include "dijkstra.hpp"
 
 using namespace structures_and_algorithms::structures::graphs;
-using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::algorithms::graphs;
 
-#define MAXDIST std::pow(2,16) // should do for this example
-
-//struct for route info from origin vertex
 template<typename U>
-struct Routes{
-    size_t origin;
-    std::vector<U> distances;
-    std::vector<int32_t> previous;
-};
-
-//Extend Graph class
-template<typename T,typename U> //T value at nodes, U edge weights
-class DijkstraGraph : public Graph<T,U>
-{  
-    //encapsulation of vertex index and distance with comparison overloads for heap version
-    struct IndexWeight
-    {
-        size_t vertex;
-        U weight;    
-        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
-        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
-        IndexWeight(){}
-        template<typename V,typename W>
-        IndexWeight(V &&v_, W &&w_):vertex(std::forward<V>(v_)),weight(std::forward<W>(w_)){}
-        bool operator==(const IndexWeight &val)const noexcept{return this->vertex == val.vertex;}
-        //need == operator for hashtable
-    };
-
-    //find minimum unvisited distance for simple version
-    size_t findMinIndex(const std::vector<bool> &visited,const std::vector<U> &distances) const
-    {
-        U runningMin = MAXDIST;
-        size_t index = 0;
-        for (size_t i=0;i<this->vertexData.size();++i){
-            if ((!visited[i])&&(distances[i]<runningMin)){
-                runningMin = distances[i];
-                index = i;
-            }
-        }
-        return index;
-    }
-
-public:
-    DijkstraGraph(): Graph<T,U>(){}
-    DijkstraGraph(const uint32_t N): Graph<T,U>(N){}
-
-    //distance and routes to all nodes by default - will stop if endVertex reached
-    Routes<U> dijkstraSimple(size_t startVertex, size_t endVertex = -1) const
-    {
-        //test for OOB
-        if (startVertex >= this->vertexData.size())
-            return {};
-        //record of visitation
-        std::vector<bool> visited(this->vertexData.size(),false); 
-        //distance values
-        std::vector<U> distances(this->vertexData.size(),MAXDIST);
-        distances[startVertex] = static_cast<U>(0);//zero distance to itself
-        //previous vertex for path iteration
-        std::vector<int32_t> previous(this->vertexData.size(),-1); 
-        previous[startVertex] = startVertex;
-
-        size_t count = 0;
-        while(count < this->vertexData.size()){ //visit every vertex           
-            size_t currentVertex = findMinIndex(visited,distances); //get vertex currently "closest" to start
-            for (auto & neighbourData : this->edges[currentVertex]){ //loop of neighbours
-                const uint32_t &neighbourVertex = neighbourData.first; //neighbour vertex
-                const U &neighbourDistance = neighbourData.second; //distance from current to neighbour
-                if (!visited[neighbourVertex]){ //if neighbour not previously visited
-                    U newDist = distances[currentVertex] + neighbourDistance; //proposed new distance to neighbour from start
-                    if (newDist < distances[neighbourVertex]){ //if lower
-                            distances[neighbourVertex] = newDist; //update distance to neighbour from start
-                            previous[neighbourVertex] = currentVertex; //update previous vertex to neighbour in path
-                    }
-                }
-            }
-            visited[currentVertex] = true; //mark current vertex as visited
-            ++count;
-            if (currentVertex == endVertex)
-                break;
-        }
-        return {startVertex,std::move(distances),std::move(previous)};
-    }
-
-    //distance and routes to all nodes by default - will stop if endVertex reached
-    Routes<U> dijkstraHeap(size_t startVertex, size_t endVertex = -1) const
-    {
-        //test for OOB
-        if (startVertex >= this->vertexData.size())
-            return {};
-        //record of visitation
-        std::vector<bool> visited(this->vertexData.size(),false); 
-        visited[startVertex] = true;
-        //distance values
-        std::vector<U> distances(this->vertexData.size(),MAXDIST);
-        distances[startVertex] = static_cast<U>(0); //zero distance to itself
-        //previous vertex for path iteration
-        std::vector<int32_t> previous(this->vertexData.size(),-1); 
-        previous[startVertex] = startVertex;
-        //minheap as priority queue
-        Heap<IndexWeight> distancesHeap;
-        distancesHeap.insert({startVertex,0});
-
-        while(!distancesHeap.isEmpty()){            
-            IndexWeight currentVertex = distancesHeap.getRoot(); //get currently "closest" node from heap - by value as insertions below
-            for (auto & neighbourData : this->edges[currentVertex.vertex]){//loop through neighbours
-                const uint32_t &neighbourVertex = neighbourData.first; //vertex of neighbour
-                const U &neighbourDistance = neighbourData.second; //distance to neighbour from current
-                if (!visited[neighbourVertex]){ //if unvisited
-                    U newDist = currentVertex.weight + neighbourDistance; //trial distance
-                    if (newDist < distances[neighbourVertex]){ //if closer
-                            distances[neighbourVertex] = newDist; //update distance to neighbour
-                            previous[neighbourVertex] = currentVertex.vertex; //update previous vertex in path
-                            distancesHeap.insert({neighbourVertex,newDist}); // add new (non infinity) distance into priority queue
-                    }
-                }
-            }
-            visited[currentVertex.vertex] = true; //mark current vertex as visited
-            if (currentVertex.vertex == endVertex)
-                break;
-            distancesHeap.removeRoot(); //remove visited vertex from heap
-        }
-        return {startVertex,std::move(distances),std::move(previous)};
-    }
-};
+void printRoute(const Route<U> &route)
+{
+    std::cout<<route.origin<<" -> "<<route.target<<" : "<<route.distance<<", path : ";
+    for (auto u : route.path)
+        std::cout<<u<<" ";
+    std::cout<<"("<<route.numExpanded<<" vertices expanded)"<<std::endl;
+}
 
 auto main(/*int argc, char* argv[]*/)->int
 {
@@ -264,5 +103,75 @@ auto main(/*int argc, char* argv[]*/)->int
         std::cout<<std::endl<<std::endl;
     }
 
+    //point to point
+    std::cout<<std::endl<<"point to point 0 -> 4"<<std::endl;
+    printRoute(graph.dijkstraBidirectional(v,4));
+    printRoute(graph.aStar(v,4,[](size_t){return 0;})); //zero heuristic - plain Dijkstra order
+
+    //grid graph with random weights >= 1 - Manhattan distance is an admissible heuristic
+    const int32_t side = 300;
+    DijkstraGraph<T,U> grid(side*side);
+    RndUniform rnd;
+    for (int32_t r = 0; r < side; ++r){
+        for (int32_t c = 0; c < side; ++c){
+            if (c + 1 < side)
+                grid.addEdgeUndirected(r*side + c,r*side + c + 1,static_cast<U>(1 + 3*rnd()));
+            if (r + 1 < side)
+                grid.addEdgeUndirected(r*side + c,(r + 1)*side + c,static_cast<U>(1 + 3*rnd()));
+        }
+    }
+    size_t from = (side/4)*side + side/4;
+    size_t to = (3*side/4)*side + 3*side/4;
+    auto manhattan = [&](size_t u)->U{
+        return std::abs(static_cast<int32_t>(u/side) - static_cast<int32_t>(to/side)) + std::abs(static_cast<int32_t>(u%side) - static_cast<int32_t>(to%side));
+    };
+    Routes<U> full = grid.dijkstraHeap(from);
+    Route<U> bidirectional = grid.dijkstraBidirectional(from,to,true);
+    Route<U> astar = grid.aStar(from,to,manhattan);
+    std::cout<<std::endl<<side<<"x"<<side<<" grid, "<<from<<" -> "<<to<<" ("<<side*side<<" vertices)"<<std::endl;
+    std::cout<<"dijkstraHeap           : "<<full.distances[to]<<std::endl;
+    std::cout<<"dijkstraBidirectional  : "<<bidirectional.distance<<" ("<<bidirectional.numExpanded<<" expanded)"<<std::endl;
+    std::cout<<"aStar                  : "<<astar.distance<<" ("<<astar.numExpanded<<" expanded)"<<std::endl<<std::endl;
+
+    //back to back short queries (to within 10 rows/columns) - fresh arrays per query vs one reused workspace
+    const size_t numQueries = 2000;
+    std::vector<std::pair<size_t,size_t> > queries(numQueries);
+    for (auto &query : queries){
+        int32_t r = (side - 10)*rnd(), c = (side - 10)*rnd();
+        query = {static_cast<size_t>(r*side + c),static_cast<size_t>((r + static_cast<int32_t>(10*rnd()))*side + c + static_cast<int32_t>(10*rnd()))};
+    }
+    DijkstraGraph<T,U>::Workspace workspace;
+    std::vector<U> fresh(numQueries), reused(numQueries);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < numQueries; ++q)
+        fresh[q] = grid.dijkstraHeap(queries[q].first,queries[q].second).distances[queries[q].second];
+    auto mid = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < numQueries; ++q)
+        reused[q] = grid.dijkstraHeap(queries[q].first,queries[q].second,workspace).distance;
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<numQueries<<" queries, new arrays each : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<numQueries<<" queries, reused workspace: "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"agree: "<<(fresh == reused)<<std::endl<<std::endl;
+
+    //a route longer than 2^16 - must still be found, and an isolated vertex reported unreachable
+    DijkstraGraph<T,U> chain(6);
+    for (int32_t u = 0; u + 1 < 5; ++u)
+        chain.addEdgeUndirected(u,u + 1,30000);
+    DijkstraGraph<T,U>::Workspace chainWorkspace;
+    const U chainLength = 4*30000;
+    bool longRoute = (chain.dijkstraSimple(0).distances[4] == chainLength) && (chain.dijkstraHeap(0).distances[4] == chainLength)
+                     && (chain.dijkstraHeap(0,4,chainWorkspace).distance == chainLength)
+                     && (chain.dijkstraBidirectional(0,4,true).distance == chainLength) && (chain.dijkstraBidirectional(0,4).distance == chainLength)
+                     && (chain.aStar(0,4,[](size_t){return 0;}).distance == chainLength);
+    bool noRoute = (chain.dijkstraSimple(0).distances[5] == DijkstraGraph<T,U>::unreachable)
+                   && (chain.dijkstraHeap(0,5,chainWorkspace).distance == DijkstraGraph<T,U>::unreachable)
+                   && chain.dijkstraBidirectional(0,5).path.empty() && chain.aStar(0,5,[](size_t){return 0;}).path.empty();
+    std::cout<<"route of length "<<chainLength<<" found: "<<longRoute<<", unreachable vertex reported: "<<noRoute<<std::endl;
+
+    //same search over the packed CSR representation
+    DijkstraGraph<T,U,CSRGraph<T,U> > csrGraph(graph);
+    Routes<U> routesCSR = csrGraph.dijkstraHeap(v);
+    std::cout<<"csr graph agrees: "<<((routesCSR.distances == routesH.distances) && (routesCSR.previous == routesH.previous))<<std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,433 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Dijkstra Shortest paths algorithm.
+
+Greedy algorithm for finding shortest paths/and their lengths from a specified vertex, 
+to all other vertices on a graph.
+
+Complexity: 
+    Using naive search   : O(|V|^2)            - implemented
+    Using min-heap       : O((|V|+|E|)log |V|) - implemented
+    Using Fibonnaci heap : O(|E|+|V|log |V|)   - not implemented
+
+Restrictions:
+    Edge weights must be positive (see bellman_ford.cpp for negative weights)
+
+Fundamentally exploits the property that:
+
+    The minimum distance to a vertex from the origin must be the distance from the origin 
+    to one of its neighbours to the origin, plus the distance from the neighbour to the vertex.
+
+Consequently, by starting at the origin and working our way out, we can visit vertices with
+established minimum distances and thus determine possible minimum distances to all the current 
+vertex's neighbours by comparing the current tentative values associated with the neighbours 
+with the current vertex distance + the known inter-neighbour distances.
+
+The minimum updated distance is then a candidate for the shortest route to any given vertex, as 
+it is the smallest path out from the origin found so far.
+
+So, we:
+
+1. Visit all vertices eventually, starting at the origin - with distance to origin 0.
+2. Know that the distance we have recorded to the current vertex is minimal
+3. Update proposed minimal distances to all neighbours of the current vertex using edge weights
+4. Remove the current vertex from the possible traversal candidates (we know its minimal distance)
+5. Visit the vertex with the smallest minimal distance is an unvisited set - this is now known to 
+   be the minimal distance
+   It has to be minimal, because of the key property above and the fact we tested all other edges
+   from its minimal neighbour - we can't find a shorter way to this vertex as it would at least
+   incur an edge weight greater than the immediate step we just took.
+6. iterate until all vertices visited
+
+The key optimisation part of the algorithm is in the "visit vertex with smallest minimum distance". 
+By using a priority queue, e.g. through a heap, we can improve this - by keeping small values at the front. 
+We need to extend a regular minHeap because we need to access the neighbours of the minium element within 
+the heap, updated them, and then re-heapify the heap - i.e. send new smallest values to the front.
+
+Here we do this with class "IndexedHeap" which hashes elements in the heap to their index in the underlying 
+array. We need to update key functions like "swap" so these hashed indices swap when data in the heap is 
+moved around in sendUp(),sendDown() etc. calls.
+
+Point to point queries - when only the route to one endVertex is wanted:
+
+Bidirectional Dijkstra - search forwards from the start and backwards (along reversed edges) from
+the end, always expanding whichever side has the closer frontier. Each time an edge reaches a
+vertex the other side has already labelled, we have a candidate route; we stop once the two
+frontier distances add up to at least the best candidate. Each side only explores roughly a ball
+of half the radius, which on road-like graphs is a fraction of the vertices.
+
+A* - order the heap by distance so far + heuristic(v), an estimate of the remaining distance to
+the end (e.g. straight line distance for a map). If the heuristic never overestimates ("admissible")
+the first time the end vertex leaves the heap its distance is optimal. A zero heuristic is Dijkstra.
+We allow vertices to be re-expanded if a shorter route to them turns up, so an admissible but
+inconsistent heuristic still gives the right answer.
+
+Both return a Route - the distance, the path in order from start to end, and how many vertices
+were expanded.
+
+Repeated queries - dijkstraHeap(start,end,workspace) takes a Workspace (PathWorkspace plus the
+heap, see traversal_workspace.hpp) that is reset in O(1) rather than allocating and filling
+visited/distances/previous per query. The labels stay in the workspace after the call, so a
+query with end = -1 leaves the full shortest path tree there.
+
+*/
+
+#ifndef DIJKSTRA_H
+#define DIJKSTRA_H
+
+#include <utility>
+#include <vector>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "transpose_cache.hpp"
+#include "traversal_workspace.hpp"
+#include "heap.hpp"
+#include "indexedheap.hpp"
+
+namespace structures_and_algorithms::algorithms::graphs{
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+
+//struct for route info from origin vertex
+template<typename U>
+struct Routes{
+    size_t origin;
+    std::vector<U> distances;
+    std::vector<int32_t> previous;
+};
+
+//struct for a single route between two vertices
+template<typename U>
+struct Route{
+    size_t origin;
+    size_t target;
+    U distance;                 //numeric_limits<U>::max() if unreachable
+    std::vector<uint32_t> path; //origin ... target, empty if unreachable
+    size_t numExpanded;         //vertices taken from the heap(s)
+};
+
+//Extend Graph class
+template<typename T,typename U,typename Base = Graph<T,U> > //T value at nodes, U edge weights, Base adjacency storage (Graph or CSRGraph)
+class DijkstraGraph : public Base
+{  
+    //encapsulation of vertex index and distance with comparison overloads for heap version
+    struct IndexWeight
+    {
+        size_t vertex;
+        U weight;    
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+        IndexWeight(){}
+        template<typename V,typename W>
+        IndexWeight(V &&v_, W &&w_):vertex(std::forward<V>(v_)),weight(std::forward<W>(w_)){}
+        bool operator==(const IndexWeight &val)const noexcept{return this->vertex == val.vertex;}
+        //need == operator for hashtable
+    };
+
+    //entry for A* heap - ordered by distance so far + heuristic
+    struct AStarEntry
+    {
+        size_t vertex;
+        U distance;
+        U estimate;
+        bool operator< (const AStarEntry& A) const { return this->estimate < A.estimate;};
+        bool operator> (const AStarEntry& A) const { return this->estimate > A.estimate;};
+    };
+
+    TransposeCache<T,U> transpose; //incoming edges - built on first use, rebuilt if the graph changes
+
+    //one step of a bidirectional search - expand root of heap, relaxing edges of adjacency
+    //returns false if the root was a stale entry
+    template<typename Adjacency>
+    bool expand(const Adjacency &adjacency, Heap<IndexWeight> &heap, std::vector<U> &distances, std::vector<int32_t> &previous,
+                std::vector<bool> &settled, const std::vector<U> &otherDistances, U &best, int32_t &meet) const
+    {
+        IndexWeight currentVertex = heap.getRoot();
+        heap.removeRoot();
+        if (settled[currentVertex.vertex]) //stale heap entry
+            return false;
+        settled[currentVertex.vertex] = true;
+        for (const auto & neighbourData : adjacency.neighbours(currentVertex.vertex)){
+            const uint32_t &neighbourVertex = neighbourData.first;
+            U newDist = currentVertex.weight + neighbourData.second;
+            if (newDist < distances[neighbourVertex]){
+                distances[neighbourVertex] = newDist;
+                previous[neighbourVertex] = currentVertex.vertex;
+                heap.insert({neighbourVertex,newDist});
+            }
+            if ((otherDistances[neighbourVertex] < unreachable) && (newDist + otherDistances[neighbourVertex] < best)){ //route found via neighbour
+                best = newDist + otherDistances[neighbourVertex];
+                meet = neighbourVertex;
+            }
+        }
+        return true;
+    }
+
+    //find minimum unvisited distance for simple version - numVertices() if every unvisited vertex is unreachable
+    size_t findMinIndex(const std::vector<bool> &visited,const std::vector<U> &distances) const
+    {
+        U runningMin = unreachable;
+        size_t index = this->numVertices();
+        for (size_t i=0;i<this->numVertices();++i){
+            if ((!visited[i])&&(distances[i]<runningMin)){
+                runningMin = distances[i];
+                index = i;
+            }
+        }
+        return index;
+    }
+
+public:
+    static constexpr U unreachable = std::numeric_limits<U>::max(); //distance of vertices with no route
+
+    //reusable state for dijkstraHeap - one per thread
+    struct Workspace
+    {
+        PathWorkspace<U> labels{unreachable};
+        Heap<IndexWeight> heap;
+    };
+
+    DijkstraGraph(): Base(){}
+    DijkstraGraph(const uint32_t N): Base(N){}
+    DijkstraGraph(const Graph<T,U> &graph): Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    DijkstraGraph(const uint32_t N, const EdgeList &edgeList): Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    //distance and routes to all nodes by default - will stop if endVertex reached
+    Routes<U> dijkstraSimple(size_t startVertex, size_t endVertex = -1) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        //record of visitation
+        std::vector<bool> visited(this->numVertices(),false); 
+        //distance values
+        std::vector<U> distances(this->numVertices(),unreachable);
+        distances[startVertex] = static_cast<U>(0);//zero distance to itself
+        //previous vertex for path iteration
+        std::vector<int32_t> previous(this->numVertices(),-1); 
+        previous[startVertex] = startVertex;
+
+        size_t count = 0;
+        while(count < this->numVertices()){ //visit every vertex           
+            size_t currentVertex = findMinIndex(visited,distances); //get vertex currently "closest" to start
+            if (currentVertex == this->numVertices()) //the rest cannot be reached
+                break;
+            for (const auto & neighbourData : this->neighbours(currentVertex)){ //loop of neighbours
+                const uint32_t &neighbourVertex = neighbourData.first; //neighbour vertex
+                const U &neighbourDistance = neighbourData.second; //distance from current to neighbour
+                if (!visited[neighbourVertex]){ //if neighbour not previously visited
+                    U newDist = distances[currentVertex] + neighbourDistance; //proposed new distance to neighbour from start
+                    if (newDist < distances[neighbourVertex]){ //if lower
+                            distances[neighbourVertex] = newDist; //update distance to neighbour from start
+                            previous[neighbourVertex] = currentVertex; //update previous vertex to neighbour in path
+                    }
+                }
+            }
+            visited[currentVertex] = true; //mark current vertex as visited
+            ++count;
+            if (currentVertex == endVertex)
+                break;
+        }
+        return {startVertex,std::move(distances),std::move(previous)};
+    }
+
+    //distance and routes to all nodes by default - will stop if endVertex reached
+    Routes<U> dijkstraHeap(size_t startVertex, size_t endVertex = -1) const
+    {
+        //test for OOB
+        if (startVertex >= this->numVertices())
+            return {};
+        //record of visitation
+        std::vector<bool> visited(this->numVertices(),false); 
+        visited[startVertex] = true;
+        //distance values
+        std::vector<U> distances(this->numVertices(),unreachable);
+        distances[startVertex] = static_cast<U>(0); //zero distance to itself
+        //previous vertex for path iteration
+        std::vector<int32_t> previous(this->numVertices(),-1); 
+        previous[startVertex] = startVertex;
+        //minheap as priority queue
+        Heap<IndexWeight> distancesHeap;
+        distancesHeap.insert({startVertex,0});
+
+        while(!distancesHeap.isEmpty()){            
+            IndexWeight currentVertex = distancesHeap.getRoot(); //get currently "closest" node from heap - by value as insertions below
+            for (const auto & neighbourData : this->neighbours(currentVertex.vertex)){//loop through neighbours
+                const uint32_t &neighbourVertex = neighbourData.first; //vertex of neighbour
+                const U &neighbourDistance = neighbourData.second; //distance to neighbour from current
+                if (!visited[neighbourVertex]){ //if unvisited
+                    U newDist = currentVertex.weight + neighbourDistance; //trial distance
+                    if (newDist < distances[neighbourVertex]){ //if closer
+                            distances[neighbourVertex] = newDist; //update distance to neighbour
+                            previous[neighbourVertex] = currentVertex.vertex; //update previous vertex in path
+                            distancesHeap.insert({neighbourVertex,newDist}); // add new (non infinity) distance into priority queue
+                    }
+                }
+            }
+            visited[currentVertex.vertex] = true; //mark current vertex as visited
+            if (currentVertex.vertex == endVertex)
+                break;
+            distancesHeap.removeRoot(); //remove visited vertex from heap
+        }
+        return {startVertex,std::move(distances),std::move(previous)};
+    }
+
+    //as above, but no per query allocation - distances/previous are read from workspace.labels afterwards
+    //returns the route to endVertex (if given)
+    Route<U> dijkstraHeap(size_t startVertex, size_t endVertex, Workspace &workspace) const
+    {
+        const size_t N = this->numVertices();
+        Route<U> route{startVertex,endVertex,unreachable,{},0};
+        //test for OOB
+        if (startVertex >= N)
+            return route;
+        PathWorkspace<U> &labels = workspace.labels;
+        Heap<IndexWeight> &heap = workspace.heap;
+        labels.reset(N);
+        heap.clear();
+        labels.label(startVertex,static_cast<U>(0),startVertex);
+        heap.insert({startVertex,0});
+
+        while (!heap.isEmpty()){
+            IndexWeight currentVertex = heap.getRoot();
+            heap.removeRoot();
+            if (!labels.visited.insert(currentVertex.vertex)) //stale heap entry
+                continue;
+            ++route.numExpanded;
+            if (currentVertex.vertex == endVertex)
+                break;
+            for (const auto & neighbourData : this->neighbours(currentVertex.vertex)){
+                const uint32_t &neighbourVertex = neighbourData.first;
+                U newDist = currentVertex.weight + neighbourData.second;
+                if (newDist < labels.distance(neighbourVertex)){
+                    labels.label(neighbourVertex,newDist,currentVertex.vertex);
+                    heap.insert({neighbourVertex,newDist});
+                }
+            }
+        }
+        if ((endVertex >= N) || (labels.distance(endVertex) == unreachable))
+            return route;
+        route.distance = labels.distance(endVertex);
+        for (int32_t u = endVertex; u != static_cast<int32_t>(startVertex); u = labels.previousVertex(u))
+            route.path.push_back(u);
+        route.path.push_back(startVertex);
+        std::reverse(route.path.begin(),route.path.end());
+        return route;
+    }
+
+    //symmetric: every edge u->v has a matching v->u, so the backward search can use outgoing edges
+    Route<U> dijkstraBidirectional(size_t startVertex, size_t endVertex, bool symmetric = false) const
+    {
+        const size_t N = this->numVertices();
+        Route<U> route{startVertex,endVertex,unreachable,{},0};
+        //test for OOB
+        if ((startVertex >= N)||(endVertex >= N))
+            return route;
+        std::vector<U> distancesF(N,unreachable), distancesB(N,unreachable);
+        std::vector<int32_t> previousF(N,-1), previousB(N,-1);
+        std::vector<bool> settledF(N,false), settledB(N,false);
+        distancesF[startVertex] = static_cast<U>(0);
+        distancesB[endVertex] = static_cast<U>(0);
+        Heap<IndexWeight> heapF, heapB;
+        heapF.insert({startVertex,0});
+        heapB.insert({endVertex,0});
+        U best = (startVertex == endVertex) ? static_cast<U>(0) : unreachable;
+        int32_t meet = (startVertex == endVertex) ? startVertex : -1;
+        std::shared_ptr<const CSRGraph<T,U> > incoming; //fetched once, on the first backward step
+
+        while ((!heapF.isEmpty())&&(!heapB.isEmpty())){
+            if (heapF.getRoot().weight + heapB.getRoot().weight >= best) //no shorter route possible
+                break;
+            if (heapF.getRoot().weight <= heapB.getRoot().weight)
+                route.numExpanded += expand(*this,heapF,distancesF,previousF,settledF,distancesB,best,meet);
+            else if (symmetric)
+                route.numExpanded += expand(*this,heapB,distancesB,previousB,settledB,distancesF,best,meet);
+            else{
+                if (!incoming)
+                    incoming = transpose.get(*this);
+                route.numExpanded += expand(*incoming,heapB,distancesB,previousB,settledB,distancesF,best,meet);
+            }
+        }
+        if (meet < 0)
+            return route;
+        route.distance = best;
+        for (int32_t u = meet; u != static_cast<int32_t>(startVertex); u = previousF[u]) //meet back to start
+            route.path.push_back(u);
+        route.path.push_back(startVertex);
+        std::reverse(route.path.begin(),route.path.end());
+        for (int32_t u = previousB[meet]; u >= 0; u = previousB[u]) //meet on to end
+            route.path.push_back(u);
+        return route;
+    }
+
+    //heuristic(v) - admissible estimate of the distance from v to endVertex
+    template<typename Heuristic>
+    Route<U> aStar(size_t startVertex, size_t endVertex, Heuristic &&heuristic) const
+    {
+        const size_t N = this->numVertices();
+        Route<U> route{startVertex,endVertex,unreachable,{},0};
+        //test for OOB
+        if ((startVertex >= N)||(endVertex >= N))
+            return route;
+        std::vector<U> distances(N,unreachable);
+        std::vector<int32_t> previous(N,-1);
+        distances[startVertex] = static_cast<U>(0);
+        Heap<AStarEntry> heap;
+        heap.insert({startVertex,0,static_cast<U>(heuristic(startVertex))});
+
+        while (!heap.isEmpty()){
+            AStarEntry current = heap.getRoot();
+            heap.removeRoot();
+            if (current.distance > distances[current.vertex]) //stale heap entry
+                continue;
+            ++route.numExpanded;
+            if (current.vertex == endVertex)
+                break;
+            for (const auto & neighbourData : this->neighbours(current.vertex)){
+                const uint32_t &neighbourVertex = neighbourData.first;
+                U newDist = current.distance + neighbourData.second;
+                if (newDist < distances[neighbourVertex]){
+                    distances[neighbourVertex] = newDist;
+                    previous[neighbourVertex] = current.vertex;
+                    heap.insert({neighbourVertex,newDist,static_cast<U>(newDist + heuristic(neighbourVertex))});
+                }
+            }
+        }
+        if (distances[endVertex] == unreachable)
+            return route;
+        route.distance = distances[endVertex];
+        for (int32_t u = endVertex; u != static_cast<int32_t>(startVertex); u = previous[u])
+            route.path.push_back(u);
+        route.path.push_back(startVertex);
+        std::reverse(route.path.begin(),route.path.end());
+        return route;
+    }
+};
+
+}
+
+#endif /*DIJKSTRA_H*/
@@ -0,0 +1,405 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+k shortest loopless paths - Yen's algorithm, generated lazily
+
+Routes::previous only gives one route per vertex. For alternatives we want the 1st, 2nd, 3rd...
+shortest simple (no repeated vertex) paths from s to t.
+
+Yen: with paths A[0..k-1] found, the next one must leave A[k-1] somewhere. For each "spur"
+vertex A[k-1][i]:
+
+    root = A[k-1][0..i]
+    block the edge out of the spur vertex taken by every found path sharing this root
+    block the root vertices before the spur vertex (keeps the path loopless)
+    spur path = shortest path spur vertex -> t in what remains
+    candidate = root + spur path
+
+Candidates go into a set B ordered by length (then by vertices, so equal length paths come out
+in a fixed order). The shortest candidate is the next path. Each next path costs up to |path|
+Dijkstra runs - O(k |V| (|E| + |V|) log |V|) for k paths.
+
+Lazy: PathGenerator::next() does only the work for one more path, so callers can stop as soon
+as they have enough, or after a length threshold.
+
+Parallel: the spur searches for one path are independent, so they are spread over threads,
+each with its own reused Dijkstra workspace (PathWorkspace + heap, see traversal_workspace.hpp):
+blocked vertices are another generation stamped VisitedSet, so after the first path nothing is
+allocated per search except the candidate paths themselves. Each search stops when t is settled.
+
+Edge weights must be non-negative.
+
+*/
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <set>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
+#include "heap.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+//struct for a single route between two vertices
+template<typename U>
+struct Route{
+    size_t origin;
+    size_t target;
+    U distance;                 //numeric_limits<U>::max() if unreachable
+    std::vector<uint32_t> path; //origin ... target, empty if unreachable
+    size_t numExpanded;         //vertices taken from the heap(s) to find this route
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //T value at nodes, U edge weights, Base adjacency storage (Graph or CSRGraph)
+class YenGraph : public Base
+{
+    //encapsulation of vertex index and distance with comparison overloads for heap version
+    struct IndexWeight
+    {
+        uint32_t vertex;
+        U weight;
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+    };
+
+    //per thread reusable search state
+    struct Workspace
+    {
+        PathWorkspace<U> labels;
+        Heap<IndexWeight> heap;
+        VisitedSet blocked;
+        size_t numExpanded = 0;
+    };
+
+    //path with the distance from the origin to each of its vertices
+    struct Candidate
+    {
+        U distance;
+        std::vector<uint32_t> path;
+        std::vector<U> cumulative;
+        bool operator< (const Candidate& A) const { return (this->distance < A.distance) || (!(A.distance < this->distance) && (this->path < A.path));};
+    };
+
+    //Dijkstra from spur to target avoiding workspace.blocked vertices and the edges spur -> blockedNext
+    //appends the path after spur (and distances) to candidate - false if target unreachable
+    bool spurSearch(Workspace &workspace, const uint32_t spur, const uint32_t target, const std::vector<uint32_t> &blockedNext, Candidate &candidate) const
+    {
+        PathWorkspace<U> &labels = workspace.labels;
+        Heap<IndexWeight> &heap = workspace.heap;
+        labels.reset(this->numVertices());
+        heap.clear();
+        labels.label(spur,static_cast<U>(0),spur);
+        heap.insert({spur,static_cast<U>(0)});
+        while (!heap.isEmpty()){
+            IndexWeight current = heap.getRoot();
+            heap.removeRoot();
+            if (!labels.visited.insert(current.vertex)) //stale heap entry
+                continue;
+            ++workspace.numExpanded;
+            if (current.vertex == target)
+                break;
+            for (const auto & neighbourData : this->neighbours(current.vertex)){
+                const uint32_t &neighbourVertex = neighbourData.first;
+                if (workspace.blocked.contains(neighbourVertex))
+                    continue;
+                if ((current.vertex == spur) && (std::find(blockedNext.begin(),blockedNext.end(),neighbourVertex) != blockedNext.end()))
+                    continue;
+                U newDist = current.weight + neighbourData.second;
+                if (newDist < labels.distance(neighbourVertex)){
+                    labels.label(neighbourVertex,newDist,current.vertex);
+                    heap.insert({neighbourVertex,newDist});
+                }
+            }
+        }
+        if (!labels.visited.contains(target))
+            return false;
+        const U base = candidate.cumulative.back();
+        size_t rootSize = candidate.path.size();
+        for (int32_t u = target; u != static_cast<int32_t>(spur); u = labels.previousVertex(u)){
+            candidate.path.push_back(u);
+            candidate.cumulative.push_back(base + labels.distance(u));
+        }
+        std::reverse(candidate.path.begin() + rootSize,candidate.path.end());
+        std::reverse(candidate.cumulative.begin() + rootSize,candidate.cumulative.end());
+        candidate.distance = candidate.cumulative.back();
+        return true;
+    }
+
+public:
+    YenGraph(): Base(){}
+    YenGraph(const uint32_t N): Base(N){}
+    YenGraph(const Graph<T,U> &graph): Base(graph){} //e.g. Base = CSRGraph<T,U>
+
+    //lazily produces the shortest, 2nd shortest, ... loopless routes origin -> target
+    class PathGenerator
+    {
+        const YenGraph &graph;
+        uint32_t origin, target;
+        uint32_t numThreads;
+        std::vector<Candidate> found;      //A - routes returned so far
+        std::set<Candidate> candidates;    //B - ordered by distance
+        std::vector<Workspace> workspaces; //one per thread
+        std::vector<std::vector<Candidate> > spurResults;
+        bool started = false;
+
+        //all spur searches off the last found route, in parallel
+        void expandLast()
+        {
+            const Candidate &last = found.back();
+            const size_t numSpurs = last.path.size() - 1;
+            spurResults.resize(numThreads);
+            parallelFor(numSpurs,numThreads,[&](uint32_t t,size_t begin,size_t end){
+                Workspace &workspace = workspaces[t];
+                for (size_t i = begin; i < end; ++i){
+                    const uint32_t spur = last.path[i];
+                    //edges out of the spur vertex taken by found routes with the same root
+                    std::vector<uint32_t> blockedNext;
+                    for (const auto &route : found)
+                        if ((route.path.size() > i + 1) && std::equal(last.path.begin(),last.path.begin() + i + 1,route.path.begin()))
+                            blockedNext.push_back(route.path[i + 1]);
+                    //root vertices before the spur
+                    workspace.blocked.reset(graph.numVertices());
+                    for (size_t j = 0; j < i; ++j)
+                        workspace.blocked.insert(last.path[j]);
+                    Candidate candidate{U(),{last.path.begin(),last.path.begin() + i + 1},{last.cumulative.begin(),last.cumulative.begin() + i + 1}};
+                    if (graph.spurSearch(workspace,spur,target,blockedNext,candidate))
+                        spurResults[t].push_back(std::move(candidate));
+                }
+            },1);
+            for (auto &results : spurResults){
+                for (auto &candidate : results)
+                    candidates.insert(std::move(candidate));
+                results.clear();
+            }
+        }
+
+        size_t takeExpanded()
+        {
+            size_t numExpanded = 0;
+            for (auto &workspace : workspaces){
+                numExpanded += workspace.numExpanded;
+                workspace.numExpanded = 0;
+            }
+            return numExpanded;
+        }
+
+    public:
+        PathGenerator(const YenGraph &graph_, const uint32_t origin_, const uint32_t target_, const uint32_t numThreads_):
+            graph(graph_),origin(origin_),target(target_),numThreads(std::max<uint32_t>(1,numThreads_)),workspaces(numThreads){}
+
+        //next shortest route - false once there are no more
+        bool next(Route<U> &route)
+        {
+            if ((origin >= graph.numVertices()) || (target >= graph.numVertices()))
+                return false;
+            if (!started){
+                started = true;
+                Candidate first{U(),{origin},{static_cast<U>(0)}};
+                workspaces[0].blocked.reset(graph.numVertices());
+                if ((origin == target) || graph.spurSearch(workspaces[0],origin,target,{},first))
+                    candidates.insert(std::move(first));
+            }
+            else if (!found.empty())
+                expandLast();
+            if (candidates.empty())
+                return false;
+            found.push_back(std::move(candidates.extract(candidates.begin()).value()));
+            const Candidate &best = found.back();
+            route = {origin,target,best.distance,best.path,takeExpanded()};
+            return true;
+        }
+
+        size_t numFound() const noexcept
+        {
+            return found.size();
+        }
+    };
+
+    PathGenerator shortestPaths(const uint32_t origin, const uint32_t target, const uint32_t numThreads = defaultThreads()) const
+    {
+        return PathGenerator(*this,origin,target,numThreads);
+    }
+
+    //up to k shortest loopless routes, shortest first
+    std::vector<Route<U> > kShortestPaths(const uint32_t origin, const uint32_t target, const size_t k, const uint32_t numThreads = defaultThreads()) const
+    {
+        std::vector<Route<U> > routes;
+        PathGenerator generator = shortestPaths(origin,target,numThreads);
+        Route<U> route;
+        while ((routes.size() < k) && generator.next(route))
+            routes.push_back(std::move(route));
+        return routes;
+    }
+};
+
+template<typename U>
+void printRoute(const Route<U> &route)
+{
+    std::cout<<route.origin<<" -> "<<route.target<<" : "<<route.distance<<", path : ";
+    for (auto u : route.path)
+        std::cout<<u<<" ";
+    std::cout<<"("<<route.numExpanded<<" vertices expanded)"<<std::endl;
+}
+
+//check a route - loopless, real edges, distance adds up
+template<typename G,typename U>
+bool validRoute(const G &graph, const Route<U> &route)
+{
+    std::vector<uint32_t> sorted = route.path;
+    std::sort(sorted.begin(),sorted.end());
+    if (std::adjacent_find(sorted.begin(),sorted.end()) != sorted.end())
+        return false;
+    U distance = U();
+    for (size_t i = 0; i + 1 < route.path.size(); ++i){
+        U best = std::numeric_limits<U>::max();
+        for (const auto & neighbourData : graph.neighbours(route.path[i]))
+            if (neighbourData.first == route.path[i + 1])
+                best = std::min(best,neighbourData.second);
+        if (best == std::numeric_limits<U>::max())
+            return false;
+        distance += best;
+    }
+    return (distance == route.distance) && (route.path.front() == route.origin) && (route.path.back() == route.target);
+}
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef int32_t T;
+    typedef int32_t U;
+    int32_t N = 9;    // number of vertices in graph 
+    YenGraph<T,U> graph(N); //uses ./sample_graph.jpeg
+    graph.addEdgeUndirected(0,1,4);
+    graph.addEdgeUndirected(0,7,8);
+    graph.addEdgeUndirected(1,7,11);
+    graph.addEdgeUndirected(1,2,8);
+    graph.addEdgeUndirected(7,6,1);
+    graph.addEdgeUndirected(7,8,7);
+    graph.addEdgeUndirected(8,2,2);
+    graph.addEdgeUndirected(6,8,6);
+    graph.addEdgeUndirected(6,5,2);
+    graph.addEdgeUndirected(2,3,7);
+    graph.addEdgeUndirected(2,5,4);
+    graph.addEdgeUndirected(5,3,14);
+    graph.addEdgeUndirected(3,4,9);
+    graph.addEdgeUndirected(5,4,10);
+
+    std::cout<<"5 shortest routes 0 -> 4"<<std::endl;
+    for (const auto &route : graph.kShortestPaths(0,4,5))
+        printRoute(route);
+
+    //lazily - stop once routes get 50% longer than the best
+    std::cout<<std::endl<<"routes 0 -> 4 within 50% of the shortest"<<std::endl;
+    auto generator = graph.shortestPaths(0,4);
+    Route<U> route;
+    U shortest = -1;
+    while (generator.next(route)){
+        if (shortest < 0)
+            shortest = route.distance;
+        if (route.distance > 1.5*shortest)
+            break;
+        printRoute(route);
+    }
+
+    //every simple path of a small random graph by brute force - k shortest distances must match
+    RndUniform rnd;
+    bool bruteAgrees = true;
+    for (uint32_t trial = 0; trial < 20; ++trial){
+        const uint32_t smallN = 8;
+        YenGraph<T,U> small(smallN);
+        std::vector<bool> present(smallN*smallN,false); //no parallel edges - routes are vertex sequences
+        for (uint32_t e = 0; e < 20; ++e){
+            uint32_t u = smallN*rnd(), v = smallN*rnd();
+            if (!present[u*smallN + v] && small.addEdge(u,v,static_cast<U>(1 + 9*rnd())))
+                present[u*smallN + v] = true;
+        }
+        std::vector<U> all;
+        std::vector<uint32_t> path{0};
+        std::vector<bool> onPath(smallN,false);
+        onPath[0] = true;
+        std::function<void(uint32_t,U)> enumerate = [&](uint32_t u, U distance){
+            if (u == smallN - 1){
+                all.push_back(distance);
+                return;
+            }
+            for (const auto & neighbourData : small.neighbours(u)){
+                if (onPath[neighbourData.first])
+                    continue;
+                onPath[neighbourData.first] = true;
+                enumerate(neighbourData.first,distance + neighbourData.second);
+                onPath[neighbourData.first] = false;
+            }
+        };
+        enumerate(0,0);
+        std::sort(all.begin(),all.end());
+        std::vector<Route<U> > routes = small.kShortestPaths(0,smallN - 1,all.size() + 5);
+        bool agrees = (routes.size() == all.size());
+        for (size_t i = 0; agrees && (i < routes.size()); ++i)
+            agrees = (routes[i].distance == all[i]) && validRoute(small,routes[i]);
+        bruteAgrees = bruteAgrees && agrees;
+    }
+    std::cout<<std::endl<<"matches brute force enumeration of all simple paths: "<<bruteAgrees<<std::endl;
+
+    //grid graph with random weights - alternatives between opposite corners of the middle
+    const int32_t side = 300;
+    const size_t k = 20;
+    YenGraph<T,U,CSRGraph<T,U> > grid;
+    {
+        Graph<T,U> build(side*side);
+        for (int32_t r = 0; r < side; ++r){
+            for (int32_t c = 0; c < side; ++c){
+                if (c + 1 < side)
+                    build.addEdgeUndirected(r*side + c,r*side + c + 1,static_cast<U>(1 + 9*rnd()));
+                if (r + 1 < side)
+                    build.addEdgeUndirected(r*side + c,(r + 1)*side + c,static_cast<U>(1 + 9*rnd()));
+            }
+        }
+        grid = YenGraph<T,U,CSRGraph<T,U> >(build);
+    }
+    uint32_t from = (side/2 - 20)*side + side/2 - 20;
+    uint32_t to = (side/2 + 20)*side + side/2 + 20;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Route<U> > serial = grid.kShortestPaths(from,to,k,1);
+    auto mid = std::chrono::steady_clock::now();
+    std::vector<Route<U> > parallel = grid.kShortestPaths(from,to,k);
+    auto end = std::chrono::steady_clock::now();
+    bool valid = (parallel.size() == k);
+    for (size_t i = 0; i < parallel.size(); ++i)
+        valid = valid && validRoute(grid,parallel[i]) && ((i == 0) || (parallel[i - 1].distance <= parallel[i].distance))
+                      && (parallel[i].path == serial[i].path);
+    std::cout<<std::endl<<side<<"x"<<side<<" grid, "<<k<<" shortest routes "<<from<<" -> "<<to<<": "
+             <<parallel.front().distance<<" ... "<<parallel.back().distance<<std::endl;
+    std::cout<<"1 thread  : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<defaultThreads()<<" threads : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"valid and agree: "<<valid<<std::endl;
+
+    return 0;
+}
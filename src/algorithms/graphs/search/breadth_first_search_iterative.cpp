@@ -19,67 +19,21 @@
 
 /*
 
-Depth First Search for a graph - Recursive
-
-Input: Graph, key
-Output: boolean found/not found
-
-Time: O(log(V))
-Space: O(log(V))
-
-We visit a node and add its neighbours to a stack of nodes to search
-To eliminate loops we record a visitation history to each node - only search neighbours 
-if previously unvisited
-
-Notes: general concerns about recursion - space complexity due to number of stack frames
+Iterative breadth first search over a small random graph, on Graph and CSRGraph
 
 */
 
 #include <iostream>
-#include <memory>
 #include <vector>
-#include <queue>
 #include "graph.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
 #include "random.hpp"
+#include "breadth_first_search_iterative.hpp"
 
 using namespace structures_and_algorithms::structures::graphs;
 using namespace structures_and_algorithms::random;
-
-template<typename T,typename U>
-class GraphBFSI : public Graph<T,U>{
-    bool search(
-        std::vector<bool> &visited, /*vector recording visitation*/ 
-        uint32_t start,/*search from node*/
-        uint32_t v /*node index being searched for*/)
-    {
-        std::queue<uint32_t> to_visit;
-        to_visit.push(start);
-
-        while (!to_visit.empty()){
-            uint32_t current = to_visit.front();
-            to_visit.pop();
-            visited[current]=true; //record we've visited u        
-            if (current==v) return true; //found the node
-            for (auto it=this->edges[current].begin();it!=this->edges[current].end();++it)// loop over adjacency list of u
-                if (!visited[it->first])
-                    to_visit.push(it->first); // added to the BACK of the queue
-        }
-        return false; 
-    }
-public:
-    GraphBFSI(const uint32_t N):Graph<T,U>(N){}
-
-    //entry point function - sart from all possible nodes
-    bool search(int32_t v /*search node index*/)
-    {
-        uint32_t N = this->numVertices();
-        std::vector<bool> visited(N,false); // set up visitation record
-        for (size_t i = 0; i < N; ++i)
-            if ((!visited[i])&&(search(visited,i,v))) //perform the search from i (if not visited) - return if found
-                return true;
-        return false;
-    }
-};
+using namespace structures_and_algorithms::algorithms::graphs;
 
 int main(/*int argc, char* argv[]*/)
 {
@@ -122,5 +76,16 @@ int main(/*int argc, char* argv[]*/)
     else
         std::cout<<"not found"<<std::endl;
         
+    //same search over the packed CSR representation
+    GraphBFSI<T,U,CSRGraph<T,U> > csrGraph(graph);
+    std::cout<<"csr graph agrees: "<<((csrGraph.search(keyA) == foundA) && (csrGraph.search(keyB) == foundB))<<std::endl;
+
+
+    //back to back searches sharing one workspace
+    SearchWorkspace workspace;
+    bool reusedAgrees = true;
+    for (int32_t key = 0; key < N + 10; ++key)
+        reusedAgrees = reusedAgrees && (graph.search(key,workspace) == graph.search(key));
+    std::cout<<"reused workspace agrees: "<<reusedAgrees<<std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Parallel direction optimizing BFS - checked against the sequential BFS and timed
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <tuple>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "compressed_graph.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+#include "breadth_first_search_parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::algorithms::graphs;
+
+int main(/*int argc, char* argv[]*/)
+{
+    typedef int32_t T;
+    typedef uint8_t U;
+
+    int32_t N = 10;
+    RndUniform rnd;
+    std::vector<std::pair<int32_t,int32_t> > data(20);
+
+    for (auto & x: data){
+        x.first=N*rnd();
+        x.second = x.first;
+        while (x.second == x.first)
+            x.second=N*rnd();
+    }
+
+    GraphBFSP<T,U> graph(N);
+
+    for (const auto & x: data)
+        graph.addEdge(x.first,x.second);
+
+    graph.print();
+    std::cout<<std::endl;
+
+    BFSResult result = graph.bfs(0);
+    std::cout<<"vertex parent distance from 0"<<std::endl;
+    for (int32_t i = 0; i < N; ++i)
+        std::cout<<i<<" "<<result.parent[i]<<" "<<result.distance[i]<<std::endl;
+
+    //larger random undirected graph in CSR form
+    const uint32_t bigN = 1 << 19;
+    const uint32_t avgDegree = 16;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList;
+    edgeList.reserve(static_cast<size_t>(bigN) * avgDegree);
+    for (size_t e = 0; e < static_cast<size_t>(bigN) * avgDegree / 2; ++e){
+        uint32_t u = bigN*rnd();
+        uint32_t v = bigN*rnd();
+        edgeList.emplace_back(u,v,1);
+        edgeList.emplace_back(v,u,1);
+    }
+    GraphBFSP<T,U,CSRGraph<T,U> > bigGraph(bigN,edgeList);
+    GraphBFSP<T,U,CompressedGraph<T,U> > compressedGraph(bigN,edgeList);
+    edgeList = {};
+
+    auto start = std::chrono::steady_clock::now();
+    BFSResult sequential = bigGraph.bfsSequential(0);
+    auto mid = std::chrono::steady_clock::now();
+    BFSResult parallel = bigGraph.bfs(0,true);
+    auto end = std::chrono::steady_clock::now();
+    BFSResult parallelTransposed = bigGraph.bfs(0,false);
+    auto compressedStart = std::chrono::steady_clock::now();
+    BFSResult compressed = compressedGraph.bfs(0,true);
+    auto compressedEnd = std::chrono::steady_clock::now();
+
+    std::cout<<std::endl<<bigN<<" vertices, "<<bigGraph.numEdges()<<" edges, "<<std::thread::hardware_concurrency()<<" threads"<<std::endl;
+    std::cout<<"sequential BFS          : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"direction optimizing BFS: "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"compressed graph BFS    : "<<std::chrono::duration<double,std::milli>(compressedEnd-compressedStart).count()<<" ms"<<std::endl;
+    std::cout<<"distances agree: "<<((sequential.distance == parallel.distance) && (sequential.distance == parallelTransposed.distance)
+                                     && (sequential.distance == compressed.distance))<<std::endl;
+
+    //directed Graph: the transpose used by bottom-up steps must follow edges added after the first bfs
+    const uint32_t midN = 4000;
+    GraphBFSP<T,U> directed(midN);
+    for (uint32_t e = 0; e < 8 * midN; ++e)
+        directed.addEdge(static_cast<uint32_t>(midN*rnd()),static_cast<uint32_t>(midN*rnd()));
+    bool beforeAgrees = (directed.bfs(0).distance == directed.bfsSequential(0).distance);
+    for (uint32_t e = 0; e < 8 * midN; ++e)
+        directed.addEdge(static_cast<uint32_t>(midN*rnd()),static_cast<uint32_t>(midN*rnd()));
+    bool afterAgrees = (directed.bfs(0).distance == directed.bfsSequential(0).distance);
+    std::cout<<"directed graph, before and after adding edges, agrees: "<<(beforeAgrees && afterAgrees)<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Breadth First Search for a graph - Parallel, direction optimizing
+
+Input: Graph, source
+Output: parent and distance (level) of every vertex reachable from source, -1 otherwise
+
+Time: O(V+E) work, O(diameter) parallel steps
+
+Level synchronous - all vertices at distance d (the frontier) are expanded together to find
+the vertices at distance d+1, split across threads. Two ways of doing a step:
+
+    top-down  : for each u in the frontier, for each neighbour v, claim v if unvisited
+                - cost ~ edges out of the frontier
+                - threads race to claim v, so visited is a bitmap of atomic words and a
+                  vertex is claimed by whoever sets its bit first (fetch_or)
+    bottom-up : for each unvisited v, look through its (in-)neighbours for one in the frontier
+                and stop at the first found
+                - cost ~ edges into unvisited vertices, but usually stops early
+                - the frontier is kept as a bitmap so "is u in the frontier" is one bit test
+                - each thread owns whole 64-vertex words of the bitmaps, so no atomics needed
+
+On low diameter graphs (e.g. social networks) a few middle levels contain most of the graph and
+bottom-up is much cheaper there, while top-down is cheaper at the start and end. Following
+Beamer et al. we switch with
+
+    top-down -> bottom-up when  mf > mu / alpha   (mf edges out of frontier, mu edges out of unvisited)
+    bottom-up -> top-down when  nf < n / beta     (nf vertices in frontier) and the frontier is shrinking
+
+with alpha = 14, beta = 24.
+
+Bottom-up needs incoming edges - for an undirected graph (symmetric = true) these are the
+outgoing edges, otherwise a transposed CSRGraph is built on first use and kept (TransposeCache,
+rebuilt if the graph has changed since).
+
+*/
+
+#ifndef BREADTH_FIRST_SEARCH_PARALLEL_H
+#define BREADTH_FIRST_SEARCH_PARALLEL_H
+
+#include <memory>
+#include <vector>
+#include <queue>
+#include <atomic>
+#include <algorithm>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "transpose_cache.hpp"
+#include "compressed_graph.hpp"
+#include "parallel.hpp"
+#include "bits.hpp"
+
+namespace structures_and_algorithms::algorithms::graphs{
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::parallel;
+using namespace structures_and_algorithms::bits;
+
+//BFS tree from source
+struct BFSResult{
+    uint32_t source;
+    std::vector<int32_t> parent;   //parent[source] = source, -1 if unreached
+    std::vector<int32_t> distance; //number of edges from source, -1 if unreached
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph, CSRGraph or CompressedGraph
+class GraphBFSP : public Base{
+    static constexpr size_t alpha = 14;
+    static constexpr size_t beta = 24;
+
+    TransposeCache<T,U> transpose; //incoming edges - built on first use, rebuilt if the graph changes
+
+    static bool testBit(const std::vector<uint64_t> &bitmap, uint32_t v)
+    {
+        return (bitmap[v >> 6] >> (v & 63)) & 1;
+    }
+
+    //returns edges out of the new frontier
+    size_t topDownStep(const std::vector<uint32_t> &frontier, std::vector<uint32_t> &next,
+                       std::vector<std::atomic<uint64_t> > &visited, BFSResult &result,
+                       int32_t level, uint32_t numThreads) const
+    {
+        std::vector<std::vector<uint32_t> > localNext(numThreads);
+        std::vector<size_t> localEdges(numThreads,0);
+        parallelFor(frontier.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+            for (size_t i = begin; i < end; ++i){
+                uint32_t u = frontier[i];
+                for (const auto & neighbourData : this->neighbours(u)){
+                    uint32_t v = neighbourData.first;
+                    uint64_t bit = static_cast<uint64_t>(1) << (v & 63);
+                    if (visited[v >> 6].load(std::memory_order_relaxed) & bit)
+                        continue; //cheap test before the atomic read-modify-write
+                    if (!(visited[v >> 6].fetch_or(bit,std::memory_order_relaxed) & bit)){ //we claimed v
+                        result.parent[v] = u;
+                        result.distance[v] = level + 1;
+                        localNext[t].push_back(v);
+                        localEdges[t] += this->neighbours(v).size();
+                    }
+                }
+            }
+        });
+        next.clear();
+        size_t edgesOut = 0;
+        for (uint32_t t = 0; t < numThreads; ++t){
+            next.insert(next.end(),localNext[t].begin(),localNext[t].end());
+            edgesOut += localEdges[t];
+        }
+        return edgesOut;
+    }
+
+    //returns number of vertices in the new frontier, edges out of it in edgesOut
+    template<typename Incoming>
+    size_t bottomUpStep(const Incoming &in, const std::vector<uint64_t> &frontier, std::vector<uint64_t> &next,
+                        std::vector<std::atomic<uint64_t> > &visited, BFSResult &result,
+                        int32_t level, uint32_t numThreads, size_t &edgesOut) const
+    {
+        const uint32_t N = this->numVertices();
+        std::vector<size_t> localCount(numThreads,0), localEdges(numThreads,0);
+        parallelFor(next.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){ //whole words per thread
+            for (size_t word = begin; word < end; ++word){
+                uint64_t visitedWord = visited[word].load(std::memory_order_relaxed);
+                uint64_t nextWord = 0;
+                for (uint32_t b = 0; b < 64; ++b){
+                    uint32_t v = (word << 6) + b;
+                    if ((v >= N) || ((visitedWord >> b) & 1))
+                        continue;
+                    for (const auto & neighbourData : in.neighbours(v)){
+                        if (testBit(frontier,neighbourData.first)){ //first parent found in frontier
+                            result.parent[v] = neighbourData.first;
+                            result.distance[v] = level + 1;
+                            nextWord |= static_cast<uint64_t>(1) << b;
+                            ++localCount[t];
+                            localEdges[t] += this->neighbours(v).size();
+                            break;
+                        }
+                    }
+                }
+                next[word] = nextWord;
+                visited[word].store(visitedWord | nextWord,std::memory_order_relaxed);
+            }
+        });
+        size_t count = 0;
+        edgesOut = 0;
+        for (uint32_t t = 0; t < numThreads; ++t){
+            count += localCount[t];
+            edgesOut += localEdges[t];
+        }
+        return count;
+    }
+
+public:
+    GraphBFSP(const uint32_t N):Base(N){}
+    GraphBFSP(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    GraphBFSP(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U> or CompressedGraph<T,U>
+
+    //symmetric: every edge u->v has a matching v->u, so outgoing edges can be used for bottom-up
+    BFSResult bfs(uint32_t source, bool symmetric = false, uint32_t numThreads = defaultThreads()) const
+    {
+        const uint32_t N = this->numVertices();
+        BFSResult result{source,std::vector<int32_t>(N,-1),std::vector<int32_t>(N,-1)};
+        if (source >= N)
+            return result;
+        numThreads = std::max<uint32_t>(1,numThreads);
+        const size_t numWords = (N + 63) / 64;
+
+        std::vector<std::atomic<uint64_t> > visited(numWords);
+        for (auto &word : visited)
+            word.store(0,std::memory_order_relaxed);
+        visited[source >> 6].store(static_cast<uint64_t>(1) << (source & 63),std::memory_order_relaxed);
+        result.parent[source] = source;
+        result.distance[source] = 0;
+
+        std::vector<uint32_t> queue{source}, nextQueue; //frontier for top-down
+        std::vector<uint64_t> bitmap, nextBitmap; //frontier for bottom-up
+        size_t mf = this->neighbours(source).size(); //edges out of frontier
+        size_t mu = this->numEdges() - mf; //edges out of unvisited vertices
+        size_t nf = 1; //vertices in frontier
+        bool bottomUp = false;
+        int32_t level = 0;
+        std::shared_ptr<const CSRGraph<T,U> > incoming; //fetched on the first bottom-up step if not symmetric
+
+        while (nf){
+            if (!bottomUp && (mf > mu / alpha)){ //frontier large - queue -> bitmap
+                bottomUp = true;
+                bitmap.assign(numWords,0);
+                for (uint32_t u : queue)
+                    bitmap[u >> 6] |= static_cast<uint64_t>(1) << (u & 63);
+                nextBitmap.assign(numWords,0);
+            }
+            if (bottomUp){
+                size_t edgesOut = 0;
+                size_t previousNf = nf;
+                if (symmetric)
+                    nf = bottomUpStep(*this,bitmap,nextBitmap,visited,result,level,numThreads,edgesOut);
+                else{
+                    if (!incoming)
+                        incoming = transpose.get(*this);
+                    nf = bottomUpStep(*incoming,bitmap,nextBitmap,visited,result,level,numThreads,edgesOut);
+                }
+                bitmap.swap(nextBitmap);
+                mf = edgesOut;
+                mu -= std::min(mu,edgesOut);
+                if ((nf < previousNf) && (nf < N / beta)){ //frontier small again - bitmap -> queue
+                    bottomUp = false;
+                    queue.clear();
+                    for (size_t word = 0; word < numWords; ++word)
+                        for (uint64_t bits = bitmap[word]; bits; bits &= bits - 1)
+                            queue.push_back((word << 6) + countTrailingZeros(bits));
+                }
+            }
+            else{
+                mf = topDownStep(queue,nextQueue,visited,result,level,numThreads);
+                mu -= std::min(mu,mf);
+                queue.swap(nextQueue);
+                nf = queue.size();
+            }
+            ++level;
+        }
+        return result;
+    }
+
+    //reference single threaded queue BFS
+    BFSResult bfsSequential(uint32_t source) const
+    {
+        const uint32_t N = this->numVertices();
+        BFSResult result{source,std::vector<int32_t>(N,-1),std::vector<int32_t>(N,-1)};
+        if (source >= N)
+            return result;
+        std::queue<uint32_t> to_visit;
+        to_visit.push(source);
+        result.parent[source] = source;
+        result.distance[source] = 0;
+        while (!to_visit.empty()){
+            uint32_t current = to_visit.front();
+            to_visit.pop();
+            for (const auto & neighbourData : this->neighbours(current)){
+                if (result.distance[neighbourData.first] < 0){
+                    result.parent[neighbourData.first] = current;
+                    result.distance[neighbourData.first] = result.distance[current] + 1;
+                    to_visit.push(neighbourData.first);
+                }
+            }
+        }
+        return result;
+    }
+};
+
+}
+
+#endif /*BREADTH_FIRST_SEARCH_PARALLEL_H*/
@@ -0,0 +1,99 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Depth First Search for a graph - Iterative
+
+Input: Graph, key
+Output: boolean found/not found
+
+Time: O(log(V))
+Space: O(log(V))
+
+We visit a node and add its neighbours to a stack of nodes to search
+To eliminate loops we record a visitation history to each node - only search neighbours 
+if previously unvisited
+
+Notes: general concerns about recursion - space complexity due to number of stack frames
+
+*/
+
+#ifndef DEPTH_FIRST_SEARCH_ITERATIVE_H
+#define DEPTH_FIRST_SEARCH_ITERATIVE_H
+
+#include <vector>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
+
+namespace structures_and_algorithms::algorithms::graphs{
+
+using namespace structures_and_algorithms::structures::graphs;
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph or CSRGraph
+class GraphDFSI : public Base{
+
+    bool search(
+        SearchWorkspace &workspace, /*visitation record and stack of nodes to search*/ 
+        uint32_t start,/*search from node*/
+        uint32_t v /*node index being searched for*/)
+    {
+        std::vector<uint32_t> &to_visit = workspace.frontier;
+        to_visit.push_back(start);
+        while (!to_visit.empty()){
+            uint32_t current = to_visit.back();
+            to_visit.pop_back();
+            workspace.visited.insert(current); //record we've visited u        
+            if (current==v) return true; //found the node
+            for (const auto & neighbourData : this->neighbours(current))// loop over adjacency list of u
+                if (!workspace.visited.contains(neighbourData.first))
+                    to_visit.push_back(neighbourData.first);
+        }
+        return false; 
+    }
+
+public:
+
+    GraphDFSI(const uint32_t N):Base(N){}
+    GraphDFSI(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    GraphDFSI(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    bool search(uint32_t v /*search node index*/)
+    {
+        SearchWorkspace workspace;
+        return search(v,workspace);
+    }
+
+    //as above, reusing workspace between calls - no allocation after the first
+    bool search(uint32_t v /*search node index*/, SearchWorkspace &workspace)
+    {
+        uint32_t N = this->numVertices();
+        workspace.reset(N); // clear visitation record - O(1)
+        for (size_t i = 0; i < N; ++i)
+            if ((!workspace.visited.contains(i))&&(search(workspace,i,v))) //perform the search from i (if not visited) - return if found
+                return true;
+        return false;
+    }
+};
+
+}
+
+#endif /*DEPTH_FIRST_SEARCH_ITERATIVE_H*/
@@ -19,62 +19,21 @@
 
 /*
 
-Depth First Search for a graph - Recursive
-
-Input: Graph, key
-Output: boolean found/not found
-
-Time: O(log(V))
-Space: O(log(V))
-
-We visit a node and perform calls to its neighbours
-To eliminate loops we record a visitation history to each node - only search neighbours 
-if previously unvisited
-
-Notes: general concerns about recursion - space complexity due to number of stack frames
+Recursive depth first search over a small random graph, on Graph and CSRGraph
 
 */
 
 #include <iostream>
-#include <memory>
 #include <vector>
 #include "graph.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
 #include "random.hpp"
+#include "depth_first_search_recursive.hpp"
 
 using namespace structures_and_algorithms::structures::graphs;
 using namespace structures_and_algorithms::random;
-
-template<typename T,typename U>
-class GraphDFSR : public Graph<T,U>{
-
-    bool search(
-        std::vector<bool> &visited, /*vector recording visitation*/ 
-        uint32_t u,/*search from node*/
-        uint32_t v /*node index being searched for*/)
-    {
-        if (u==v) return true; //found the node
-        visited[u]=true; //record we've visited u
-        for (auto i=this->edges[u].begin();i!=this->edges[u].end();++i)// loop over adjacency list of u
-            if ((!visited[i->first])&&(search(visited,i->first,v))) // if we haven't visited neighbour search the neighbour (recusive) - if found r
-                return true;
-        return false; 
-    }
-
-public:
-
-    GraphDFSR(const uint32_t N):Graph<T,U>(N){}
-
-    //entry point function - sart from all possible nodes
-    bool search(uint32_t v /*search node index*/)
-    {
-        uint32_t N = this->numVertices();
-        std::vector<bool> visited(N,false); // set up visitation record
-        for (size_t i = 0; i < N; ++i)
-            if ((!visited[i])&&(search(visited,i,v))) //perform the search from i (if not visited) - return if found
-                return true;
-        return false;
-    }
-};
+using namespace structures_and_algorithms::algorithms::graphs;
 
 int main(/*int argc, char* argv[]*/)
 {
@@ -117,5 +76,16 @@ int main(/*int argc, char* argv[]*/)
     else
         std::cout<<"not found"<<std::endl;
         
+    //same search over the packed CSR representation
+    GraphDFSR<T,U,CSRGraph<T,U> > csrGraph(graph);
+    std::cout<<"csr graph agrees: "<<((csrGraph.search(keyA) == foundA) && (csrGraph.search(keyB) == foundB))<<std::endl;
+
+
+    //back to back searches sharing one workspace
+    SearchWorkspace workspace;
+    bool reusedAgrees = true;
+    for (int32_t key = 0; key < N + 10; ++key)
+        reusedAgrees = reusedAgrees && (graph.search(key,workspace) == graph.search(key));
+    std::cout<<"reused workspace agrees: "<<reusedAgrees<<std::endl;
     return 0;
 }
\ No newline at end of file
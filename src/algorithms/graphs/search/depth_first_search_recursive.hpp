@@ -0,0 +1,94 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Depth First Search for a graph - Recursive
+
+Input: Graph, key
+Output: boolean found/not found
+
+Time: O(log(V))
+Space: O(log(V))
+
+We visit a node and perform calls to its neighbours
+To eliminate loops we record a visitation history to each node - only search neighbours 
+if previously unvisited
+
+Notes: general concerns about recursion - space complexity due to number of stack frames
+
+*/
+
+#ifndef DEPTH_FIRST_SEARCH_RECURSIVE_H
+#define DEPTH_FIRST_SEARCH_RECURSIVE_H
+
+#include <vector>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "traversal_workspace.hpp"
+
+namespace structures_and_algorithms::algorithms::graphs{
+
+using namespace structures_and_algorithms::structures::graphs;
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph or CSRGraph
+class GraphDFSR : public Base{
+
+    bool search(
+        SearchWorkspace &workspace, /*visitation record*/ 
+        uint32_t u,/*search from node*/
+        uint32_t v /*node index being searched for*/)
+    {
+        if (u==v) return true; //found the node
+        workspace.visited.insert(u); //record we've visited u
+        for (const auto & neighbourData : this->neighbours(u))// loop over adjacency list of u
+            if ((!workspace.visited.contains(neighbourData.first))&&(search(workspace,neighbourData.first,v))) // if we haven't visited neighbour search the neighbour (recusive) - if found r
+                return true;
+        return false; 
+    }
+
+public:
+
+    GraphDFSR(const uint32_t N):Base(N){}
+    GraphDFSR(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    GraphDFSR(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    //entry point function - sart from all possible nodes
+    bool search(uint32_t v /*search node index*/)
+    {
+        SearchWorkspace workspace;
+        return search(v,workspace);
+    }
+
+    //as above, reusing workspace between calls - no allocation after the first
+    bool search(uint32_t v /*search node index*/, SearchWorkspace &workspace)
+    {
+        uint32_t N = this->numVertices();
+        workspace.reset(N); // clear visitation record - O(1)
+        for (size_t i = 0; i < N; ++i)
+            if ((!workspace.visited.contains(i))&&(search(workspace,i,v))) //perform the search from i (if not visited) - return if found
+                return true;
+        return false;
+    }
+};
+
+}
+
+#endif /*DEPTH_FIRST_SEARCH_RECURSIVE_H*/
@@ -0,0 +1,308 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Minimum spanning tree (forest) of a weighted undirected graph - Kruskal, Prim and Borůvka
+
+The graph stores each undirected edge in both directions (addEdgeUndirected). A minimum
+spanning forest has one tree per connected component and the least possible total weight.
+All three rely on the cut property: the lightest edge leaving any set of vertices is in some
+minimum spanning tree.
+
+kruskal - take the edges (u < v copy of each) sorted by weight, keep an edge if its ends are
+in different trees so far (union-find). The sort dominates, so it is done with parallelSort.
+O(E log E)
+
+prim - grow one tree at a time from a start vertex, always adding the lightest edge leaving
+it. The heap holds one entry per vertex not yet in the tree keyed by its lightest edge to the
+tree, and is decreased when a lighter edge turns up - IndexedHeap's reset, as used by
+Dijkstra. O(E log V)
+
+boruvka - every component picks its lightest outgoing edge at once, all of them are added,
+components merge, repeat. Each round at least halves the number of components, so
+O(log V) rounds of O(E) work, and every round is data parallel:
+
+1. for every remaining edge between two components, in parallel, atomically lower the
+   "lightest edge" slot of both components (ties broken by edge index, so every component
+   has a unique choice and no cycle can form)
+2. for every component, in parallel, unite the two ends of its chosen edge with the lock free
+   union-find - an edge chosen by both its components is only added once
+3. drop edges now inside one component
+
+Ties: trees may differ between methods when weights repeat, but their total weight cannot.
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "indexedheap.hpp"
+#include "union_find.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::structures::disjoint_sets;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+//struct for the result - edges (u,v,w) of the forest and their total weight
+template<typename U>
+struct SpanningForest{
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+    U weight;
+};
+
+template<typename T,typename U,typename Base = Graph<T,U> > //Base: Graph or CSRGraph
+class MSTGraph : public Base{
+    static constexpr uint32_t UNSET = std::numeric_limits<uint32_t>::max();
+
+    //encapsulation of vertex index and weight of its lightest edge to the tree
+    struct IndexWeight
+    {
+        uint32_t vertex;
+        U weight;
+        bool operator< (const IndexWeight& A) const { return this->weight < A.weight;};
+        bool operator> (const IndexWeight& A) const { return this->weight > A.weight;};
+        bool operator==(const IndexWeight &val)const noexcept{return this->vertex == val.vertex;}
+        //need == operator for hashtable
+    };
+    struct IndexWeightHasher{size_t operator()(const IndexWeight& val) const {return std::hash<uint32_t>{}(val.vertex);}};
+
+    struct Edge{
+        uint32_t u, v;
+        U weight;
+    };
+
+    //one copy (u < v) of each undirected edge
+    std::vector<Edge> edgeList() const
+    {
+        std::vector<Edge> edges;
+        for (uint32_t u = 0; u < this->numVertices(); ++u)
+            for (const auto & neighbourData : this->neighbours(u))
+                if (u < neighbourData.first)
+                    edges.push_back({u,neighbourData.first,neighbourData.second});
+        return edges;
+    }
+
+    static U total(const std::vector<std::tuple<uint32_t,uint32_t,U> > &edges)
+    {
+        U weight = U();
+        for (const auto &edge : edges)
+            weight += std::get<2>(edge);
+        return weight;
+    }
+
+public:
+    MSTGraph(const uint32_t N):Base(N){}
+    MSTGraph(const Graph<T,U> &graph):Base(graph){} //e.g. Base = CSRGraph<T,U>
+    template<typename EdgeList>
+    MSTGraph(const uint32_t N, const EdgeList &edgeList):Base(N,edgeList){} //Base = CSRGraph<T,U>
+
+    SpanningForest<U> kruskal(const uint32_t numThreads = defaultThreads()) const
+    {
+        std::vector<Edge> edges = edgeList();
+        parallelSort(edges.begin(),edges.end(),numThreads,[](const Edge &a, const Edge &b){return a.weight < b.weight;});
+        UnionFind sets(this->numVertices());
+        SpanningForest<U> forest;
+        for (const auto &edge : edges){
+            if (sets.unite(edge.u,edge.v)){
+                forest.edges.emplace_back(edge.u,edge.v,edge.weight);
+                if (forest.edges.size() + 1 == this->numVertices())
+                    break; //spanning tree complete
+            }
+        }
+        forest.weight = total(forest.edges);
+        return forest;
+    }
+
+    SpanningForest<U> prim() const
+    {
+        uint32_t N = this->numVertices();
+        std::vector<char> inTree(N,0);
+        std::vector<uint32_t> parent(N,UNSET);
+        std::vector<U> key(N);
+        IndexedHeap<IndexWeight,decltype(lessThan<IndexWeight>),IndexWeightHasher> heap;
+        SpanningForest<U> forest;
+        for (uint32_t s = 0; s < N; ++s){
+            if (inTree[s])
+                continue;
+            heap.insert(IndexWeight{s,U()});
+            parent[s] = s;
+            while (!heap.isEmpty()){
+                IndexWeight current = heap.getRoot();
+                heap.removeRoot();
+                uint32_t u = current.vertex;
+                inTree[u] = 1;
+                if (parent[u] != u)
+                    forest.edges.emplace_back(parent[u],u,current.weight);
+                for (const auto & neighbourData : this->neighbours(u)){
+                    uint32_t v = neighbourData.first;
+                    if (inTree[v])
+                        continue;
+                    if (parent[v] == UNSET){ //first edge to the tree
+                        parent[v] = u;
+                        key[v] = neighbourData.second;
+                        heap.insert(IndexWeight{v,key[v]});
+                    }
+                    else if (neighbourData.second < key[v]){ //lighter edge - decrease key
+                        parent[v] = u;
+                        key[v] = neighbourData.second;
+                        heap.reset(IndexWeight{v,U()},IndexWeight{v,key[v]});
+                    }
+                }
+            }
+        }
+        forest.weight = total(forest.edges);
+        return forest;
+    }
+
+    SpanningForest<U> boruvka(const uint32_t numThreads = defaultThreads()) const
+    {
+        uint32_t N = this->numVertices();
+        std::vector<Edge> edges = edgeList();
+        ConcurrentUnionFind sets(N);
+        std::vector<std::atomic<uint32_t> > lightest(N); //edge index chosen by each component root
+        std::vector<std::vector<std::tuple<uint32_t,uint32_t,U> > > added(numThreads);
+        std::vector<std::vector<Edge> > kept(numThreads);
+        std::vector<uint32_t> roots(N);
+        auto lighter = [&](const uint32_t a, const uint32_t b){ //strict order - index breaks ties
+            return (edges[a].weight < edges[b].weight) || (!(edges[b].weight < edges[a].weight) && (a < b));
+        };
+        auto offer = [&](const uint32_t component, const uint32_t e){
+            uint32_t current = lightest[component].load(std::memory_order_relaxed);
+            while (((current == UNSET) || lighter(e,current))
+                   && !lightest[component].compare_exchange_weak(current,e,std::memory_order_relaxed)){}
+        };
+        parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t v = begin; v < end; ++v)
+                lightest[v].store(UNSET,std::memory_order_relaxed);
+        });
+        while (!edges.empty()){
+            //1. lightest edge out of every component
+            parallelFor(edges.size(),numThreads,[&](uint32_t,size_t begin,size_t end){
+                for (size_t e = begin; e < end; ++e){
+                    offer(sets.find(edges[e].u),e);
+                    offer(sets.find(edges[e].v),e);
+                }
+            });
+            //2. add them - components are fixed until this step, so read roots first
+            parallelFor(N,numThreads,[&](uint32_t,size_t begin,size_t end){
+                for (size_t v = begin; v < end; ++v)
+                    roots[v] = sets.find(v);
+            });
+            parallelFor(N,numThreads,[&](uint32_t t,size_t begin,size_t end){
+                for (size_t v = begin; v < end; ++v){
+                    if (roots[v] != v)
+                        continue;
+                    uint32_t e = lightest[v].exchange(UNSET,std::memory_order_relaxed);
+                    if ((e != UNSET) && sets.unite(edges[e].u,edges[e].v))
+                        added[t].emplace_back(edges[e].u,edges[e].v,edges[e].weight);
+                }
+            });
+            //3. keep only edges still between components
+            parallelFor(edges.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+                for (size_t e = begin; e < end; ++e)
+                    if (!sets.same(edges[e].u,edges[e].v))
+                        kept[t].push_back(edges[e]);
+            });
+            edges.clear();
+            for (auto &part : kept){
+                edges.insert(edges.end(),part.begin(),part.end());
+                part.clear();
+            }
+        }
+        SpanningForest<U> forest;
+        for (auto &part : added)
+            forest.edges.insert(forest.edges.end(),part.begin(),part.end());
+        forest.weight = total(forest.edges);
+        return forest;
+    }
+};
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef size_t T;
+    typedef uint64_t U;
+    RndUniform rnd;
+
+    //sample graph - see sample_graph.jpg in pathfinding, treated as undirected
+    MSTGraph<T,U> graph(9);
+    graph.addEdgeUndirected(0,1,4);
+    graph.addEdgeUndirected(0,7,8);
+    graph.addEdgeUndirected(1,2,8);
+    graph.addEdgeUndirected(1,7,11);
+    graph.addEdgeUndirected(2,3,7);
+    graph.addEdgeUndirected(2,8,2);
+    graph.addEdgeUndirected(2,5,4);
+    graph.addEdgeUndirected(3,4,9);
+    graph.addEdgeUndirected(3,5,14);
+    graph.addEdgeUndirected(4,5,10);
+    graph.addEdgeUndirected(5,6,2);
+    graph.addEdgeUndirected(6,7,1);
+    graph.addEdgeUndirected(6,8,6);
+    graph.addEdgeUndirected(7,8,7);
+
+    SpanningForest<U> tree = graph.kruskal();
+    std::cout<<"minimum spanning tree (kruskal), weight "<<tree.weight<<std::endl;
+    for (const auto & [u,v,w] : tree.edges)
+        std::cout<<u<<" - "<<v<<" : "<<w<<std::endl;
+    std::cout<<"prim weight "<<graph.prim().weight<<", boruvka weight "<<graph.boruvka().weight<<std::endl;
+
+    //benchmark - sparse and dense random graphs
+    auto benchmark = [&](const char *name, const uint32_t N, const size_t E){
+        std::vector<std::tuple<uint32_t,uint32_t,U> > edges;
+        edges.reserve(2*E);
+        for (size_t e = 0; e < E; ++e){
+            uint32_t u = N*rnd(), v = N*rnd();
+            U w = 1 + static_cast<U>(1000000*rnd());
+            edges.emplace_back(u,v,w);
+            edges.emplace_back(v,u,w);
+        }
+        MSTGraph<T,U,CSRGraph<T,U> > big(N,edges);
+        edges = {};
+        auto timed = [](auto &&f){
+            auto start = std::chrono::steady_clock::now();
+            auto result = f();
+            auto end = std::chrono::steady_clock::now();
+            return std::make_pair(result,std::chrono::duration<double,std::milli>(end-start).count());
+        };
+        auto [kruskalTree,kruskalTime] = timed([&](){return big.kruskal();});
+        auto [primTree,primTime] = timed([&](){return big.prim();});
+        auto [boruvkaTree,boruvkaTime] = timed([&](){return big.boruvka();});
+        std::cout<<std::endl<<name<<": "<<N<<" vertices, "<<big.numEdges()/2<<" edges, forest of "<<kruskalTree.edges.size()<<" edges"<<std::endl;
+        std::cout<<"kruskal : "<<kruskalTime<<" ms"<<std::endl;
+        std::cout<<"prim    : "<<primTime<<" ms"<<std::endl;
+        std::cout<<"boruvka : "<<boruvkaTime<<" ms ("<<defaultThreads()<<" threads)"<<std::endl;
+        std::cout<<"agree: "<<((kruskalTree.weight == primTree.weight) && (kruskalTree.weight == boruvkaTree.weight)
+                               && (kruskalTree.edges.size() == primTree.edges.size()) && (kruskalTree.edges.size() == boruvkaTree.edges.size()))<<std::endl;
+    };
+    benchmark("sparse",1000000,4000000);
+    benchmark("dense",4000,4000000);
+
+    return 0;
+}
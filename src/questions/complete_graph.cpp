@@ -37,6 +37,11 @@ If there are M clusters, we thus need to rewire M-1 edges to connect them.
 
 So the answer is M-1, unless  |E| < N-1, in which case it is impossible.
 
+For very large graphs we needn't build adjacency lists at all - numComponentsUnionFind streams
+the edge list straight into a lock free union-find (ConcurrentUnionFind) split over threads,
+counting the successful merges. Memory is O(N) regardless of the number of edges, and there is
+no recursion to overflow the stack.
+
 */
 
 #include <iostream>
@@ -44,6 +49,12 @@ So the answer is M-1, unless  |E| < N-1, in which case it is impossible.
 #include <vector>
 #include <array>
 #include <string>
+#include <atomic>
+#include "union_find.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::disjoint_sets;
+using namespace structures_and_algorithms::parallel;
 
 //make adjacency lists out of adjacency matrix
 template<size_t N>
@@ -99,6 +110,20 @@ size_t numComponents(const std::vector<std::list<uint32_t> > &adjLists)
     return numClusters;
 }
 
+//number of connected components straight from an edge list - edges treated as undirected
+size_t numComponentsUnionFind(size_t N, const std::vector<std::array<size_t,2>> &adjList, uint32_t numThreads = defaultThreads())
+{
+    ConcurrentUnionFind sets(N);
+    std::atomic<size_t> merges(0);
+    parallelFor(adjList.size(),numThreads,[&](uint32_t,size_t begin,size_t end){
+        size_t localMerges = 0;
+        for (size_t i = begin; i < end; ++i)
+            localMerges += sets.unite(adjList[i][0],adjList[i][1]);
+        merges += localMerges;
+    });
+    return N - merges;
+}
+
 int main(/*int argc, char* argv[]*/)
 {
     size_t N = 4;
@@ -111,6 +136,7 @@ int main(/*int argc, char* argv[]*/)
     size_t edges = 0;
     auto adjLists = makeAdjLists(N,adjList,edges);
     size_t C = numComponents(adjLists);
+    std::cout<<C<<" component(s) by DFS, "<<numComponentsUnionFind(N,adjList)<<" by union-find"<<std::endl;
     size_t freeEdges = N-1;
     if (freeEdges >= C-1)
         std::cout<<C-1<<" change(s) required"<<std::endl;
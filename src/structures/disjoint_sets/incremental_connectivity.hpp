@@ -0,0 +1,134 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Incremental connectivity - cluster membership of a graph that only gains edges
+
+Recomputing clusters with a DFS (GraphCluster::getClusters) after every change costs O(V+E).
+If edges are only ever added, a union-find answers the same questions as the edges arrive:
+
+    addEdge(u,v)      : merge the clusters of u and v                              - ~O(1)
+    sameCluster(u,v)  : are u and v connected (false if out of range)              - ~O(1)
+    clusterOf(u)      : representative vertex of u's cluster (|V| if out of range) - ~O(1)
+    numClusters()     : number of clusters, kept as a running count                - O(1)
+    labels()          : 1,2,... labels in order of lowest vertex, as getClusters   - O(V)
+
+(~O(1) = amortised inverse Ackermann.)
+
+Built on ConcurrentUnionFind so every operation is safe to call from many threads at once;
+addEdges takes a batch and splits it over threads. The number of clusters is decremented on
+each successful merge, so it is exact once all in-flight addEdge calls have returned.
+
+clusterOf returns the current root, which can change when clusters merge - compare
+representatives taken at the same time, or use sameCluster.
+
+Edge deletions are not supported (that needs a fully dynamic structure, e.g. Holm et al.).
+
+*/
+
+#ifndef INCREMENTAL_CONNECTIVITY_H
+#define INCREMENTAL_CONNECTIVITY_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+#include "union_find.hpp"
+#include "parallel.hpp"
+
+namespace structures_and_algorithms::structures::disjoint_sets{
+
+class IncrementalConnectivity{
+    ConcurrentUnionFind sets;
+    std::atomic<uint32_t> count;
+public:
+    IncrementalConnectivity(const uint32_t N):sets(N),count(N){}
+
+    uint32_t numVertices() const noexcept
+    {
+        return sets.size();
+    }
+
+    //returns true if u and v were in different clusters
+    bool addEdge(const uint32_t u, const uint32_t v)
+    {
+        uint32_t N = numVertices();
+        if ((u>=N)||(v>=N))
+            return false;
+        if (!sets.unite(u,v))
+            return false;
+        count.fetch_sub(1,std::memory_order_relaxed);
+        return true;
+    }
+
+    //batch of edges split over threads - returns number of merges
+    size_t addEdges(const std::vector<std::pair<uint32_t,uint32_t> > &edgeList, uint32_t numThreads = parallel::defaultThreads())
+    {
+        std::atomic<size_t> merges(0);
+        parallel::parallelFor(edgeList.size(),numThreads,[&](uint32_t,size_t begin,size_t end){
+            size_t localMerges = 0;
+            for (size_t i = begin; i < end; ++i)
+                localMerges += addEdge(edgeList[i].first,edgeList[i].second);
+            merges += localMerges;
+        });
+        return merges;
+    }
+
+    //false if either vertex is out of range
+    bool sameCluster(const uint32_t u, const uint32_t v)
+    {
+        uint32_t N = numVertices();
+        if ((u>=N)||(v>=N))
+            return false;
+        return sets.same(u,v);
+    }
+
+    //numVertices() (never a representative) if u is out of range
+    uint32_t clusterOf(const uint32_t u)
+    {
+        uint32_t N = numVertices();
+        if (u>=N)
+            return N;
+        return sets.find(u);
+    }
+
+    uint32_t numClusters() const noexcept
+    {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    //snapshot of cluster labels 1..numClusters(), numbered in order of their lowest vertex
+    std::vector<uint32_t> labels()
+    {
+        uint32_t N = numVertices();
+        std::vector<uint32_t> label(N,0), clusterList(N);
+        uint32_t cluster = 0;
+        for (uint32_t u = 0; u < N; ++u){
+            uint32_t root = sets.find(u);
+            if (!label[root])
+                label[root] = ++cluster;
+            clusterList[u] = label[root];
+        }
+        return clusterList;
+    }
+};
+
+}
+
+#endif /*INCREMENTAL_CONNECTIVITY_H*/
@@ -0,0 +1,83 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Union-find test - sequential and concurrent versions should find the same number of sets
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "union_find.hpp"
+#include "random.hpp"
+#include "parallel.hpp"
+
+using namespace structures_and_algorithms::structures::disjoint_sets;
+using namespace structures_and_algorithms::random;
+using namespace structures_and_algorithms::parallel;
+
+int main(/*int argc, char* argv[]*/)
+{
+    const uint32_t N = 10;
+    RndUniform rnd;
+
+    UnionFind small(N);
+    std::cout<<"unions"<<std::endl;
+    for (uint32_t i = 0; i < 6; ++i){
+        uint32_t x = N*rnd();
+        uint32_t y = N*rnd();
+        std::cout<<x<<" "<<y<<" "<<small.unite(x,y)<<std::endl;
+    }
+    std::cout<<small.numSets()<<" sets"<<std::endl;
+    for (uint32_t i = 0; i < N; ++i)
+        std::cout<<i<<" : "<<small.find(i)<<std::endl;
+
+    //random edges - count sets both ways
+    const uint32_t bigN = 1000000;
+    const size_t numEdges = 900000;
+    std::vector<std::pair<uint32_t,uint32_t> > edges(numEdges);
+    for (auto & e : edges)
+        e = {static_cast<uint32_t>(bigN*rnd()),static_cast<uint32_t>(bigN*rnd())};
+
+    auto start = std::chrono::steady_clock::now();
+    UnionFind sequential(bigN);
+    for (const auto & e : edges)
+        sequential.unite(e.first,e.second);
+    auto mid = std::chrono::steady_clock::now();
+    ConcurrentUnionFind concurrent(bigN);
+    uint32_t numThreads = defaultThreads();
+    std::vector<size_t> merges(numThreads,0);
+    parallelFor(edges.size(),numThreads,[&](uint32_t t,size_t begin,size_t end){
+        for (size_t i = begin; i < end; ++i)
+            merges[t] += concurrent.unite(edges[i].first,edges[i].second);
+    });
+    auto end = std::chrono::steady_clock::now();
+    size_t concurrentSets = bigN;
+    for (size_t m : merges)
+        concurrentSets -= m;
+
+    std::cout<<std::endl<<bigN<<" elements, "<<numEdges<<" unions, "<<numThreads<<" threads"<<std::endl;
+    std::cout<<"sequential : "<<sequential.numSets()<<" sets "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"concurrent : "<<concurrentSets<<" sets "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+
+    return 0;
+}
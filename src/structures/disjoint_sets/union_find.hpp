@@ -0,0 +1,190 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Union-find (disjoint set) structures
+
+Keeps a partition of elements 0 ... N-1 into disjoint sets, with
+
+    find(x)     : representative ("root") element of the set containing x
+    unite(x,y)  : merge the sets containing x and y
+
+Each set is a tree stored as a parent array - the root is its own parent. Two heuristics keep
+the trees flat, giving amortised O(alpha(N)) per operation (alpha = inverse Ackermann, < 5 for
+any practical N):
+
+    union by rank    : hang the shallower tree (lower rank) under the deeper one
+    path compression : point elements on the path from x to its root at (or nearer) the root
+
+UnionFind is the usual sequential version.
+
+ConcurrentUnionFind may be used by many threads at once, without locks. Parent and rank of
+each element are packed into one 64 bit atomic word (rank in the high 32 bits) so that:
+
+    - a root is linked under another root with a single compare-exchange, which fails (and we
+      retry) if the root has meanwhile been linked elsewhere or had its rank changed
+    - ties in rank are broken by element index, so two threads can never link two roots under
+      each other and create a cycle
+    - path compression is done by "path halving" - each step tries to point x at its
+      grandparent with a compare-exchange; failure just means someone else changed it first
+
+*/
+
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <vector>
+#include <atomic>
+#include <utility>
+
+namespace structures_and_algorithms::structures::disjoint_sets{
+
+class UnionFind{
+    std::vector<uint32_t> parent;
+    std::vector<uint8_t> rank;
+    uint32_t count; //number of sets
+public:
+    UnionFind(const uint32_t N):parent(N),rank(N,0),count(N)
+    {
+        for (uint32_t i = 0; i < N; ++i)
+            parent[i] = i;
+    }
+
+    uint32_t size() const noexcept
+    {
+        return parent.size();
+    }
+
+    uint32_t numSets() const noexcept
+    {
+        return count;
+    }
+
+    uint32_t find(uint32_t x)
+    {
+        uint32_t root = x;
+        while (parent[root] != root)
+            root = parent[root];
+        while (parent[x] != root){ //full path compression
+            uint32_t next = parent[x];
+            parent[x] = root;
+            x = next;
+        }
+        return root;
+    }
+
+    //returns true if x and y were in different sets
+    bool unite(uint32_t x, uint32_t y)
+    {
+        x = find(x);
+        y = find(y);
+        if (x == y)
+            return false;
+        if (rank[x] < rank[y])
+            std::swap(x,y);
+        parent[y] = x;
+        if (rank[x] == rank[y])
+            ++rank[x];
+        --count;
+        return true;
+    }
+
+    bool same(uint32_t x, uint32_t y)
+    {
+        return find(x) == find(y);
+    }
+};
+
+class ConcurrentUnionFind{
+    std::vector<std::atomic<uint64_t> > nodes; //rank << 32 | parent
+
+    static uint64_t pack(uint32_t rank, uint32_t parent) {return (static_cast<uint64_t>(rank) << 32) | parent;}
+    static uint32_t parentOf(uint64_t node) {return static_cast<uint32_t>(node);}
+    static uint32_t rankOf(uint64_t node) {return static_cast<uint32_t>(node >> 32);}
+
+public:
+    ConcurrentUnionFind(const uint32_t N):nodes(N)
+    {
+        for (uint32_t i = 0; i < N; ++i)
+            nodes[i].store(pack(0,i),std::memory_order_relaxed);
+    }
+
+    uint32_t size() const noexcept
+    {
+        return nodes.size();
+    }
+
+    uint32_t find(uint32_t x)
+    {
+        while (true){
+            uint64_t node = nodes[x].load(std::memory_order_acquire);
+            uint32_t parent = parentOf(node);
+            if (parent == x)
+                return x;
+            uint32_t grandparent = parentOf(nodes[parent].load(std::memory_order_acquire));
+            if (grandparent != parent) //path halving - point x at its grandparent
+                nodes[x].compare_exchange_weak(node,pack(rankOf(node),grandparent),std::memory_order_release,std::memory_order_relaxed);
+            x = parent;
+        }
+    }
+
+    //returns true if this call merged two different sets
+    bool unite(uint32_t x, uint32_t y)
+    {
+        while (true){
+            x = find(x);
+            y = find(y);
+            if (x == y)
+                return false;
+            uint64_t nodeX = nodes[x].load(std::memory_order_acquire);
+            uint64_t nodeY = nodes[y].load(std::memory_order_acquire);
+            if ((parentOf(nodeX) != x) || (parentOf(nodeY) != y))
+                continue; //no longer roots - find again
+            uint32_t rankX = rankOf(nodeX), rankY = rankOf(nodeY);
+            if ((rankX < rankY) || ((rankX == rankY) && (x > y))){ //y becomes the new root
+                std::swap(x,y);
+                std::swap(nodeX,nodeY);
+                std::swap(rankX,rankY);
+            }
+            //link y under x - only if y is still a root with the rank we saw
+            if (!nodes[y].compare_exchange_strong(nodeY,pack(rankY,x),std::memory_order_acq_rel,std::memory_order_relaxed))
+                continue;
+            if (rankX == rankY) //rank is only a heuristic, fine if this fails
+                nodes[x].compare_exchange_strong(nodeX,pack(rankX + 1,x),std::memory_order_acq_rel,std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    bool same(uint32_t x, uint32_t y)
+    {
+        while (true){
+            x = find(x);
+            y = find(y);
+            if (x == y)
+                return true;
+            if (parentOf(nodes[x].load(std::memory_order_acquire)) == x) //x still a root so really different sets
+                return false;
+        }
+    }
+};
+
+}
+
+#endif /*UNION_FIND_H*/
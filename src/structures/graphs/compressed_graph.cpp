@@ -0,0 +1,153 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Compressed graph - memory per edge and BFS speed against Graph and CSRGraph
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <tuple>
+#include <chrono>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "compressed_graph.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+
+//hop distances from source - works on anything with numVertices() and neighbours()
+template<typename G>
+std::vector<uint32_t> hops(const G &graph, uint32_t source)
+{
+    std::vector<uint32_t> distance(graph.numVertices(),UINT32_MAX);
+    std::queue<uint32_t> queue;
+    distance[source] = 0;
+    queue.push(source);
+    while (!queue.empty()){
+        uint32_t u = queue.front();
+        queue.pop();
+        for (const auto & neighbourData : graph.neighbours(u)){
+            if (distance[neighbourData.first] == UINT32_MAX){
+                distance[neighbourData.first] = distance[u] + 1;
+                queue.push(neighbourData.first);
+            }
+        }
+    }
+    return distance;
+}
+
+template<typename G>
+double timeBFS(const G &graph, std::vector<uint32_t> &distance)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t source : {0u,1u,2u})
+        distance = hops(graph,source);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double,std::milli>(end-start).count() / 3;
+}
+
+template<typename T,typename U>
+void compare(const std::string &name, const uint32_t N, const std::vector<std::tuple<uint32_t,uint32_t,U> > &edgeList)
+{
+    Graph<T,U> graph(N);
+    for (const auto & [u,v,w] : edgeList)
+        graph.addEdge(u,v,w);
+    CSRGraph<T,U> csr(graph);
+    CompressedGraph<T,U> compressed(graph);
+
+    //same edges, neighbours sorted
+    bool same = (compressed.numEdges() == csr.numEdges());
+    for (uint32_t u = 0; (u < N) && same; ++u){
+        std::vector<std::pair<uint32_t,U> > expected, decoded;
+        for (const auto & neighbourData : csr.neighbours(u))
+            expected.push_back(neighbourData);
+        std::stable_sort(expected.begin(),expected.end(),[](const auto &a, const auto &b){return a.first < b.first;});
+        for (const auto & neighbourData : compressed.neighbours(u))
+            decoded.push_back(neighbourData);
+        same = (expected == decoded) && (compressed.degree(u) == expected.size());
+    }
+
+    double E = csr.numEdges();
+    //a list node holds two pointers and the pair, rounded up to the 16 byte malloc granularity
+    double listBytes = N*sizeof(std::list<std::pair<uint32_t,U> >) + E*(((2*sizeof(void*) + sizeof(std::pair<uint32_t,U>) + 8 + 15) / 16) * 16);
+    double csrBytes = (N + 1)*sizeof(uint64_t) + E*(sizeof(uint32_t) + sizeof(U));
+    double compressedBytes = compressed.adjacencyBytes();
+
+    std::vector<uint32_t> dGraph, dCSR, dCompressed;
+    double tGraph = timeBFS(graph,dGraph);
+    double tCSR = timeBFS(csr,dCSR);
+    double tCompressed = timeBFS(compressed,dCompressed);
+
+    std::cout<<name<<": "<<N<<" vertices, "<<csr.numEdges()<<" edges"<<std::endl;
+    std::cout<<"  Graph      : "<<listBytes/E<<" bytes/edge (est.), BFS "<<tGraph<<" ms"<<std::endl;
+    std::cout<<"  CSRGraph   : "<<csrBytes/E<<" bytes/edge, BFS "<<tCSR<<" ms"<<std::endl;
+    std::cout<<"  Compressed : "<<compressedBytes/E<<" bytes/edge, BFS "<<tCompressed<<" ms"<<std::endl;
+    std::cout<<"  decodes identically: "<<same<<", BFS agrees: "<<((dGraph == dCSR) && (dCSR == dCompressed))<<std::endl;
+}
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef size_t T;
+    typedef uint32_t U;
+    RndUniform rnd;
+
+    //small example, neighbours come back sorted
+    std::vector<std::pair<uint32_t,uint32_t> > data = {{0,3},{0,1},{1,2},{2,0},{3,2},{3,1},{3,0}};
+    CompressedGraph<T,U> small(4,data);
+    small.print();
+
+    //grid - neighbours are close in index, gaps are tiny
+    const uint32_t side = 512;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList;
+    for (uint32_t r = 0; r < side; ++r){
+        for (uint32_t c = 0; c < side; ++c){
+            uint32_t u = r*side + c;
+            if (c + 1 < side){
+                U w = 1 + 9*rnd();
+                edgeList.emplace_back(u,u + 1,w);
+                edgeList.emplace_back(u + 1,u,w);
+            }
+            if (r + 1 < side){
+                U w = 1 + 9*rnd();
+                edgeList.emplace_back(u,u + side,w);
+                edgeList.emplace_back(u + side,u,w);
+            }
+        }
+    }
+    std::cout<<std::endl;
+    compare<T,U>("grid",side*side,edgeList);
+
+    //random - no locality, gaps ~ N/degree
+    const uint32_t N = 1 << 18;
+    edgeList.clear();
+    for (size_t e = 0; e < 8*static_cast<size_t>(N); ++e){
+        uint32_t u = N*rnd();
+        uint32_t v = N*rnd();
+        edgeList.emplace_back(u,v,1);
+        edgeList.emplace_back(v,u,1);
+    }
+    compare<T,U>("random",N,edgeList);
+
+    return 0;
+}
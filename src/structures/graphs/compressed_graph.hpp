@@ -0,0 +1,350 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Compressed graph structure - immutable, delta + varint encoded adjacency
+
+A Graph edge is a std::list node - two pointers plus the (neighbour,weight) pair, ~32 bytes with
+allocator overhead. CSRGraph brings that down to 4 + sizeof(U). This goes further: each vertex's
+neighbours are sorted and stored as gaps, and gaps are small numbers, so they're written as
+variable length integers ("varints"):
+
+    7 bits of the value per byte, low bits first, top bit set if more bytes follow
+    e.g. 5 -> 0x05,   300 -> 0xAC 0x02
+
+The block for vertex u is
+
+    varint degree
+    varint zigzag(v0 - u)        first neighbour relative to u (may be negative)
+    [weight of edge u -> v0]
+    varint v1 - v0               later neighbours relative to the previous one (>= 0)
+    [weight of edge u -> v1]
+    ...
+
+zigzag maps signed to unsigned small numbers: 0,-1,1,-2,2 -> 0,1,2,3,4. Integral weights are
+zigzag varints too, other weight types are copied raw. If every edge has the same weight
+(e.g. unweighted graphs) it is stored once and left out of the blocks.
+
+Block positions take 4 bytes per vertex rather than 8: a 64 bit offset for every 64 vertices,
+plus a 32 bit offset of each vertex from the start of its group (so no group of 64 vertices may
+encode to more than 4GB).
+
+Varints are decoded a word at a time - load 8 bytes, find the first byte with its top bit clear
+to get the length, and gather the 7 bit groups (one pext instruction with BMI2). Graphs with locality (road networks,
+meshes, web graphs, or any graph after a good vertex reordering) have small gaps and compress
+to 1-2 bytes per edge, random graphs with 2^20 vertices to ~3.
+
+Neighbours are decoded on the fly by the iterator, which keeps a byte pointer, the previous
+neighbour and the count of edges left. neighbours(u) returns a range with the same interface as
+Graph::neighbours and CSRGraph::neighbours (elements with .first/.second, and size()), so
+traversal algorithms take CompressedGraph as their Base unchanged. Decoding is sequential
+and branch predictable (almost all varints are 1 or 2 bytes), but it is not free: measured
+traversals take about 1.4-1.9x as long as over CSRGraph, in exchange for about half the memory.
+Use it when the graph would not otherwise fit in memory.
+
+Neighbours come out sorted by index, not in insertion order. Duplicate edges are kept (gap 0).
+
+*/
+
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "bits.hpp"
+
+namespace structures_and_algorithms::structures::graphs{
+
+namespace varint{
+    inline void write(std::vector<uint8_t> &bytes, uint64_t value)
+    {
+        while (value >= 0x80){
+            bytes.push_back(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    //simple byte at a time decode
+    inline uint64_t readSlow(const uint8_t *&p)
+    {
+        uint64_t value = 0;
+        for (uint32_t shift = 0;; shift += 7){
+            uint64_t byte = *p++;
+            value |= (byte & 0x7f) << shift;
+            if (byte < 0x80)
+                return value;
+        }
+    }
+
+    //word at a time decode - reads 8 bytes, so the buffer needs 8 bytes of padding at its end
+    inline uint64_t read(const uint8_t *&p)
+    {
+        uint64_t word;
+        std::memcpy(&word,p,sizeof(word));
+        uint64_t stops = ~word & 0x8080808080808080ULL; //top bit clear marks the last byte
+        if (stops == 0) //more than 8 bytes (values >= 2^56)
+            return readSlow(p);
+        uint32_t length = (bits::countTrailingZeros(stops) >> 3) + 1;
+        p += length;
+#ifdef __BMI2__
+        uint64_t mask = (length == 8) ? ~0ULL : ((1ULL << (8*length)) - 1);
+        return _pext_u64(word & mask,0x7f7f7f7f7f7f7f7fULL);
+#else
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < length; ++i)
+            value |= ((word >> (8*i)) & 0x7f) << (7*i);
+        return value;
+#endif
+    }
+
+    inline uint64_t zigzag(int64_t value)
+    {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t value)
+    {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+template<typename T = size_t,typename U = uint8_t> //T value at nodes, U edge weights
+class CompressedGraph{
+protected:
+    static constexpr uint32_t blockShift = 6; //64 vertices share one 64 bit offset
+
+    std::vector<T> vertexData;
+    std::vector<uint64_t> blockOffsets;  //start of each block of 64 vertices in bytes
+    std::vector<uint32_t> vertexOffsets; //start of each vertex relative to its block
+    std::vector<uint8_t> bytes;
+    size_t edgeCount = 0;
+    bool sharedWeight = true; //all edges have the same weight, which is then not stored per edge
+    U weight = U();
+
+    static constexpr bool integralWeights = std::is_integral_v<U>;
+
+    static void writeWeight(std::vector<uint8_t> &out, const U &w)
+    {
+        if constexpr (integralWeights){
+            varint::write(out,varint::zigzag(static_cast<int64_t>(w)));
+        } else {
+            static_assert(std::is_trivially_copyable_v<U>,"non integral edge weights must be trivially copyable");
+            const uint8_t *raw = reinterpret_cast<const uint8_t*>(&w);
+            out.insert(out.end(),raw,raw + sizeof(U));
+        }
+    }
+
+    static U readWeight(const uint8_t *&p)
+    {
+        if constexpr (integralWeights){
+            return static_cast<U>(varint::unzigzag(varint::read(p)));
+        } else {
+            U w;
+            std::memcpy(&w,p,sizeof(U));
+            p += sizeof(U);
+            return w;
+        }
+    }
+
+    const uint8_t* block(const uint32_t u) const
+    {
+        return bytes.data() + blockOffsets[u >> blockShift] + vertexOffsets[u];
+    }
+
+    //encode from anything with numVertices() and neighbours()
+    template<typename G>
+    void build(const G &graph)
+    {
+        uint32_t N = graph.numVertices();
+        bool first = true;
+        for (uint32_t u = 0; (u < N) && sharedWeight; ++u){
+            for (const auto &neighbourData : graph.neighbours(u)){
+                if (first)
+                    weight = neighbourData.second;
+                sharedWeight = sharedWeight && (first || (neighbourData.second == weight));
+                first = false;
+            }
+        }
+        blockOffsets.reserve((N >> blockShift) + 1);
+        vertexOffsets.reserve(N);
+        std::vector<std::pair<uint32_t,U> > sorted;
+        for (uint32_t u = 0; u < N; ++u){
+            if ((u & ((1u << blockShift) - 1)) == 0)
+                blockOffsets.push_back(bytes.size());
+            vertexOffsets.push_back(bytes.size() - blockOffsets.back());
+            sorted.clear();
+            for (const auto &neighbourData : graph.neighbours(u))
+                sorted.emplace_back(neighbourData.first,neighbourData.second);
+            std::stable_sort(sorted.begin(),sorted.end(),
+                             [](const std::pair<uint32_t,U> &a, const std::pair<uint32_t,U> &b){return a.first < b.first;});
+            varint::write(bytes,sorted.size());
+            int64_t previous = u;
+            for (size_t i = 0; i < sorted.size(); ++i){
+                int64_t gap = static_cast<int64_t>(sorted[i].first) - previous;
+                varint::write(bytes,(i == 0) ? varint::zigzag(gap) : static_cast<uint64_t>(gap));
+                if (!sharedWeight)
+                    writeWeight(bytes,sorted[i].second);
+                previous = sorted[i].first;
+            }
+            edgeCount += sorted.size();
+        }
+        blockOffsets.push_back(bytes.size());
+        bytes.resize(bytes.size() + 8,0); //padding for varint::read
+        bytes.shrink_to_fit();
+    }
+
+public:
+    //iterator over the edges of one vertex - decodes to (neighbour,weight) by value
+    class NeighbourIterator{
+        const uint8_t *p;
+        size_t remaining;
+        bool sharedWeight;
+        std::pair<uint32_t,U> current;
+        void decode(bool first)
+        {
+            uint64_t gap = varint::read(p);
+            current.first = first ? static_cast<uint32_t>(current.first + varint::unzigzag(gap)) : static_cast<uint32_t>(current.first + gap);
+            if (!sharedWeight)
+                current.second = readWeight(p);
+        }
+    public:
+        NeighbourIterator(const uint8_t *p_, size_t remaining_, uint32_t source, bool sharedWeight_, const U &weight_):
+            p(p_),remaining(remaining_),sharedWeight(sharedWeight_),current(source,weight_)
+        {
+            if (remaining)
+                decode(true);
+        }
+        const std::pair<uint32_t,U>& operator*() const {return current;}
+        NeighbourIterator& operator++()
+        {
+            if (--remaining)
+                decode(false);
+            return *this;
+        }
+        bool operator==(const NeighbourIterator &it) const {return remaining == it.remaining;}
+        bool operator!=(const NeighbourIterator &it) const {return remaining != it.remaining;}
+    };
+
+    class NeighbourRange{
+        const uint8_t *p;
+        size_t count;
+        uint32_t source;
+        bool sharedWeight;
+        U weight;
+    public:
+        NeighbourRange(const uint8_t *p_, size_t count_, uint32_t source_, bool sharedWeight_, const U &weight_):
+            p(p_),count(count_),source(source_),sharedWeight(sharedWeight_),weight(weight_){}
+        NeighbourIterator begin() const {return {p,count,source,sharedWeight,weight};}
+        NeighbourIterator end() const {return {p,0,source,sharedWeight,weight};}
+        size_t size() const noexcept {return count;}
+    };
+
+    CompressedGraph():blockOffsets(1,0),bytes(8,0){}
+
+    //from adjacency list graph
+    CompressedGraph(const Graph<T,U> &graph):vertexData(graph.numVertices())
+    {
+        for (uint32_t u = 0; u < graph.numVertices(); ++u)
+            vertexData[u] = graph.getValue(u);
+        build(graph);
+    }
+
+    //from CSR graph
+    CompressedGraph(const CSRGraph<T,U> &graph):vertexData(graph.numVertices())
+    {
+        for (uint32_t u = 0; u < graph.numVertices(); ++u)
+            vertexData[u] = graph.getValue(u);
+        build(graph);
+    }
+
+    //from weighted edge list (u,v,w)
+    CompressedGraph(const uint32_t N, const std::vector<std::tuple<uint32_t,uint32_t,U> > &edgeList):
+        CompressedGraph(CSRGraph<T,U>(N,edgeList)){}
+
+    //from unweighted edge list (u,v) - default weights
+    CompressedGraph(const uint32_t N, const std::vector<std::pair<uint32_t,uint32_t> > &edgeList):
+        CompressedGraph(CSRGraph<T,U>(N,edgeList)){}
+
+    uint32_t numVertices() const noexcept
+    {
+        return vertexData.size();
+    }
+
+    size_t numEdges() const noexcept
+    {
+        return edgeCount;
+    }
+
+    size_t degree(const uint32_t u) const
+    {
+        const uint8_t *p = block(u);
+        return varint::read(p);
+    }
+
+    NeighbourRange neighbours(const uint32_t u) const
+    {
+        const uint8_t *p = block(u);
+        size_t count = varint::read(p);
+        return {p,count,u,sharedWeight,weight};
+    }
+
+    const T& getValue(const uint32_t u) const
+    {
+        return vertexData[u];
+    }
+
+    bool setValue(const uint32_t u, const T val)
+    {
+        if (u>=numVertices())
+            return false;
+        vertexData[u]=val;
+        return true;
+    }
+
+    //bytes used by the adjacency (offsets + encoded edges), excluding vertex data
+    size_t adjacencyBytes() const noexcept
+    {
+        return blockOffsets.size()*sizeof(uint64_t) + vertexOffsets.size()*sizeof(uint32_t) + bytes.size();
+    }
+
+    void print()
+    {
+        for (uint32_t i=0;i<numVertices();++i){
+            for (const auto &neighbourData : neighbours(i)){
+                std::cout<<i<<" "<<neighbourData.first<<std::endl;
+            }
+        }
+    }
+};
+
+}
+
+#endif /*COMPRESSED_GRAPH_H*/
@@ -0,0 +1,79 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+CSR graph structure - built from a Graph and from an edge list
+
+*/
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+
+int main(/*int argc, char* argv[]*/)
+{
+
+    typedef int32_t T;
+    typedef int32_t U;
+    int32_t N = 10;
+    RndUniform rnd;
+    std::vector<std::pair<uint32_t,uint32_t> > data(20);
+    
+    for (auto & x: data){
+        x.first=N*rnd();
+        x.second = x.first;
+        while (x.second == x.first)
+            x.second=N*rnd();
+    }
+    
+    Graph<T,U> graph(N);
+    for (const auto & x: data)
+        graph.addEdge(x.first,x.second);
+
+    CSRGraph<T,U> fromGraph(graph);
+    CSRGraph<T,U> fromEdges(N,data);
+
+    std::cout<<"graph edges"<<std::endl;
+    graph.print();
+    std::cout<<std::endl<<"csr from graph: "<<fromGraph.numEdges()<<" edges"<<std::endl;
+    fromGraph.print();
+    std::cout<<std::endl<<"csr from edge list: "<<fromEdges.numEdges()<<" edges"<<std::endl;
+    fromEdges.print();
+
+    //both expose the same adjacency ranges
+    bool same = (fromGraph.numVertices() == graph.numVertices());
+    for (uint32_t u = 0; u < graph.numVertices(); ++u){
+        auto it = fromEdges.neighbours(u).begin();
+        for (const auto & neighbourData : graph.neighbours(u)){
+            same = same && ((*it).first == neighbourData.first) && ((*it).second == neighbourData.second);
+            ++it;
+        }
+        same = same && (it == fromEdges.neighbours(u).end());
+    }
+    std::cout<<std::endl<<"adjacency identical: "<<same<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Compressed sparse row (CSR) graph structure - immutable
+
+Graph stores each vertex's edges in a std::list, so every edge is its own heap allocation and
+walking an adjacency list is a pointer chase. CSR packs all edges into flat arrays:
+
+1) vector of vertex data of type T comprising all vertices
+2) offsets - size |V|+1, the edges out of vertex i are at positions [offsets[i], offsets[i+1])
+3) targets - size |E|, the outgoing vertex index j of each edge
+4) weights - size |E|, the weight of each edge i -> j
+
+    e.g. 0 -> 1, 0 -> 2, 2 -> 1   gives   offsets = [0,2,2,3], targets = [1,2,1]
+
+Neighbours of a vertex are then contiguous in memory and the structure costs
+4 + sizeof(U) bytes per edge, plus 8 bytes per vertex.
+
+Built in O(|V|+|E|) from a Graph, or from an edge list with a counting sort on the source vertex
+(count out-degrees, prefix sum into offsets, scatter edges). Edge lists keep the order of the
+input within each vertex, and skip the same edges Graph::addEdge would refuse (out of bounds,
+self loops).
+
+neighbours(u) returns a range whose elements have .first (neighbour) and .second (weight), the
+same as Graph::neighbours, so algorithms using only numVertices() and neighbours() work with
+either structure.
+
+*/
+
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <iostream>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include "graph.hpp"
+
+namespace structures_and_algorithms::structures::graphs{
+
+template<typename T = size_t,typename U = uint8_t> //T value at nodes, U edge weights
+class CSRGraph{
+protected:
+    std::vector<T> vertexData;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<U> weights;
+
+    static U defaultWeight()
+    {
+        //if numeric type default edge weight is 1.
+        if constexpr (std::is_arithmetic_v<U>)
+            return static_cast<U>(1);
+        else
+            return U();
+    }
+
+    //counting sort edges (source,target,weight) by source
+    template<typename EdgeList, typename GetEdge>
+    void build(const uint32_t N, const EdgeList &edgeList, GetEdge &&getEdge)
+    {
+        vertexData = std::vector<T>(N);
+        offsets.assign(N + 1,0);
+        for (const auto &edge : edgeList){ //count out degree
+            auto [u,v,w] = getEdge(edge);
+            (void)w;
+            if ((u < N) && (v < N) && (u != v))
+                ++offsets[u + 1];
+        }
+        for (uint32_t u = 0; u < N; ++u) //prefix sum
+            offsets[u + 1] += offsets[u];
+        targets.resize(offsets[N]);
+        weights.resize(offsets[N]);
+        std::vector<uint64_t> position(offsets.begin(),offsets.end() - 1);
+        for (const auto &edge : edgeList){ //scatter
+            auto [u,v,w] = getEdge(edge);
+            if ((u < N) && (v < N) && (u != v)){
+                targets[position[u]] = v;
+                weights[position[u]] = w;
+                ++position[u];
+            }
+        }
+    }
+
+public:
+    //iterator over the edges of one vertex - dereferences to (neighbour,weight) by value
+    class NeighbourIterator{
+        const uint32_t *target;
+        const U *weight;
+    public:
+        NeighbourIterator(const uint32_t *target_, const U *weight_):target(target_),weight(weight_){}
+        std::pair<uint32_t,U> operator*() const {return {*target,*weight};}
+        NeighbourIterator& operator++() {++target; ++weight; return *this;}
+        bool operator==(const NeighbourIterator &it) const {return target == it.target;}
+        bool operator!=(const NeighbourIterator &it) const {return target != it.target;}
+    };
+
+    class NeighbourRange{
+        const uint32_t *target;
+        const U *weight;
+        size_t count;
+    public:
+        NeighbourRange(const uint32_t *target_, const U *weight_, size_t count_):target(target_),weight(weight_),count(count_){}
+        NeighbourIterator begin() const {return {target,weight};}
+        NeighbourIterator end() const {return {target + count,weight + count};}
+        size_t size() const noexcept {return count;}
+    };
+
+    CSRGraph():offsets(1,0){}
+
+    //from adjacency list graph
+    CSRGraph(const Graph<T,U> &graph)
+    {
+        uint32_t N = graph.numVertices();
+        vertexData.reserve(N);
+        offsets.reserve(N + 1);
+        offsets.push_back(0);
+        for (uint32_t u = 0; u < N; ++u){
+            vertexData.push_back(graph.getValue(u));
+            offsets.push_back(offsets.back() + graph.neighbours(u).size());
+        }
+        targets.reserve(offsets.back());
+        weights.reserve(offsets.back());
+        for (uint32_t u = 0; u < N; ++u){
+            for (const auto &neighbourData : graph.neighbours(u)){
+                targets.push_back(neighbourData.first);
+                weights.push_back(neighbourData.second);
+            }
+        }
+    }
+
+    //from weighted edge list (u,v,w)
+    CSRGraph(const uint32_t N, const std::vector<std::tuple<uint32_t,uint32_t,U> > &edgeList)
+    {
+        build(N,edgeList,[](const std::tuple<uint32_t,uint32_t,U> &edge){return edge;});
+    }
+
+    //from unweighted edge list (u,v) - default weights
+    CSRGraph(const uint32_t N, const std::vector<std::pair<uint32_t,uint32_t> > &edgeList)
+    {
+        const U w = defaultWeight();
+        build(N,edgeList,[w](const std::pair<uint32_t,uint32_t> &edge){return std::make_tuple(edge.first,edge.second,w);});
+    }
+
+    //from prebuilt arrays (e.g. a file loader) - offsets.size() must be |V|+1, targets/weights offsets.back()
+    CSRGraph(std::vector<uint64_t> &&offsets_, std::vector<uint32_t> &&targets_, std::vector<U> &&weights_):
+        vertexData(offsets_.empty() ? 0 : offsets_.size() - 1),offsets(std::move(offsets_)),targets(std::move(targets_)),weights(std::move(weights_))
+    {
+        if (offsets.empty())
+            offsets.push_back(0);
+    }
+
+    uint32_t numVertices() const noexcept
+    {
+        return vertexData.size();
+    }
+
+    size_t numEdges() const noexcept
+    {
+        return targets.size();
+    }
+
+    size_t degree(const uint32_t u) const noexcept
+    {
+        return offsets[u + 1] - offsets[u];
+    }
+
+    NeighbourRange neighbours(const uint32_t u) const
+    {
+        return {targets.data() + offsets[u],weights.data() + offsets[u],degree(u)};
+    }
+
+    const T& getValue(const uint32_t u) const
+    {
+        return vertexData[u];
+    }
+
+    bool setValue(const uint32_t u, const T val)
+    {
+        if (u>=numVertices())
+            return false;
+        vertexData[u]=val;
+        return true;
+    }
+
+    //raw arrays for algorithms that want to vectorise/partition by edge
+    const std::vector<uint64_t>& getOffsets() const noexcept {return offsets;}
+    const std::vector<uint32_t>& getTargets() const noexcept {return targets;}
+    const std::vector<U>& getWeights() const noexcept {return weights;}
+
+    void print()
+    {
+        for (uint32_t i=0;i<numVertices();++i){
+            for (uint64_t e=offsets[i];e<offsets[i+1];++e){
+                std::cout<<i<<" "<<targets[e]<<std::endl;
+            }
+        }
+    }
+};
+
+}
+
+#endif /*CSR_GRAPH_H*/
@@ -26,6 +26,9 @@ Graph structure with insertion
 #include <iostream>
 #include <utility>
 #include <vector>
+#include <tuple>
+#include <algorithm>
+#include <chrono>
 #include "graph.hpp"
 #include "random.hpp"
 
@@ -55,5 +58,58 @@ int main(/*int argc, char* argv[]*/)
 
     graph.print();
 
+    //same edges in one batch - duplicates removed, neighbours sorted
+    Graph<T,U> bulk(N);
+    size_t added = bulk.addEdges(data);
+    std::cout<<std::endl<<"addEdges: "<<added<<" of "<<data.size()<<" edges added"<<std::endl;
+    bulk.print();
+
+    //large batch with repeated edges, keeping the smallest weight
+    const uint32_t bigN = 1 << 18;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList(1 << 22);
+    for (auto & [u,v,w] : edgeList){
+        u = bigN*rnd();
+        v = (u + 1 + static_cast<uint32_t>(64*rnd())) % bigN; //local, so plenty of duplicates
+        w = 1 + 100*rnd();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Graph<T,U> oneByOne(bigN);
+    for (const auto & [u,v,w] : edgeList)
+        oneByOne.addEdge(u,v,w);
+    auto mid = std::chrono::steady_clock::now();
+    Graph<T,U> batched(bigN);
+    size_t bigAdded = batched.addEdges(edgeList);
+    auto end = std::chrono::steady_clock::now();
+
+    //deduplicate the one by one graph by hand and compare
+    bool same = (bigAdded == batched.numEdges());
+    size_t distinct = 0;
+    for (uint32_t u = 0; u < bigN; ++u){
+        std::vector<std::pair<uint32_t,U> > expected(oneByOne.neighbours(u).begin(),oneByOne.neighbours(u).end());
+        std::sort(expected.begin(),expected.end());
+        expected.erase(std::unique(expected.begin(),expected.end(),[](const auto &a, const auto &b){return a.first == b.first;}),expected.end());
+        distinct += expected.size();
+        same = same && std::equal(expected.begin(),expected.end(),batched.neighbours(u).begin(),batched.neighbours(u).end());
+    }
+    std::cout<<std::endl<<edgeList.size()<<" edges, "<<distinct<<" distinct"<<std::endl;
+    std::cout<<"addEdge one by one : "<<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"addEdges           : "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+    std::cout<<"deduplicated graphs agree: "<<same<<std::endl;
+
+    //a second batch merges into the existing lists
+    std::vector<std::tuple<uint32_t,uint32_t,U> > more(edgeList.begin(),edgeList.begin() + 1000);
+    for (auto & [u,v,w] : more)
+        w = 0; //every one improves an existing edge
+    more.emplace_back(0,bigN/2,1); //never generated above - the only new edge
+    size_t moreAdded = batched.addEdges(more);
+    bool merged = (moreAdded == 1);
+    for (const auto & [u,v,w] : more){
+        for (const auto & neighbourData : batched.neighbours(u))
+            if (neighbourData.first == v)
+                merged = merged && (neighbourData.second == w);
+    }
+    std::cout<<"second batch added "<<moreAdded<<" new edge(s), weights lowered: "<<merged<<std::endl;
+
     return 0;
 }
\ No newline at end of file
@@ -25,6 +25,21 @@ Contains:
 2) vector of lists of edge data with list at index i containing all outward edges from vertex i
     edge data comprised of a pair of outgoing vertex index, j,  and weight of edge i -> j
 
+addEdge inserts one edge and allows duplicates. addEdges inserts a whole batch of (u,v,w) or (u,v)
+edges at once:
+
+1) drop invalid edges (out of bounds, self loops) as addEdge would
+2) counting sort by u - O(|V|+|E|), one pass to count and one to scatter
+3) in parallel over vertices: sort each vertex's run by (v,w), keep the first of each v (the
+   minimum weight) and build the list in one go
+
+Vertices that already had edges are merged with the batch and deduplicated the same way, so
+every vertex touched by addEdges ends with its neighbours sorted and no repeated neighbour.
+Weights need operator<.
+
+version() changes with every edge or vertex added, so caches of data derived from the edges
+(transpose_cache.hpp) can tell when they are stale.
+
 */
 
 #ifndef GRAPH_H
@@ -34,6 +49,10 @@ Contains:
 #include <vector>
 #include <list>
 #include <type_traits>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include "parallel.hpp"
 
 namespace structures_and_algorithms::structures::graphs{
 
@@ -43,12 +62,38 @@ class Graph{
 protected:
     std::vector<T> vertexData;
     std::vector<std::list<std::pair<uint32_t,U> > > edges;
+    uint64_t modifications = 0;
 public:
 
+    uint64_t version() const noexcept
+    {
+        return modifications;
+    }
+
     uint32_t numVertices() const noexcept
     {
         return vertexData.size();
     }
+
+    size_t numEdges() const noexcept
+    {
+        size_t count = 0;
+        for (const auto &adjList : edges)
+            count += adjList.size();
+        return count;
+    }
+
+    //adjacency range of u - elements have .first (neighbour) and .second (weight)
+    //common interface with CSRGraph so algorithms can be written once for either
+    const std::list<std::pair<uint32_t,U> >& neighbours(const uint32_t u) const
+    {
+        return edges[u];
+    }
+
+    const T& getValue(const uint32_t u) const
+    {
+        return vertexData[u];
+    }
     
     bool setValue(const uint32_t u, const T val)
     {
@@ -67,6 +112,7 @@ public:
             return false;
         std::pair<uint32_t,U> entry = {v,std::forward<V>(val)};
         edges[u].push_back(std::move(entry));
+        ++modifications;
         return true;
     }
 
@@ -79,9 +125,80 @@ public:
         //if numeric type default edge weight is 1.
         if (std::is_arithmetic_v<U>) entry.second = static_cast<U>(1); 
         edges[u].push_back(std::move(entry));
+        ++modifications;
         return true;
     }
 
+    //bulk insert with deduplication - elements of range are (u,v,w) or (u,v) tuples/pairs
+    //returns the number of edges added that were not already present
+    template<typename EdgeRange>
+    size_t addEdges(const EdgeRange &range, uint32_t numThreads = parallel::defaultThreads())
+    {
+        typedef std::decay_t<decltype(*std::begin(range))> Edge;
+        constexpr bool weighted = (std::tuple_size_v<Edge> >= 3);
+        const uint32_t N = numVertices();
+        U defaultWeight = U();
+        //if numeric type default edge weight is 1.
+        if constexpr (std::is_arithmetic_v<U>) defaultWeight = static_cast<U>(1);
+        auto valid = [N](uint32_t u, uint32_t v){return (u<N)&&(v<N)&&(u!=v);};
+
+        //counting sort by source - edges of u end up in batch[runs[u], runs[u+1])
+        std::vector<size_t> runs(N + 1,0);
+        for (const auto &edge : range)
+            if (valid(std::get<0>(edge),std::get<1>(edge)))
+                ++runs[std::get<0>(edge) + 1];
+        for (uint32_t u = 0; u < N; ++u)
+            runs[u + 1] += runs[u];
+        std::vector<std::pair<uint32_t,U> > batch(runs[N]);
+        {
+            std::vector<size_t> position(runs.begin(),runs.end() - 1);
+            for (const auto &edge : range){
+                uint32_t u = std::get<0>(edge);
+                uint32_t v = std::get<1>(edge);
+                if (!valid(u,v))
+                    continue;
+                if constexpr (weighted)
+                    batch[position[u]++] = {v,std::get<2>(edge)};
+                else
+                    batch[position[u]++] = {v,defaultWeight};
+            }
+        }
+
+        //per vertex: sort by (v,w), keep the first (lightest) of each v, merge with existing edges, build list
+        auto sameTarget = [](const std::pair<uint32_t,U> &a, const std::pair<uint32_t,U> &b){return a.first == b.first;};
+        std::vector<size_t> added(std::max<uint32_t>(1,numThreads),0);
+        parallel::parallelFor(N,numThreads,[&](uint32_t t,size_t begin,size_t end){
+            std::vector<std::pair<uint32_t,U> > merged;
+            for (size_t u = begin; u < end; ++u){
+                if (runs[u] == runs[u + 1])
+                    continue;
+                auto first = batch.begin() + runs[u];
+                auto last = batch.begin() + runs[u + 1];
+                std::sort(first,last);
+                last = std::unique(first,last,sameTarget);
+                if (edges[u].empty()){
+                    edges[u].assign(first,last);
+                    added[t] += last - first;
+                    continue;
+                }
+                merged.assign(edges[u].begin(),edges[u].end());
+                std::sort(merged.begin(),merged.end());
+                merged.erase(std::unique(merged.begin(),merged.end(),sameTarget),merged.end());
+                size_t existing = merged.size();
+                merged.insert(merged.end(),first,last);
+                std::inplace_merge(merged.begin(),merged.begin() + existing,merged.end());
+                merged.erase(std::unique(merged.begin(),merged.end(),sameTarget),merged.end());
+                added[t] += merged.size() - existing;
+                edges[u].assign(merged.begin(),merged.end());
+            }
+        },4096);
+        size_t total = 0;
+        for (size_t count : added)
+            total += count;
+        ++modifications;
+        return total;
+    }
+
     bool addEdgeUndirected(const uint32_t u, const uint32_t v, const U val)
     {
         return addEdge(u,v,val) && addEdge(v,u,val);
@@ -94,12 +211,14 @@ public:
 
     void insert()
     {
+        ++modifications;
         vertexData.push_back(T());
         edges.push_back(std::list<std::pair<uint32_t,U> >());
     }
     template<typename V>
     void insert(V &&val)
     {
+        ++modifications;
         vertexData.push_back(std::forward<V>(val));
         edges.push_back(std::list<std::pair<uint32_t,U> >());
     }
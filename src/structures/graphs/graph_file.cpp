@@ -0,0 +1,182 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Binary graph files - text edge list -> CSR -> binary file -> memory mapped graph
+
+usage: graph_file [edge list file] [number of threads]
+
+With no file a random edge list is written to the temp directory first. The parse time is
+compared with the time to merely read every byte of the same file, to show the loader is
+I/O rather than parser bound.
+
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include "csr_graph.hpp"
+#include "graph_file.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::random;
+
+//hop distances from source - works on anything with numVertices() and neighbours()
+template<typename G>
+std::vector<uint32_t> hops(const G &graph, uint32_t source)
+{
+    std::vector<uint32_t> distance(graph.numVertices(),UINT32_MAX);
+    std::queue<uint32_t> queue;
+    distance[source] = 0;
+    queue.push(source);
+    while (!queue.empty()){
+        uint32_t u = queue.front();
+        queue.pop();
+        for (const auto & neighbourData : graph.neighbours(u)){
+            if (distance[neighbourData.first] == UINT32_MAX){
+                distance[neighbourData.first] = distance[u] + 1;
+                queue.push(neighbourData.first);
+            }
+        }
+    }
+    return distance;
+}
+
+auto main(int argc, char* argv[])->int
+{
+    typedef size_t T;
+    typedef uint32_t U;
+    namespace fs = std::filesystem;
+    uint32_t numThreads = (argc > 2) ? std::stoul(argv[2]) : structures_and_algorithms::parallel::defaultThreads();
+    std::string textFile;
+    bool generated = (argc < 2);
+    if (generated){
+        const uint32_t N = 1 << 18;
+        const size_t E = 4*N;
+        RndUniform rnd;
+        textFile = (fs::temp_directory_path() / "graph_file_edges.txt").string();
+        std::ofstream out(textFile);
+        out<<"# random graph "<<N<<" vertices "<<E<<" edges"<<std::endl;
+        for (size_t e = 0; e < E; ++e){
+            uint32_t u = N*rnd();
+            uint32_t v = N*rnd();
+            out<<u<<" "<<v<<" "<<static_cast<U>(1 + 99*rnd())<<"\n";
+        }
+    } else {
+        textFile = argv[1];
+    }
+    std::string binaryFile = (fs::temp_directory_path() / "graph_file_edges.bin").string();
+
+    //baseline: touch every byte of the file
+    auto start = std::chrono::steady_clock::now();
+    size_t lines = 0;
+    {
+        graph_file::Mapping text(textFile);
+        text.adviseSequential();
+        const char *p = text.data(), *end = text.data() + text.size();
+        while ((p = static_cast<const char*>(std::memchr(p,'\n',end - p)))){
+            ++lines;
+            ++p;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double scanMs = std::chrono::duration<double,std::milli>(end-start).count();
+
+    start = std::chrono::steady_clock::now();
+    CSRGraph<T,U> graph;
+    if (!readEdgeList(textFile,graph,U(1),numThreads)){
+        std::cout<<"could not parse "<<textFile<<std::endl;
+        return 1;
+    }
+    end = std::chrono::steady_clock::now();
+    double parseMs = std::chrono::duration<double,std::milli>(end-start).count();
+    std::cout<<textFile<<": "<<lines<<" lines, "<<graph.numVertices()<<" vertices, "<<graph.numEdges()<<" edges"<<std::endl;
+    std::cout<<"scan "<<scanMs<<" ms, parse with "<<numThreads<<" threads "<<parseMs<<" ms"<<std::endl;
+
+    //a single thread must produce exactly the same arrays
+    CSRGraph<T,U> serial;
+    readEdgeList(textFile,serial,U(1),1);
+    bool deterministic = (serial.getOffsets() == graph.getOffsets()) && (serial.getTargets() == graph.getTargets())
+                         && (serial.getWeights() == graph.getWeights());
+    std::cout<<"same result with 1 thread: "<<deterministic<<std::endl;
+
+    start = std::chrono::steady_clock::now();
+    bool written = writeGraphFile(binaryFile,graph);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"wrote "<<binaryFile<<" ("<<fs::file_size(binaryFile)<<" bytes) "<<written<<" in "
+             <<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+
+    start = std::chrono::steady_clock::now();
+    MappedGraph<U> mapped(binaryFile);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"mapped "<<mapped.isOpen()<<" in "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+    start = std::chrono::steady_clock::now();
+    MappedGraph<U> trusted(binaryFile,false);
+    end = std::chrono::steady_clock::now();
+    std::cout<<"mapped without validation "<<trusted.isOpen()<<" in "<<std::chrono::duration<double,std::milli>(end-start).count()<<" ms"<<std::endl;
+    MappedGraph<uint8_t> wrongType(binaryFile);
+    std::cout<<"refuses other weight type: "<<!wrongType.isOpen()<<std::endl;
+
+    //a target pointing past the last vertex, and a file cut short
+    const std::string damagedFile = binaryFile + ".damaged";
+    fs::copy_file(binaryFile,damagedFile,fs::copy_options::overwrite_existing);
+    {
+        std::fstream file(damagedFile,std::ios::binary | std::ios::in | std::ios::out);
+        const uint32_t badTarget = graph.numVertices();
+        file.seekp(graph_file::headerSize + (graph.numVertices() + 1)*sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&badTarget),sizeof(badTarget));
+    }
+    bool corruptRefused = !MappedGraph<U>(damagedFile).isOpen();
+    fs::resize_file(damagedFile,fs::file_size(damagedFile) / 2);
+    bool truncatedRefused = !MappedGraph<U>(damagedFile,false).isOpen();
+    fs::remove(damagedFile);
+    std::cout<<"refuses damaged files: "<<(corruptRefused && truncatedRefused)<<std::endl;
+
+    bool agree = (mapped.numVertices() == graph.numVertices()) && (mapped.numEdges() == graph.numEdges())
+                 && (hops(mapped,0) == hops(graph,0));
+    CSRGraph<T,U> copied = mapped.toCSR();
+    agree = agree && (copied.getTargets() == graph.getTargets()) && (copied.getWeights() == graph.getWeights());
+    std::cout<<"mapped graph agrees: "<<agree<<std::endl;
+
+    //malformed edge lists - a vertex index that would wrap |V| to 0, weights that are not a U
+    const std::string badText = (fs::temp_directory_path() / "graph_file_bad.txt").string();
+    bool malformedRefused = true;
+    for (const char *line : {"1 4294967295","1 2 abc","1 2 -5","1 2 3 4"}){
+        std::ofstream(badText)<<"0 1 1\n"<<line<<"\n";
+        CSRGraph<T,U> bad;
+        malformedRefused = malformedRefused && !readEdgeList(badText,bad);
+    }
+    std::ofstream(badText)<<"0 1 1\r\n1 2\t \r\n";
+    CSRGraph<T,U> good;
+    bool trailingSpaceAccepted = readEdgeList(badText,good) && (good.numEdges() == 2);
+    fs::remove(badText);
+    std::cout<<"refuses malformed edge lists: "<<malformedRefused<<", accepts trailing whitespace: "<<trailingSpaceAccepted<<std::endl;
+
+    fs::remove(binaryFile);
+    if (generated)
+        fs::remove(textFile);
+    return 0;
+}
@@ -0,0 +1,459 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Binary graph file format and text edge list loader
+
+Binary format - the CSR arrays written straight to disk, so a file can be memory mapped and
+traversed in place without parsing or copying:
+
+    offset 0    char[8]   "SAAGRAPH"
+    offset 8    uint32    version (1)
+    offset 12   uint32    sizeof(U) (edge weight type)
+    offset 16   uint64    |V|
+    offset 24   uint64    |E|
+    offset 32   uint64    offsets[|V|+1]
+                uint32    targets[|E|]
+                          zero padding to the next multiple of 8 bytes
+                U         weights[|E|]
+
+Every array starts at an 8 byte aligned position, so pointers into the mapping can be used
+directly. Without mmap (Windows) the file is read into an aligned buffer instead, with the same
+interface but none of the lazy loading. Integers are in native (little endian on all the usual targets) byte order.
+
+MappedGraph<U> maps such a file read only. It has the same numVertices()/neighbours() interface
+as Graph and CSRGraph. Sizes in the header are checked against the file, and by default one
+O(|V|+|E|) pass checks that offsets are monotone and end at |E| and that targets are < |V|, so a
+damaged file is refused rather than read out of bounds. For trusted files (written by this
+program) pass validate = false: pages are then loaded by the OS on first touch, so opening costs
+nothing and only the parts of the graph actually visited are read. Several processes can share
+one copy in the page cache.
+
+Text edge lists - one edge per line, "u v" or "u v w", whitespace separated; blank lines and
+lines starting with '#' or '%' (SNAP, Matrix Market headers) are skipped. |V| is the largest
+index + 1. Indices must be below 2^32 - 1 and a weight must parse as U with nothing after it
+(so "1 2 -5" fails for unsigned U), otherwise the file is rejected.
+
+readEdgeList() maps the text file and splits it into one chunk per thread, each chunk starting
+just after a newline. Threads parse their chunk with std::from_chars (no locale, no allocation,
+no istream) into local edge vectors, then:
+
+1) each thread scatters its edges into one bucket per thread by source vertex range
+2) each thread counting sorts one bucket (count out degrees, prefix sum, scatter) into its
+   disjoint slice of the CSR arrays
+
+Buckets are laid out thread by thread, so edges keep their file order within each vertex and the
+result does not depend on the number of threads. There are no atomics - a contended (or even
+uncontended) fetch_add per edge costs more than parsing the edge.
+
+Every pass is parallel, so parsing keeps up with the disk. Self loops are skipped as in CSRGraph. Functions return false on I/O or format errors.
+
+*/
+
+#ifndef GRAPH_FILE_H
+#define GRAPH_FILE_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <charconv>
+#include <fstream>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <memory>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "csr_graph.hpp"
+#include "parallel.hpp"
+
+namespace structures_and_algorithms::structures::graphs{
+
+namespace graph_file{
+    constexpr char magic[8] = {'S','A','A','G','R','A','P','H'};
+    constexpr uint32_t version = 1;
+    constexpr size_t headerSize = 32;
+
+    inline size_t alignUp(size_t bytes)
+    {
+        return (bytes + 7) & ~static_cast<size_t>(7);
+    }
+
+    //read only mapping of a whole file, unmapped on destruction
+#ifndef _WIN32
+    class Mapping{
+        void *address = nullptr;
+        size_t length = 0;
+    public:
+        Mapping(){}
+        explicit Mapping(const std::string &fileName)
+        {
+            int fd = ::open(fileName.c_str(),O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat info;
+            if ((::fstat(fd,&info) == 0) && (info.st_size > 0)){
+                void *mapped = ::mmap(nullptr,info.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+                if (mapped != MAP_FAILED){
+                    address = mapped;
+                    length = info.st_size;
+                }
+            }
+            ::close(fd); //the mapping keeps the file alive
+        }
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        Mapping(Mapping &&m) noexcept:address(m.address),length(m.length)
+        {
+            m.address = nullptr;
+            m.length = 0;
+        }
+        Mapping& operator=(Mapping &&m) noexcept
+        {
+            std::swap(address,m.address);
+            std::swap(length,m.length);
+            return *this;
+        }
+        ~Mapping()
+        {
+            if (address)
+                ::munmap(address,length);
+        }
+        const char* data() const noexcept {return static_cast<const char*>(address);}
+        size_t size() const noexcept {return length;}
+        bool isOpen() const noexcept {return address != nullptr;}
+        //hint that the whole file will be read front to back
+        void adviseSequential() const
+        {
+            if (address)
+                ::madvise(address,length,MADV_SEQUENTIAL);
+        }
+    };
+#else
+    //no mmap - the whole file is read into an 8 byte aligned buffer instead
+    class Mapping{
+        std::unique_ptr<uint64_t[]> buffer;
+        size_t length = 0;
+    public:
+        Mapping(){}
+        explicit Mapping(const std::string &fileName)
+        {
+            std::ifstream file(fileName,std::ios::binary | std::ios::ate);
+            if (!file)
+                return;
+            std::streamoff fileSize = file.tellg();
+            if (fileSize <= 0)
+                return;
+            std::unique_ptr<uint64_t[]> contents(new uint64_t[(static_cast<size_t>(fileSize) + 7) / 8]);
+            file.seekg(0);
+            if (!file.read(reinterpret_cast<char*>(contents.get()),fileSize))
+                return;
+            buffer = std::move(contents);
+            length = static_cast<size_t>(fileSize);
+        }
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+        Mapping(Mapping &&m) noexcept:buffer(std::move(m.buffer)),length(m.length)
+        {
+            m.length = 0;
+        }
+        Mapping& operator=(Mapping &&m) noexcept
+        {
+            std::swap(buffer,m.buffer);
+            std::swap(length,m.length);
+            return *this;
+        }
+        const char* data() const noexcept {return reinterpret_cast<const char*>(buffer.get());}
+        size_t size() const noexcept {return length;}
+        bool isOpen() const noexcept {return buffer != nullptr;}
+        void adviseSequential() const {}
+    };
+#endif
+}
+
+template<typename T,typename U>
+bool writeGraphFile(const std::string &fileName, const CSRGraph<T,U> &graph)
+{
+    static_assert(std::is_trivially_copyable_v<U>,"edge weights must be trivially copyable to be written in binary");
+    std::ofstream file(fileName,std::ios::binary);
+    if (!file)
+        return false;
+    const uint32_t weightSize = sizeof(U);
+    const uint64_t N = graph.numVertices();
+    const uint64_t E = graph.numEdges();
+    file.write(graph_file::magic,8);
+    file.write(reinterpret_cast<const char*>(&graph_file::version),sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&weightSize),sizeof(weightSize));
+    file.write(reinterpret_cast<const char*>(&N),sizeof(N));
+    file.write(reinterpret_cast<const char*>(&E),sizeof(E));
+    file.write(reinterpret_cast<const char*>(graph.getOffsets().data()),(N + 1)*sizeof(uint64_t));
+    file.write(reinterpret_cast<const char*>(graph.getTargets().data()),E*sizeof(uint32_t));
+    const char padding[8] = {};
+    file.write(padding,graph_file::alignUp(E*sizeof(uint32_t)) - E*sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(graph.getWeights().data()),E*sizeof(U));
+    return static_cast<bool>(file);
+}
+
+template<typename U = uint8_t> //U edge weights
+class MappedGraph{
+    graph_file::Mapping mapping;
+    uint32_t N = 0;
+    uint64_t E = 0;
+    const uint64_t *offsets = nullptr;
+    const uint32_t *targets = nullptr;
+    const U *weights = nullptr;
+
+public:
+    typedef typename CSRGraph<size_t,U>::NeighbourRange NeighbourRange;
+
+    MappedGraph(){}
+
+    //check isOpen() - false if the file is missing, truncated, not of this weight type or (with validate)
+    //has offsets or targets that would index outside the arrays
+    explicit MappedGraph(const std::string &fileName, const bool validate = true):mapping(fileName)
+    {
+        if ((!mapping.isOpen()) || (mapping.size() < graph_file::headerSize))
+            return;
+        const char *data = mapping.data();
+        uint32_t version, weightSize;
+        uint64_t numVertices, numEdges;
+        std::memcpy(&version,data + 8,sizeof(version));
+        std::memcpy(&weightSize,data + 12,sizeof(weightSize));
+        std::memcpy(&numVertices,data + 16,sizeof(numVertices));
+        std::memcpy(&numEdges,data + 24,sizeof(numEdges));
+        //|V| < 2^32 and |E| bounded by the file size, so none of the sizes below can overflow
+        if ((std::memcmp(data,graph_file::magic,8) != 0) || (version != graph_file::version) || (weightSize != sizeof(U))
+            || (numVertices > UINT32_MAX) || (numEdges > mapping.size() / (sizeof(uint32_t) + sizeof(U)))){
+            mapping = graph_file::Mapping();
+            return;
+        }
+        size_t targetsStart = graph_file::headerSize + (numVertices + 1)*sizeof(uint64_t);
+        size_t weightsStart = targetsStart + graph_file::alignUp(numEdges*sizeof(uint32_t));
+        if (mapping.size() < weightsStart + numEdges*sizeof(U)){
+            mapping = graph_file::Mapping();
+            return;
+        }
+        N = numVertices;
+        E = numEdges;
+        offsets = reinterpret_cast<const uint64_t*>(data + graph_file::headerSize);
+        targets = reinterpret_cast<const uint32_t*>(data + targetsStart);
+        weights = reinterpret_cast<const U*>(data + weightsStart);
+        if (validate && (!wellFormed())){
+            *this = MappedGraph();
+            return;
+        }
+    }
+
+    //O(|V|+|E|) - offsets start at 0, never decrease and end at |E|; every target is a vertex
+    bool wellFormed() const noexcept
+    {
+        if ((offsets[0] != 0) || (offsets[N] != E))
+            return false;
+        for (uint32_t u = 0; u < N; ++u)
+            if (offsets[u] > offsets[u + 1])
+                return false;
+        for (uint64_t e = 0; e < E; ++e)
+            if (targets[e] >= N)
+                return false;
+        return true;
+    }
+
+    bool isOpen() const noexcept
+    {
+        return mapping.isOpen();
+    }
+
+    uint32_t numVertices() const noexcept
+    {
+        return N;
+    }
+
+    size_t numEdges() const noexcept
+    {
+        return E;
+    }
+
+    size_t degree(const uint32_t u) const noexcept
+    {
+        return offsets[u + 1] - offsets[u];
+    }
+
+    NeighbourRange neighbours(const uint32_t u) const
+    {
+        return {targets + offsets[u],weights + offsets[u],degree(u)};
+    }
+
+    //copy into memory, e.g. to modify vertex values
+    template<typename T = size_t>
+    CSRGraph<T,U> toCSR() const
+    {
+        return CSRGraph<T,U>(std::vector<uint64_t>(offsets,offsets + N + 1),std::vector<uint32_t>(targets,targets + E),
+                             std::vector<U>(weights,weights + E));
+    }
+};
+
+//parse a text edge list into a CSR graph - edges without a weight get defaultWeight
+template<typename T,typename U>
+bool readEdgeList(const std::string &fileName, CSRGraph<T,U> &graph, const U defaultWeight = U(1),
+                  uint32_t numThreads = parallel::defaultThreads())
+{
+    graph_file::Mapping text(fileName);
+    if (!text.isOpen())
+        return false;
+    text.adviseSequential();
+    const char *data = text.data();
+    const size_t size = text.size();
+    numThreads = std::max<uint32_t>(1,std::min<size_t>(numThreads,size / (1 << 16) + 1));
+
+    //parse - chunk t owns every line starting in [t*size/numThreads, (t+1)*size/numThreads)
+    std::vector<std::vector<std::tuple<uint32_t,uint32_t,U> > > localEdges(numThreads);
+    std::vector<uint32_t> localMax(numThreads,0);
+    std::vector<char> localOk(numThreads,1);
+    parallel::parallelFor(numThreads,numThreads,[&](uint32_t,size_t tBegin,size_t tEnd){
+        for (size_t t = tBegin; t < tEnd; ++t){
+            const char *p = data + size*t/numThreads;
+            const char *end = data + size*(t + 1)/numThreads;
+            if ((t > 0) && (p[-1] != '\n')){ //partial line belongs to the previous chunk
+                p = static_cast<const char*>(std::memchr(p,'\n',data + size - p));
+                p = p ? p + 1 : data + size;
+            }
+            auto &edges = localEdges[t];
+            edges.reserve((end - p) / 8);
+            while (p < end){
+                const char *lineEnd = static_cast<const char*>(std::memchr(p,'\n',data + size - p));
+                if (!lineEnd)
+                    lineEnd = data + size;
+                while ((p < lineEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+                    ++p;
+                if ((p < lineEnd) && (*p != '#') && (*p != '%')){
+                    uint32_t u, v;
+                    U w = defaultWeight;
+                    auto r = std::from_chars(p,lineEnd,u);
+                    p = r.ptr;
+                    while ((p < lineEnd) && ((*p == ' ') || (*p == '\t') || (*p == ',')))
+                        ++p;
+                    auto r2 = std::from_chars(p,lineEnd,v);
+                    p = r2.ptr;
+                    //UINT32_MAX is no vertex - |V| = largest index + 1 would wrap to 0
+                    if ((r.ec != std::errc()) || (r2.ec != std::errc()) || (u == UINT32_MAX) || (v == UINT32_MAX)){
+                        localOk[t] = 0;
+                        return;
+                    }
+                    while ((p < lineEnd) && ((*p == ' ') || (*p == '\t') || (*p == ',')))
+                        ++p;
+                    if ((p < lineEnd) && (*p != '\r')){
+                        auto r3 = std::from_chars(p,lineEnd,w);
+                        p = r3.ptr;
+                        while ((p < lineEnd) && ((*p == ' ') || (*p == '\t') || (*p == '\r')))
+                            ++p;
+                        if ((r3.ec != std::errc()) || (p != lineEnd)){ //not a weight of type U, or more after it
+                            localOk[t] = 0;
+                            return;
+                        }
+                    }
+                    localMax[t] = std::max({localMax[t],u,v});
+                    if (u != v)
+                        edges.emplace_back(u,v,w);
+                }
+                p = lineEnd + 1;
+            }
+        }
+    },1);
+    if (std::find(localOk.begin(),localOk.end(),0) != localOk.end())
+        return false;
+    size_t numEdges = 0;
+    for (const auto &edges : localEdges)
+        numEdges += edges.size();
+    const uint32_t N = numEdges ? *std::max_element(localMax.begin(),localMax.end()) + 1 : 0;
+
+    //1) bucket edges by source range
+    auto bucketOf = [N,numThreads](uint32_t u){return static_cast<uint32_t>(static_cast<uint64_t>(u)*numThreads/N);};
+    std::vector<std::vector<size_t> > position(numThreads,std::vector<size_t>(numThreads,0)); //[thread][bucket]
+    parallel::parallelFor(numThreads,numThreads,[&](uint32_t,size_t tBegin,size_t tEnd){
+        for (size_t t = tBegin; t < tEnd; ++t)
+            for (const auto &edge : localEdges[t])
+                ++position[t][bucketOf(std::get<0>(edge))];
+    },1);
+    std::vector<size_t> bucketStart(numThreads + 1,0);
+    size_t total = 0;
+    for (uint32_t b = 0; b < numThreads; ++b){ //bucket major, thread minor - keeps file order
+        bucketStart[b] = total;
+        for (uint32_t t = 0; t < numThreads; ++t){
+            size_t count = position[t][b];
+            position[t][b] = total;
+            total += count;
+        }
+    }
+    bucketStart[numThreads] = total;
+    std::vector<std::tuple<uint32_t,uint32_t,U> > bucketed(numEdges);
+    parallel::parallelFor(numThreads,numThreads,[&](uint32_t,size_t tBegin,size_t tEnd){
+        for (size_t t = tBegin; t < tEnd; ++t){
+            for (const auto &edge : localEdges[t])
+                bucketed[position[t][bucketOf(std::get<0>(edge))]++] = edge;
+            std::vector<std::tuple<uint32_t,uint32_t,U> >().swap(localEdges[t]);
+        }
+    },1);
+
+    //2) counting sort each bucket into place - buckets are disjoint vertex ranges, no atomics needed
+    std::vector<uint64_t> offsets(N + 1,0);
+    std::vector<uint32_t> targets(numEdges);
+    std::vector<U> weights(numEdges);
+    parallel::parallelFor(numThreads,numThreads,[&](uint32_t,size_t bBegin,size_t bEnd){
+        for (size_t b = bBegin; b < bEnd; ++b){
+            //bucketOf(u) == b exactly for u in [ceil(N*b/numThreads), ceil(N*(b+1)/numThreads))
+            uint32_t lo = (static_cast<uint64_t>(N)*b + numThreads - 1)/numThreads;
+            uint32_t hi = (static_cast<uint64_t>(N)*(b + 1) + numThreads - 1)/numThreads;
+            std::vector<uint64_t> cursor(hi - lo + 1,0);
+            for (size_t e = bucketStart[b]; e < bucketStart[b + 1]; ++e)
+                ++cursor[std::get<0>(bucketed[e]) - lo + 1];
+            cursor[0] = bucketStart[b];
+            for (uint32_t u = lo; u < hi; ++u){
+                cursor[u - lo + 1] += cursor[u - lo];
+                offsets[u] = cursor[u - lo];
+            }
+            for (size_t e = bucketStart[b]; e < bucketStart[b + 1]; ++e){
+                uint64_t &place = cursor[std::get<0>(bucketed[e]) - lo];
+                targets[place] = std::get<1>(bucketed[e]);
+                weights[place] = std::get<2>(bucketed[e]);
+                ++place;
+            }
+        }
+    },1);
+    offsets[N] = numEdges;
+    graph = CSRGraph<T,U>(std::move(offsets),std::move(targets),std::move(weights));
+    return true;
+}
+
+//text edge list straight to the binary format
+template<typename U>
+bool convertEdgeList(const std::string &textFile, const std::string &graphFile, const U defaultWeight = U(1),
+                     uint32_t numThreads = parallel::defaultThreads())
+{
+    CSRGraph<size_t,U> graph;
+    return readEdgeList(textFile,graph,defaultWeight,numThreads) && writeGraphFile(graphFile,graph);
+}
+
+}
+
+#endif /*GRAPH_FILE_H*/
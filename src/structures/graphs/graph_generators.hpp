@@ -0,0 +1,219 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Seeded synthetic graph generators
+
+All return undirected graphs as edge lists (u,v,w) with every edge in both directions, ready
+for CSRGraph(N,edgeList) or Graph::addEdges. Weights are uniform in [1,maxWeight]. The same
+seed always gives the same graph, whatever the number of threads - edges are generated in
+fixed size blocks, each with its own generator seeded from (seed, block).
+
+rmat - R-MAT / Kronecker (Chakrabarti et al., Graph500 parameters a,b,c = 0.57,0.19,0.19):
+each edge picks one quadrant of the adjacency matrix per bit of the vertex number, giving a
+skewed, power law like degree distribution with small diameter. 2^scale vertices,
+edgeFactor * 2^scale edges. Vertex numbers are shuffled afterwards, as in the GAP suite, so
+the hubs are not all at low numbers.
+
+grid - rows x cols 4-neighbour lattice, each edge kept with probability keep: a road network
+stand-in (bounded degree, diameter ~ sqrt(V)).
+
+erdosRenyi - G(n,m): m edges with uniformly random ends. Degrees are Poisson.
+
+barabasiAlbert - preferential attachment: each new vertex joins m existing ones chosen with
+probability proportional to degree (by picking a random end of a random existing edge).
+Sequential by nature.
+
+Self loops may appear (CSRGraph and Graph skip them), as may repeated edges for rmat and
+erdosRenyi.
+
+*/
+
+#ifndef GRAPH_GENERATORS_H
+#define GRAPH_GENERATORS_H
+
+#include <vector>
+#include <tuple>
+#include <numeric>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include "random.hpp"
+#include "parallel.hpp"
+
+namespace structures_and_algorithms::structures::graphs::generators{
+
+template<typename U>
+using EdgeList = std::vector<std::tuple<uint32_t,uint32_t,U> >;
+
+namespace detail{
+    constexpr size_t blockSize = 1 << 16; //edges per independently seeded block
+
+    inline int32_t blockSeed(const uint32_t seed, const size_t block)
+    {
+        uint64_t x = (static_cast<uint64_t>(seed) << 32) ^ block; //splitmix64 finaliser
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return static_cast<int32_t>(x);
+    }
+
+    template<typename U>
+    U weight(random::RndUniform<> &rnd, const U maxWeight)
+    {
+        return static_cast<U>(1 + static_cast<uint64_t>(maxWeight*rnd()) % static_cast<uint64_t>(maxWeight));
+    }
+
+    //numEdges undirected edges, edge(rnd) -> (u,v), filled block by block in parallel
+    template<typename U, typename MakeEdge>
+    EdgeList<U> generate(const size_t numEdges, const uint32_t seed, const U maxWeight, const uint32_t numThreads, MakeEdge &&makeEdge)
+    {
+        EdgeList<U> edges(2*numEdges);
+        const size_t numBlocks = (numEdges + blockSize - 1) / blockSize;
+        parallel::parallelFor(numBlocks,numThreads,[&](uint32_t,size_t begin,size_t end){
+            for (size_t block = begin; block < end; ++block){
+                random::RndUniform<> rnd(blockSeed(seed,block));
+                for (size_t e = block*blockSize; e < std::min(numEdges,(block + 1)*blockSize); ++e){
+                    auto [u,v] = makeEdge(rnd);
+                    U w = weight(rnd,maxWeight);
+                    edges[2*e] = {u,v,w};
+                    edges[2*e + 1] = {v,u,w};
+                }
+            }
+        },1);
+        return edges;
+    }
+}
+
+template<typename U = uint32_t>
+EdgeList<U> rmat(const uint32_t scale, const uint32_t edgeFactor, const uint32_t seed, const U maxWeight = 1,
+                 const uint32_t numThreads = parallel::defaultThreads(), const double a = 0.57, const double b = 0.19, const double c = 0.19)
+{
+    const uint32_t N = 1u << scale;
+    EdgeList<U> edges = detail::generate<U>(static_cast<size_t>(edgeFactor) << scale,seed,maxWeight,numThreads,[&](random::RndUniform<> &rnd){
+        uint32_t u = 0, v = 0;
+        for (uint32_t bit = 0; bit < scale; ++bit){
+            double r = rnd();
+            u |= static_cast<uint32_t>(r >= a + b) << bit;                       //quadrants c,d
+            v |= static_cast<uint32_t>(((r >= a) && (r < a + b)) || (r >= a + b + c)) << bit; //quadrants b,d
+        }
+        return std::make_pair(u,v);
+    });
+    //shuffle vertex numbers
+    std::vector<uint32_t> permutation(N);
+    std::iota(permutation.begin(),permutation.end(),0);
+    std::shuffle(permutation.begin(),permutation.end(),std::mt19937_64(seed));
+    parallel::parallelFor(edges.size(),numThreads,[&](uint32_t,size_t begin,size_t end){
+        for (size_t e = begin; e < end; ++e){
+            std::get<0>(edges[e]) = permutation[std::get<0>(edges[e])];
+            std::get<1>(edges[e]) = permutation[std::get<1>(edges[e])];
+        }
+    });
+    return edges;
+}
+
+template<typename U = uint32_t>
+EdgeList<U> grid(const uint32_t rows, const uint32_t cols, const uint32_t seed, const U maxWeight = 1, const double keep = 1.0,
+                 const uint32_t numThreads = parallel::defaultThreads())
+{
+    //edge e < rows*cols: right of vertex e, otherwise down of vertex e - rows*cols
+    const size_t N = static_cast<size_t>(rows)*cols;
+    EdgeList<U> edges = detail::generate<U>(2*N,seed,maxWeight,numThreads,[&](random::RndUniform<>&){return std::make_pair(0u,0u);});
+    const size_t numBlocks = (2*N + detail::blockSize - 1) / detail::blockSize;
+    std::vector<size_t> kept(numBlocks,0);
+    parallel::parallelFor(numBlocks,numThreads,[&](uint32_t,size_t begin,size_t end){
+        for (size_t block = begin; block < end; ++block){
+            random::RndUniform<> rnd(detail::blockSeed(~seed,block));
+            size_t out = block*detail::blockSize;
+            for (size_t e = block*detail::blockSize; e < std::min(2*N,(block + 1)*detail::blockSize); ++e){
+                size_t u = (e < N) ? e : e - N;
+                size_t r = u / cols, c = u % cols;
+                bool right = (e < N);
+                if ((right && (c + 1 == cols)) || (!right && (r + 1 == rows)) || (rnd() >= keep))
+                    continue;
+                uint32_t v = right ? u + 1 : u + cols;
+                U w = std::get<2>(edges[2*e]);
+                edges[2*out] = {static_cast<uint32_t>(u),v,w};
+                edges[2*out + 1] = {v,static_cast<uint32_t>(u),w};
+                ++out;
+            }
+            kept[block] = out - block*detail::blockSize;
+        }
+    },1);
+    //close the gaps left by dropped edges
+    size_t size = 0;
+    for (size_t block = 0; block < numBlocks; ++block){
+        size_t from = 2*block*detail::blockSize;
+        std::move(edges.begin() + from,edges.begin() + from + 2*kept[block],edges.begin() + size);
+        size += 2*kept[block];
+    }
+    edges.resize(size);
+    return edges;
+}
+
+template<typename U = uint32_t>
+EdgeList<U> erdosRenyi(const uint32_t N, const size_t numEdges, const uint32_t seed, const U maxWeight = 1,
+                       const uint32_t numThreads = parallel::defaultThreads())
+{
+    return detail::generate<U>(numEdges,seed,maxWeight,numThreads,[&](random::RndUniform<> &rnd){
+        uint32_t u = static_cast<uint32_t>(N*rnd()) % N, v = static_cast<uint32_t>(N*rnd()) % N;
+        return std::make_pair(u,v);
+    });
+}
+
+template<typename U = uint32_t>
+EdgeList<U> barabasiAlbert(const uint32_t N, const uint32_t m, const uint32_t seed, const U maxWeight = 1)
+{
+    random::RndUniform<> rnd(detail::blockSeed(seed,0));
+    EdgeList<U> edges;
+    if (N <= m)
+        return edges;
+    edges.reserve(2*static_cast<size_t>(m)*N);
+    std::vector<uint32_t> ends; //every edge end so far - a uniform pick is degree proportional
+    ends.reserve(2*static_cast<size_t>(m)*N);
+    auto add = [&](const uint32_t u, const uint32_t v){
+        U w = detail::weight(rnd,maxWeight);
+        edges.emplace_back(u,v,w);
+        edges.emplace_back(v,u,w);
+        ends.push_back(u);
+        ends.push_back(v);
+    };
+    for (uint32_t u = 0; u <= m; ++u) //start from a clique on m+1 vertices
+        for (uint32_t v = u + 1; v <= m; ++v)
+            add(u,v);
+    std::vector<uint32_t> targets;
+    for (uint32_t u = m + 1; u < N; ++u){
+        targets.clear();
+        while (targets.size() < m){
+            uint32_t v = ends[static_cast<size_t>(ends.size()*rnd()) % ends.size()];
+            if (std::find(targets.begin(),targets.end(),v) == targets.end())
+                targets.push_back(v);
+        }
+        for (uint32_t v : targets)
+            add(u,v);
+    }
+    return edges;
+}
+
+}
+
+#endif /*GRAPH_GENERATORS_H*/
@@ -0,0 +1,101 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Lazily built transpose (incoming edges) of a graph, as a CSRGraph
+
+For algorithms that sometimes need incoming edges (bottom-up BFS steps, backward searches)
+and keep them alongside the graph. get(graph) builds the transpose on first use and returns it:
+
+- thread safe - the build happens under a mutex, so concurrent const calls on one graph
+  (e.g. several bfs() at once) build it once and share it
+- never stale - if the graph has version() (Graph does, bumped by addEdge, addEdges, insert)
+  the transpose is rebuilt when the version has moved on. Graphs without version() (CSRGraph,
+  CompressedGraph, MappedGraph) cannot change, so are built once
+- returned as shared_ptr, so a caller still using an old transpose keeps it alive across a rebuild
+
+Copying gives an empty cache - the copy belongs to a different graph.
+
+*/
+
+#ifndef TRANSPOSE_CACHE_H
+#define TRANSPOSE_CACHE_H
+
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include "csr_graph.hpp"
+
+namespace structures_and_algorithms::structures::graphs{
+
+template<typename T,typename U>
+class TransposeCache{
+    mutable std::mutex mutex;
+    mutable std::shared_ptr<const CSRGraph<T,U> > transpose;
+    mutable uint64_t builtVersion = 0;
+
+    template<typename G, typename = void>
+    struct HasVersion : std::false_type {};
+    template<typename G>
+    struct HasVersion<G,std::void_t<decltype(std::declval<const G&>().version())> > : std::true_type {};
+
+    template<typename G>
+    static uint64_t versionOf(const G &graph)
+    {
+        if constexpr (HasVersion<G>::value)
+            return graph.version();
+        else
+            return 0;
+    }
+
+public:
+    TransposeCache(){}
+    TransposeCache(const TransposeCache&){}
+    TransposeCache& operator=(const TransposeCache&)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        transpose.reset();
+        return *this;
+    }
+
+    //incoming edges of graph: neighbours(v) of the result are the u with an edge u -> v
+    template<typename G>
+    std::shared_ptr<const CSRGraph<T,U> > get(const G &graph) const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const uint64_t version = versionOf(graph);
+        if ((!transpose) || (builtVersion != version)){
+            std::vector<std::tuple<uint32_t,uint32_t,U> > reversed;
+            reversed.reserve(graph.numEdges());
+            for (uint32_t u = 0; u < graph.numVertices(); ++u)
+                for (const auto & neighbourData : graph.neighbours(u))
+                    reversed.emplace_back(neighbourData.first,u,neighbourData.second);
+            transpose = std::make_shared<const CSRGraph<T,U> >(graph.numVertices(),reversed);
+            builtVersion = version;
+        }
+        return transpose;
+    }
+};
+
+}
+
+#endif /*TRANSPOSE_CACHE_H*/
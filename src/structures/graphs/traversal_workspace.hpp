@@ -0,0 +1,144 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Reusable per query state for graph searches
+
+A search normally starts with std::vector<bool> visited(N,false) - an O(V) allocation and fill
+per query, even when the query itself only touches a few hundred vertices. For many back to
+back queries keep the arrays and "clear" them in O(1) instead:
+
+VisitedSet - one uint32 stamp per vertex plus a current generation. v is visited when
+stamp[v] == generation, so reset() is ++generation. Only when the counter wraps (every 2^32
+resets) are the stamps actually zeroed.
+
+SearchWorkspace - a VisitedSet plus a scratch vector for the BFS queue / DFS stack, whose
+capacity is kept between queries.
+
+PathWorkspace<U> - also tentative distances and previous vertices, valid only for vertices
+labelled in the current generation (unlabelled ones read as infinity / -1), so they need no
+fill either.
+
+After the first query at a given |V|, further queries allocate nothing. A workspace is
+per thread state - use one per thread for concurrent queries.
+
+*/
+
+#ifndef TRAVERSAL_WORKSPACE_H
+#define TRAVERSAL_WORKSPACE_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+namespace structures_and_algorithms::structures::graphs{
+
+class VisitedSet{
+    std::vector<uint32_t> stamp;
+    uint32_t generation = 0;
+public:
+    VisitedSet(){}
+    VisitedSet(const uint32_t N){reset(N);}
+
+    //forget all visits - O(1) unless the vertex count changed or the generation wrapped
+    void reset(const uint32_t N)
+    {
+        if (stamp.size() != N){
+            stamp.assign(N,0);
+            generation = 0;
+        }
+        if (++generation == 0){
+            std::fill(stamp.begin(),stamp.end(),0);
+            generation = 1;
+        }
+    }
+
+    bool contains(const uint32_t v) const noexcept
+    {
+        return stamp[v] == generation;
+    }
+
+    //true if v was not yet visited
+    bool insert(const uint32_t v) noexcept
+    {
+        if (stamp[v] == generation)
+            return false;
+        stamp[v] = generation;
+        return true;
+    }
+
+    size_t numVertices() const noexcept
+    {
+        return stamp.size();
+    }
+};
+
+struct SearchWorkspace{
+    VisitedSet visited;
+    std::vector<uint32_t> frontier; //queue or stack of the search
+
+    void reset(const uint32_t N)
+    {
+        visited.reset(N);
+        frontier.clear();
+    }
+};
+
+template<typename U>
+class PathWorkspace : public SearchWorkspace{
+    VisitedSet labelled;
+    std::vector<U> distances;
+    std::vector<int32_t> previous;
+    U infinity;
+public:
+    PathWorkspace(const U infinity_ = std::numeric_limits<U>::max()):infinity(infinity_){}
+
+    void reset(const uint32_t N)
+    {
+        SearchWorkspace::reset(N);
+        labelled.reset(N);
+        if (distances.size() != N){
+            distances.resize(N);
+            previous.resize(N);
+        }
+    }
+
+    U distance(const uint32_t v) const noexcept
+    {
+        return labelled.contains(v) ? distances[v] : infinity;
+    }
+
+    int32_t previousVertex(const uint32_t v) const noexcept
+    {
+        return labelled.contains(v) ? previous[v] : -1;
+    }
+
+    void label(const uint32_t v, const U distance_, const int32_t previous_) noexcept
+    {
+        labelled.insert(v);
+        distances[v] = distance_;
+        previous[v] = previous_;
+    }
+};
+
+}
+
+#endif /*TRAVERSAL_WORKSPACE_H*/
@@ -0,0 +1,182 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Vertex reordering - BFS and Dijkstra on a randomly numbered grid, before and after renumbering
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <queue>
+#include <tuple>
+#include <limits>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <numeric>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "vertex_order.hpp"
+#include "heap.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::graphs;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+
+//hop distances from source - works on anything with numVertices() and neighbours()
+template<typename G>
+std::vector<uint32_t> hops(const G &graph, uint32_t source)
+{
+    std::vector<uint32_t> distance(graph.numVertices(),UINT32_MAX);
+    std::queue<uint32_t> queue;
+    distance[source] = 0;
+    queue.push(source);
+    while (!queue.empty()){
+        uint32_t u = queue.front();
+        queue.pop();
+        for (const auto & neighbourData : graph.neighbours(u)){
+            if (distance[neighbourData.first] == UINT32_MAX){
+                distance[neighbourData.first] = distance[u] + 1;
+                queue.push(neighbourData.first);
+            }
+        }
+    }
+    return distance;
+}
+
+template<typename G,typename U>
+std::vector<U> dijkstra(const G &graph, uint32_t source)
+{
+    struct Entry{
+        uint32_t vertex;
+        U weight;
+        bool operator< (const Entry& A) const { return this->weight < A.weight;};
+        bool operator> (const Entry& A) const { return this->weight > A.weight;};
+    };
+    std::vector<U> distances(graph.numVertices(),std::numeric_limits<U>::max());
+    distances[source] = 0;
+    Heap<Entry> heap;
+    heap.insert(Entry{source,0});
+    while (!heap.isEmpty()){
+        Entry current = heap.getRoot();
+        heap.removeRoot();
+        if (current.weight > distances[current.vertex])
+            continue;
+        for (const auto & neighbourData : graph.neighbours(current.vertex)){
+            U newDist = current.weight + neighbourData.second;
+            if (newDist < distances[neighbourData.first]){
+                distances[neighbourData.first] = newDist;
+                heap.insert(Entry{neighbourData.first,newDist});
+            }
+        }
+    }
+    return distances;
+}
+
+template<typename T,typename U>
+void timeOrder(const std::string &name, const Graph<T,U> &graph, const std::vector<uint32_t> &newId,
+               const std::vector<uint32_t> &expectedHops, const std::vector<U> &expectedDistances, double orderMs)
+{
+    Graph<T,U> relabelled = relabel(graph,newId);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> h = hops(relabelled,newId[0]);
+    auto mid = std::chrono::steady_clock::now();
+    std::vector<U> d = dijkstra<Graph<T,U>,U>(relabelled,newId[0]);
+    auto end = std::chrono::steady_clock::now();
+    bool agree = true;
+    for (uint32_t u = 0; u < graph.numVertices(); ++u) //map back to the original numbering
+        agree = agree && (h[newId[u]] == expectedHops[u]) && (d[newId[u]] == expectedDistances[u]);
+    std::cout<<name<<" ordering "<<orderMs<<" ms, BFS "<<std::chrono::duration<double,std::milli>(mid-start).count()
+             <<" ms, Dijkstra "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms, agrees: "<<agree<<std::endl;
+}
+
+auto main(/*int argc, char* argv[]*/)->int
+{
+    typedef size_t T;
+    typedef uint32_t U;
+    RndUniform rnd;
+
+    //grid with its vertices numbered at random, as loaded from an arbitrary edge list
+    const uint32_t side = 512;
+    const uint32_t N = side*side;
+    std::vector<uint32_t> label(N);
+    std::iota(label.begin(),label.end(),0);
+    for (uint32_t i = N - 1; i > 0; --i)
+        std::swap(label[i],label[static_cast<uint32_t>((i + 1)*rnd()) % (i + 1)]);
+    std::vector<std::tuple<uint32_t,uint32_t,U> > edgeList;
+    for (uint32_t r = 0; r < side; ++r){
+        for (uint32_t c = 0; c < side; ++c){
+            uint32_t u = label[r*side + c];
+            if (c + 1 < side){
+                U w = 1 + 99*rnd();
+                edgeList.emplace_back(u,label[r*side + c + 1],w);
+                edgeList.emplace_back(label[r*side + c + 1],u,w);
+            }
+            if (r + 1 < side){
+                U w = 1 + 99*rnd();
+                edgeList.emplace_back(u,label[(r + 1)*side + c],w);
+                edgeList.emplace_back(label[(r + 1)*side + c],u,w);
+            }
+        }
+    }
+    //insert in random order so list nodes are scattered in memory as well
+    for (size_t i = edgeList.size() - 1; i > 0; --i)
+        std::swap(edgeList[i],edgeList[static_cast<size_t>((i + 1)*rnd()) % (i + 1)]);
+    Graph<T,U> graph(N);
+    for (const auto & [u,v,w] : edgeList)
+        graph.addEdge(u,v,w);
+    std::cout<<N<<" vertex grid, "<<graph.numEdges()<<" edges, random numbering"<<std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> expectedHops = hops(graph,0);
+    auto mid = std::chrono::steady_clock::now();
+    std::vector<U> expectedDistances = dijkstra<Graph<T,U>,U>(graph,0);
+    auto end = std::chrono::steady_clock::now();
+    std::cout<<"original          BFS "<<std::chrono::duration<double,std::milli>(mid-start).count()
+             <<" ms, Dijkstra "<<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+
+    std::vector<uint32_t> identity(N);
+    std::iota(identity.begin(),identity.end(),0);
+    timeOrder("identity (rebuilt)",graph,identity,expectedHops,expectedDistances,0);
+
+    using order = std::function<std::vector<uint32_t>(const Graph<T,U>&)>;
+    for (const auto & [name,fn] : {std::pair<std::string,order>{"reverse Cuthill-McKee",reverseCuthillMcKee<Graph<T,U> >},
+                                   std::pair<std::string,order>{"degree sort",degreeSortOrder<Graph<T,U> >},
+                                   std::pair<std::string,order>{"Gorder",[](const Graph<T,U> &g){return gorderOrder(g);}}}){
+        start = std::chrono::steady_clock::now();
+        std::vector<uint32_t> newId = fn(graph);
+        end = std::chrono::steady_clock::now();
+        timeOrder(name,graph,newId,expectedHops,expectedDistances,std::chrono::duration<double,std::milli>(end-start).count());
+    }
+
+    //CSR relabelling keeps the same adjacency
+    CSRGraph<T,U> csr(graph);
+    std::vector<uint32_t> newId = reverseCuthillMcKee(csr);
+    CSRGraph<T,U> csrRelabelled = relabel(csr,newId);
+    std::vector<uint32_t> h = hops(csrRelabelled,newId[0]);
+    bool agree = true;
+    for (uint32_t u = 0; u < N; ++u)
+        agree = agree && (h[newId[u]] == expectedHops[u]);
+    std::cout<<"relabelled CSR graph agrees: "<<agree<<std::endl;
+
+    return 0;
+}
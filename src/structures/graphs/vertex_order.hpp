@@ -0,0 +1,296 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Vertex reordering for traversal locality
+
+Traversals index per vertex arrays (visited, distances, previous) by vertex number. With an
+arbitrary numbering the neighbours of a vertex are scattered through those arrays and nearly
+every edge is a cache miss. Renumbering so that vertices visited together have nearby numbers
+turns many of those misses into hits.
+
+Each function returns a permutation newId, with newId[old vertex] = new vertex.
+
+1) reverseCuthillMcKee - BFS from a low degree (peripheral) vertex of each component, visiting
+   neighbours in increasing degree order, then reversed. Neighbours end up with close numbers
+   (small "bandwidth"), good for meshes and road networks. O(|E| log d)
+
+2) degreeSortOrder - highest (out + in) degree first. The hubs that most edges lead to are packed
+   into the first few cache lines. Cheap, helps power law graphs. O(|V| log |V|)
+
+3) gorderOrder - Gorder (Wei et al. 2016). Greedily appends the vertex with the highest score
+   against the last `window` placed vertices, where the score of u counts
+       edges between u and each vertex v in the window (either direction)
+     + in-neighbours u shares with v ("siblings" - read together when the parent is expanded)
+   Scores are maintained incrementally as vertices enter and leave the window, in a max heap
+   with lazy updates (stale entries are re-inserted when popped). Sibling updates through hub
+   parents (degree > sqrt(|V|)) are skipped as in the paper, otherwise a single hub costs
+   O(|V|) per placement. Best locality of the three, most expensive to compute.
+
+relabel(graph, newId) builds the renumbered graph (Graph or CSRGraph) with vertex values moved
+and each vertex's neighbours sorted by new number, so edge lists are also read in order.
+Results computed on the relabelled graph are mapped back with result[u] = newResult[newId[u]],
+and inversePermutation gives the old vertex of each new one.
+
+*/
+
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include "graph.hpp"
+#include "csr_graph.hpp"
+#include "heap.hpp"
+
+namespace structures_and_algorithms::structures::graphs{
+
+namespace vertex_order{
+    //in-neighbours of every vertex, CSR style
+    template<typename G>
+    void transpose(const G &graph, std::vector<uint64_t> &offsets, std::vector<uint32_t> &sources)
+    {
+        uint32_t N = graph.numVertices();
+        offsets.assign(N + 1,0);
+        for (uint32_t u = 0; u < N; ++u)
+            for (const auto &neighbourData : graph.neighbours(u))
+                ++offsets[neighbourData.first + 1];
+        for (uint32_t u = 0; u < N; ++u)
+            offsets[u + 1] += offsets[u];
+        sources.resize(offsets[N]);
+        std::vector<uint64_t> position(offsets.begin(),offsets.end() - 1);
+        for (uint32_t u = 0; u < N; ++u)
+            for (const auto &neighbourData : graph.neighbours(u))
+                sources[position[neighbourData.first]++] = u;
+    }
+
+    struct Score{
+        uint32_t vertex;
+        int64_t score;
+        //max heap on score
+        bool operator< (const Score& A) const { return this->score > A.score;};
+        bool operator> (const Score& A) const { return this->score < A.score;};
+    };
+}
+
+//newId[old] -> old vertex for each new id
+inline std::vector<uint32_t> inversePermutation(const std::vector<uint32_t> &newId)
+{
+    std::vector<uint32_t> oldId(newId.size());
+    for (uint32_t u = 0; u < newId.size(); ++u)
+        oldId[newId[u]] = u;
+    return oldId;
+}
+
+template<typename G>
+std::vector<uint32_t> reverseCuthillMcKee(const G &graph)
+{
+    uint32_t N = graph.numVertices();
+    std::vector<uint64_t> inOffsets;
+    std::vector<uint32_t> inSources;
+    vertex_order::transpose(graph,inOffsets,inSources); //treat edges as undirected
+    auto degree = [&](uint32_t u){return graph.neighbours(u).size() + (inOffsets[u + 1] - inOffsets[u]);};
+
+    std::vector<uint32_t> byDegree(N);
+    std::iota(byDegree.begin(),byDegree.end(),0);
+    std::stable_sort(byDegree.begin(),byDegree.end(),[&](uint32_t a, uint32_t b){return degree(a) < degree(b);});
+
+    std::vector<uint32_t> order; //Cuthill-McKee order
+    order.reserve(N);
+    std::vector<bool> visited(N,false);
+    std::vector<uint32_t> next;
+    for (uint32_t start : byDegree){ //each component from its lowest degree vertex
+        if (visited[start])
+            continue;
+        visited[start] = true;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); ++head){
+            uint32_t u = order[head];
+            next.clear();
+            for (const auto &neighbourData : graph.neighbours(u))
+                if (!visited[neighbourData.first]){
+                    visited[neighbourData.first] = true;
+                    next.push_back(neighbourData.first);
+                }
+            for (uint64_t e = inOffsets[u]; e < inOffsets[u + 1]; ++e)
+                if (!visited[inSources[e]]){
+                    visited[inSources[e]] = true;
+                    next.push_back(inSources[e]);
+                }
+            std::stable_sort(next.begin(),next.end(),[&](uint32_t a, uint32_t b){return degree(a) < degree(b);});
+            order.insert(order.end(),next.begin(),next.end());
+        }
+    }
+    std::vector<uint32_t> newId(N);
+    for (uint32_t i = 0; i < N; ++i)
+        newId[order[i]] = N - 1 - i; //reversed
+    return newId;
+}
+
+template<typename G>
+std::vector<uint32_t> degreeSortOrder(const G &graph)
+{
+    uint32_t N = graph.numVertices();
+    std::vector<uint64_t> degree(N,0);
+    for (uint32_t u = 0; u < N; ++u){
+        degree[u] += graph.neighbours(u).size();
+        for (const auto &neighbourData : graph.neighbours(u))
+            ++degree[neighbourData.first];
+    }
+    std::vector<uint32_t> order(N);
+    std::iota(order.begin(),order.end(),0);
+    std::stable_sort(order.begin(),order.end(),[&](uint32_t a, uint32_t b){return degree[a] > degree[b];});
+    std::vector<uint32_t> newId(N);
+    for (uint32_t i = 0; i < N; ++i)
+        newId[order[i]] = i;
+    return newId;
+}
+
+template<typename G>
+std::vector<uint32_t> gorderOrder(const G &graph, const uint32_t window = 5)
+{
+    using namespace structures_and_algorithms::structures::heaps;
+    uint32_t N = graph.numVertices();
+    if (N == 0)
+        return {};
+    std::vector<uint64_t> inOffsets;
+    std::vector<uint32_t> inSources;
+    vertex_order::transpose(graph,inOffsets,inSources);
+    const size_t hubDegree = std::sqrt(static_cast<double>(N));
+
+    std::vector<int64_t> score(N,0);
+    std::vector<bool> placed(N,false);
+    Heap<vertex_order::Score> heap;
+    for (uint32_t u = 0; u < N; ++u)
+        heap.insert(vertex_order::Score{u,0});
+
+    //add delta to the score of every unplaced vertex related to v
+    auto update = [&](uint32_t v, int64_t delta){
+        auto bump = [&](uint32_t u){
+            if (placed[u])
+                return;
+            score[u] += delta;
+            if (delta > 0) //decreases are caught lazily when the stale entry is popped
+                heap.insert(vertex_order::Score{u,score[u]});
+        };
+        for (const auto &neighbourData : graph.neighbours(v))
+            bump(neighbourData.first);
+        for (uint64_t e = inOffsets[v]; e < inOffsets[v + 1]; ++e){
+            uint32_t parent = inSources[e];
+            bump(parent);
+            if (graph.neighbours(parent).size() > hubDegree)
+                continue;
+            for (const auto &neighbourData : graph.neighbours(parent))
+                if (neighbourData.first != v)
+                    bump(neighbourData.first);
+        }
+    };
+
+    //start from the vertex with most in-neighbours
+    uint32_t start = 0;
+    for (uint32_t u = 1; u < N; ++u)
+        if (inOffsets[u + 1] - inOffsets[u] > inOffsets[start + 1] - inOffsets[start])
+            start = u;
+    std::vector<uint32_t> order;
+    order.reserve(N);
+    uint32_t v = start;
+    while (true){
+        placed[v] = true;
+        order.push_back(v);
+        if (order.size() == N)
+            break;
+        update(v,1);
+        if (order.size() > window)
+            update(order[order.size() - 1 - window],-1);
+        while (true){ //highest current score, skipping stale entries
+            vertex_order::Score top = heap.getRoot();
+            heap.removeRoot();
+            if (placed[top.vertex])
+                continue;
+            if (top.score != score[top.vertex]){
+                heap.insert(vertex_order::Score{top.vertex,score[top.vertex]});
+                continue;
+            }
+            v = top.vertex;
+            break;
+        }
+    }
+    std::vector<uint32_t> newId(N);
+    for (uint32_t i = 0; i < N; ++i)
+        newId[order[i]] = i;
+    return newId;
+}
+
+//renumbered copy of graph, neighbours sorted by new number
+template<typename T,typename U>
+Graph<T,U> relabel(const Graph<T,U> &graph, const std::vector<uint32_t> &newId)
+{
+    uint32_t N = graph.numVertices();
+    std::vector<uint32_t> oldId = inversePermutation(newId);
+    Graph<T,U> relabelled(N);
+    std::vector<std::pair<uint32_t,U> > adjacency;
+    for (uint32_t u = 0; u < N; ++u){ //allocate list nodes in new order too
+        relabelled.setValue(u,graph.getValue(oldId[u]));
+        adjacency.clear();
+        for (const auto &neighbourData : graph.neighbours(oldId[u]))
+            adjacency.emplace_back(newId[neighbourData.first],neighbourData.second);
+        std::stable_sort(adjacency.begin(),adjacency.end(),[](const auto &a, const auto &b){return a.first < b.first;});
+        for (const auto &entry : adjacency)
+            relabelled.addEdge(u,entry.first,entry.second);
+    }
+    return relabelled;
+}
+
+template<typename T,typename U>
+CSRGraph<T,U> relabel(const CSRGraph<T,U> &graph, const std::vector<uint32_t> &newId)
+{
+    uint32_t N = graph.numVertices();
+    std::vector<uint32_t> oldId = inversePermutation(newId);
+    std::vector<uint64_t> offsets(1,0);
+    offsets.reserve(N + 1);
+    std::vector<uint32_t> targets;
+    std::vector<U> weights;
+    targets.reserve(graph.numEdges());
+    weights.reserve(graph.numEdges());
+    std::vector<std::pair<uint32_t,U> > adjacency;
+    for (uint32_t u = 0; u < N; ++u){
+        adjacency.clear();
+        for (const auto &neighbourData : graph.neighbours(oldId[u]))
+            adjacency.emplace_back(newId[neighbourData.first],neighbourData.second);
+        std::stable_sort(adjacency.begin(),adjacency.end(),[](const auto &a, const auto &b){return a.first < b.first;});
+        for (const auto &entry : adjacency){
+            targets.push_back(entry.first);
+            weights.push_back(entry.second);
+        }
+        offsets.push_back(targets.size());
+    }
+    CSRGraph<T,U> relabelled(std::move(offsets),std::move(targets),std::move(weights));
+    for (uint32_t u = 0; u < N; ++u)
+        relabelled.setValue(u,graph.getValue(oldId[u]));
+    return relabelled;
+}
+
+}
+
+#endif /*VERTEX_ORDER_H*/
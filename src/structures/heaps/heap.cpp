@@ -59,6 +59,19 @@ int main(/*int argc, char* argv[]*/)
     std::cout<<"minheap is a heap: "<<heapMin.checkHeap()<<std::endl;
     std::cout<<"maxheap is a heap: "<<heapMax.checkHeap()<<std::endl;
 
+    //n-ary heaps built from data - every size up to a few levels deep
+    bool naryHeaps = true;
+    for (size_t arity = 2; arity <= 5; ++arity){
+        for (size_t size = 0; size <= 40; ++size){
+            std::vector<T> naryData(size);
+            for (auto & x: naryData)
+                x = M*rnd();
+            Heap<T> naryHeap(arity,naryData);
+            naryHeaps = naryHeaps && naryHeap.checkHeap();
+        }
+    }
+    std::cout<<"n-ary heaps built from data are heaps: "<<naryHeaps<<std::endl;
+
     std::cout<<std::endl<<"Min heap extreme vals - in order"<<std::endl;
     for (size_t i=0;i<N+3;i++){
         std::cout<<heapMin.getRoot()<<std::endl;
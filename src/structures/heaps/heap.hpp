@@ -52,6 +52,7 @@ as O(log(n)) in most cases
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include "comparators.hpp"
 
 using namespace structures_and_algorithms::comparators;
@@ -70,9 +71,9 @@ protected:
     //convert the data to a heap
     void heapify()
     {
-        if (!data.size())
+        if (data.size() < 2)
             return;
-        for(int32_t index = data.size()/n - 1; index >= 0; --index)
+        for(size_t index = (data.size() - 2)/n + 1; index-- > 0;) //from the parent of the last element
             sendDown(index);
     }
     
@@ -85,7 +86,7 @@ protected:
     }
 public:
     template<typename VectorT>
-    Heap(size_t n_, VectorT &&data_, func compare_ = lessThan<T>):n(std::min(2,static_cast<int>(n_))),data(std::forward<VectorT>(data_)),compare(compare_)
+    Heap(size_t n_, VectorT &&data_, func compare_ = lessThan<T>):n(std::max(2,static_cast<int>(n_))),data(std::forward<VectorT>(data_)),compare(compare_)
     {
         heapify();
     }
@@ -94,7 +95,7 @@ public:
     {
         heapify();
     }
-    Heap(size_t n_, func compare_ = lessThan<T>):compare(compare_){} //no data provided
+    Heap(size_t n_, func compare_ = lessThan<T>):n(std::max(2,static_cast<int>(n_))),compare(compare_){} //no data provided
     Heap(func compare_ = lessThan<T>):n(2),compare(compare_){} //no data provided
 
     bool isEmpty(){
@@ -103,7 +104,7 @@ public:
 
     void sendUpRecursive(size_t index)
     {
-        if ((index >1)&&(index < data.size())){//for parent index to exist
+        if ((index >0)&&(index < data.size())){//for parent index to exist
             size_t parent_index = (index - 1)/n;
             if (compare(data[index],data[parent_index])){
                 swap(data[index],data[parent_index]);
@@ -114,7 +115,7 @@ public:
 
     void sendUp(size_t index)
     {
-        while ((index >1)&&(index < data.size())){//for parent index to exist
+        while ((index >0)&&(index < data.size())){//for parent index to exist
             size_t parent_index = (index - 1)/n;
             if (compare(data[index],data[parent_index])){
                 swap(data[index],data[parent_index]);
@@ -168,6 +169,11 @@ public:
         return data[0];
     }
 
+    virtual void clear() //empty the heap, keeping its storage for reuse - virtual so IndexedHeap also clears its index
+    {
+        data.clear();
+    }
+
     //make virtual in order to specialise in examples - not a sensible real world performance choice!
     virtual void removeRoot()
     {
@@ -23,6 +23,7 @@ Indexed Heap test
 */
 
 #include <iostream>
+#include <functional>
 #include "indexedheap.hpp"
 #include "random.hpp"
 
@@ -26,8 +26,8 @@ in addition to the root element through a hashmap.
 
 ******This assumes all elements in the heap are unique******
 
-Consequently we have additional functions for setting specific elements and finding 
-the index of an element
+Consequently we have additional functions for setting specific elements, removing
+specific elements and finding the index of an element
 
 */
 
@@ -115,6 +115,33 @@ public:
             this->sendDown(0);
         }
     }
+    bool remove(const T &val) //remove arbitrary element - O(log(n))
+    {
+        auto it = indexMap.find(val);
+        if (it == indexMap.end())
+            return false;
+        size_t index = it->second;
+        swap(this->data[index],this->data.back());
+        indexMap.erase(this->data.back());
+        this->data.pop_back();
+        if (index < this->data.size()){ //restore heap property for element moved into index
+            this->sendUp(index);
+            this->sendDown(index);
+        }
+        return true;
+    }
+
+    size_t size() const noexcept
+    {
+        return this->data.size();
+    }
+
+    void clear() override
+    {
+        this->data.clear();
+        indexMap.clear();
+    }
+
     template<typename V>
     void insert(V &&val)
     {
@@ -0,0 +1,123 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Timer wheel test - also compares schedule/cancel/expire throughput against a raw IndexedHeap
+
+*/
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include "timer_wheel.hpp"
+#include "indexedheap.hpp"
+#include "random.hpp"
+
+using namespace structures_and_algorithms::structures::timers;
+using namespace structures_and_algorithms::structures::heaps;
+using namespace structures_and_algorithms::random;
+
+//timeout held directly in a heap for comparison
+struct Timeout
+{
+    uint32_t id;
+    uint64_t expiry;
+    bool operator< (const Timeout& A) const { return this->expiry < A.expiry;};
+    bool operator> (const Timeout& A) const { return this->expiry > A.expiry;};
+    bool operator==(const Timeout &val)const noexcept{return this->id == val.id;}
+};
+struct TimeoutHasher{size_t operator()(const Timeout& val) const {return std::hash<uint32_t>{}(val.id);}};
+
+int main(/*int argc, char* argv[]*/)
+{
+    RndUniform rnd;
+
+    //small example
+    TimerWheel<int32_t> wheel(4); //ticks of 16 time units
+    std::vector<TimerHandle> handles;
+    for (int32_t i = 0; i < 10; ++i){
+        uint64_t expiry = 5000*rnd();
+        handles.push_back(wheel.schedule(expiry,i));
+        std::cout<<"timer "<<i<<" expires at "<<expiry<<std::endl;
+    }
+    std::cout<<"cancelling timers 3 and 7"<<std::endl;
+    wheel.cancel(handles[3]);
+    wheel.cancel(handles[7]);
+    std::cout<<"cancelling timer 3 again: "<<wheel.cancel(handles[3])<<std::endl;
+    for (uint64_t t = 1000; t <= 5000; t += 1000){
+        std::cout<<"advance to "<<t<<" : ";
+        wheel.advance(t,[](int32_t id){std::cout<<id<<" ";});
+        std::cout<<std::endl;
+    }
+    std::cout<<"pending timers: "<<wheel.size()<<std::endl<<std::endl;
+
+    //throughput: most timers cancelled before they fire
+    const uint32_t N = 1000000;
+    const uint64_t horizon = 1000000;
+    const uint64_t step = 1000;
+    std::vector<uint64_t> expiries(N);
+    std::vector<bool> cancelled(N);
+    for (uint32_t i = 0; i < N; ++i){
+        expiries[i] = horizon*rnd();
+        cancelled[i] = (rnd() < 0.9);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    TimerWheel<uint32_t> bigWheel(4);
+    std::vector<TimerHandle> bigHandles(N);
+    for (uint32_t i = 0; i < N; ++i)
+        bigHandles[i] = bigWheel.schedule(expiries[i],i);
+    for (uint32_t i = 0; i < N; ++i)
+        if (cancelled[i])
+            bigWheel.cancel(bigHandles[i]);
+    size_t firedWheel = 0;
+    uint64_t lastExpiry = 0;
+    bool ordered = true;
+    for (uint64_t t = 0; t <= horizon; t += step){
+        firedWheel += bigWheel.advance(t,[&](uint32_t id){
+            ordered = ordered && (expiries[id] >= lastExpiry) && (expiries[id] <= t);
+            lastExpiry = expiries[id];
+        });
+    }
+    auto mid = std::chrono::steady_clock::now();
+
+    IndexedHeap<Timeout,decltype(lessThan<Timeout>),TimeoutHasher> heap;
+    for (uint32_t i = 0; i < N; ++i)
+        heap.insert(Timeout{i,expiries[i]});
+    for (uint32_t i = 0; i < N; ++i)
+        if (cancelled[i])
+            heap.remove(Timeout{i,expiries[i]});
+    size_t firedHeap = 0;
+    for (uint64_t t = 0; t <= horizon; t += step){
+        while ((!heap.isEmpty()) && (heap.getRoot().expiry <= t)){
+            heap.removeRoot();
+            ++firedHeap;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout<<N<<" timers, ~90% cancelled"<<std::endl;
+    std::cout<<"timer wheel : "<<firedWheel<<" fired in order: "<<ordered<<" "
+             <<std::chrono::duration<double,std::milli>(mid-start).count()<<" ms"<<std::endl;
+    std::cout<<"indexed heap: "<<firedHeap<<" fired "
+             <<std::chrono::duration<double,std::milli>(end-mid).count()<<" ms"<<std::endl;
+
+    return 0;
+}
@@ -0,0 +1,291 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Hierarchical timer wheel with an exact near-term queue
+
+A plain heap of timeouts costs O(log(n)) for every insert and every cancel, even though the
+vast majority of timers in e.g. a network service are cancelled long before they fire.
+
+Here the time axis is cut into ticks of 2^tickShift time units and timers are hashed into
+"wheels" of 64 slots:
+
+    level 0 : one slot per tick                    - timers due in the next 64 ticks
+    level 1 : one slot per 64 ticks                - timers due in the next 64^2 ticks
+    level k : one slot per 64^k ticks              - timers due in the next 64^(k+1) ticks
+
+Each slot is an intrusive doubly linked list threaded through a pool of timer nodes, so:
+
+    schedule : O(1) - compute the level/slot from the distance to the expiry, push to list
+    cancel   : O(1) - unlink from its list via the handle (index + generation into the pool)
+
+As time advances, whenever the level k index wraps round we "cascade" the next slot of level k+1
+down into the finer levels. When the clock reaches a level 0 slot its timers are moved into an
+IndexedHeap ordered by exact expiry - only these near-term timers ever pay a log cost, and the
+heap gives us exact ordering within a tick. IndexedHeap lets us remove a timer from the middle
+of this queue if it is cancelled at the last moment.
+
+Handles carry a generation count so a stale handle (timer already fired/cancelled and its node
+reused) is detected rather than cancelling somebody else's timer.
+
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <iostream>
+#include <vector>
+#include <array>
+#include <functional>
+#include "indexedheap.hpp"
+#include "comparators.hpp"
+
+using namespace structures_and_algorithms::comparators;
+using namespace structures_and_algorithms::structures::heaps;
+
+namespace structures_and_algorithms::structures::timers{
+
+//opaque reference to a scheduled timer
+struct TimerHandle{
+    uint32_t index = -1;
+    uint32_t generation = 0;
+};
+
+template<typename T> //T payload associated with each timer
+class TimerWheel{
+    static constexpr uint32_t slotBits = 6;
+    static constexpr uint32_t numSlots = 1u << slotBits; //slots per level
+    static constexpr uint32_t slotMask = numSlots - 1;
+    static constexpr uint32_t numLevels = 6; //covers 2^36 ticks - further timers are re-cascaded
+    static constexpr uint32_t nil = -1;
+
+    enum class Location : uint8_t {FREE, WHEEL, QUEUE};
+
+    struct TimerNode{
+        uint64_t expiry;
+        uint32_t next;
+        uint32_t prev;
+        uint32_t generation;
+        uint32_t slot; //index into heads when in the wheel
+        Location location;
+        T payload;
+    };
+
+    //entry in the exact queue - identified by pool index, ordered by expiry
+    struct QueueEntry{
+        uint32_t index;
+        uint64_t expiry;
+        bool operator< (const QueueEntry& A) const { return (this->expiry < A.expiry)||((this->expiry == A.expiry)&&(this->index < A.index));};
+        bool operator> (const QueueEntry& A) const { return A < *this;};
+        bool operator==(const QueueEntry &val)const noexcept{return this->index == val.index;}
+        //need == operator for hashtable
+    };
+    struct QueueEntryHasher{size_t operator()(const QueueEntry& val) const {return std::hash<uint32_t>{}(val.index);}};
+
+    uint32_t tickShift; //tick length is 2^tickShift time units
+    uint64_t currentTick;
+    uint64_t now;
+    size_t numPending = 0;
+    size_t numInWheel = 0;
+    std::vector<TimerNode> pool;
+    uint32_t freeList = nil;
+    std::array<uint32_t,numLevels*numSlots> heads;
+    IndexedHeap<QueueEntry,decltype(lessThan<QueueEntry>),QueueEntryHasher> queue;
+
+    uint32_t allocate()
+    {
+        if (freeList != nil){
+            uint32_t index = freeList;
+            freeList = pool[index].next;
+            return index;
+        }
+        pool.push_back(TimerNode{});
+        return pool.size() - 1;
+    }
+
+    void release(uint32_t index)
+    {
+        TimerNode &node = pool[index];
+        node.location = Location::FREE;
+        ++node.generation; //invalidate outstanding handles
+        node.payload = T();
+        node.next = freeList;
+        freeList = index;
+        --numPending;
+    }
+
+    void link(uint32_t index, uint32_t slot)
+    {
+        TimerNode &node = pool[index];
+        node.location = Location::WHEEL;
+        node.slot = slot;
+        node.prev = nil;
+        node.next = heads[slot];
+        if (heads[slot] != nil)
+            pool[heads[slot]].prev = index;
+        heads[slot] = index;
+        ++numInWheel;
+    }
+
+    void unlink(uint32_t index)
+    {
+        TimerNode &node = pool[index];
+        if (node.prev != nil)
+            pool[node.prev].next = node.next;
+        else
+            heads[node.slot] = node.next;
+        if (node.next != nil)
+            pool[node.next].prev = node.prev;
+        --numInWheel;
+    }
+
+    //place timer in the wheel (or exact queue if due this tick) relative to currentTick
+    void place(uint32_t index)
+    {
+        TimerNode &node = pool[index];
+        uint64_t expiryTick = node.expiry >> tickShift;
+        if (expiryTick <= currentTick){
+            node.location = Location::QUEUE;
+            queue.insert(QueueEntry{index,node.expiry});
+            return;
+        }
+        uint64_t delta = expiryTick - currentTick;
+        uint32_t level = 0;
+        while ((level < numLevels - 1) && (delta >> (slotBits * (level + 1))))
+            ++level;
+        if (delta >> (slotBits * (level + 1))) //beyond the top level - park in furthest top level slot
+            expiryTick = currentTick + (static_cast<uint64_t>(slotMask) << (slotBits * level));
+        uint32_t slot = (expiryTick >> (slotBits * level)) & slotMask;
+        link(index, level * numSlots + slot);
+    }
+
+    //move every timer in a slot back through place() - lands in a finer level or the queue
+    void cascade(uint32_t slot)
+    {
+        uint32_t index = heads[slot];
+        heads[slot] = nil;
+        while (index != nil){
+            uint32_t next = pool[index].next;
+            --numInWheel;
+            place(index);
+            index = next;
+        }
+    }
+
+    void tick()
+    {
+        ++currentTick;
+        for (uint32_t level = 1; level < numLevels; ++level){ //cascade higher levels as lower ones wrap
+            if (currentTick & ((static_cast<uint64_t>(1) << (slotBits * level)) - 1))
+                break;
+            cascade(level * numSlots + ((currentTick >> (slotBits * level)) & slotMask));
+        }
+        cascade(currentTick & slotMask); //level 0 slot now due - into the exact queue
+    }
+
+public:
+    TimerWheel(uint32_t tickShift_ = 0, uint64_t now_ = 0):tickShift(tickShift_),currentTick(now_ >> tickShift_),now(now_)
+    {
+        heads.fill(nil);
+    }
+
+    size_t size() const noexcept
+    {
+        return numPending;
+    }
+
+    uint64_t time() const noexcept
+    {
+        return now;
+    }
+
+    //schedule payload to expire at absolute time expiry
+    template<typename V>
+    TimerHandle schedule(uint64_t expiry, V &&payload)
+    {
+        uint32_t index = allocate();
+        TimerNode &node = pool[index];
+        node.expiry = expiry;
+        node.payload = std::forward<V>(payload);
+        ++numPending;
+        place(index);
+        return {index,node.generation};
+    }
+
+    bool isPending(const TimerHandle &handle) const noexcept
+    {
+        return (handle.index < pool.size()) && (pool[handle.index].generation == handle.generation) && (pool[handle.index].location != Location::FREE);
+    }
+
+    //O(1) for timers in the wheel, O(log(q)) for the (few) timers already in the exact queue
+    bool cancel(const TimerHandle &handle)
+    {
+        if (!isPending(handle))
+            return false;
+        TimerNode &node = pool[handle.index];
+        if (node.location == Location::WHEEL)
+            unlink(handle.index);
+        else
+            queue.remove(QueueEntry{handle.index,node.expiry});
+        release(handle.index);
+        return true;
+    }
+
+    //advance the clock to now_ calling onExpire(payload) for every expired timer, in expiry order
+    template<typename F>
+    size_t advance(uint64_t now_, F &&onExpire)
+    {
+        if (now_ < now)
+            return 0;
+        now = now_;
+        uint64_t targetTick = now >> tickShift;
+        size_t fired = 0;
+        while (currentTick < targetTick){
+            if (!numInWheel){ //nothing left to cascade - jump straight there
+                currentTick = targetTick;
+                break;
+            }
+            tick();
+            //fire as we go so the queue holds at most roughly one tick's worth of timers
+            fired += expire(onExpire);
+        }
+        return fired + expire(onExpire);
+    }
+
+private:
+    template<typename F>
+    size_t expire(F &onExpire)
+    {
+        size_t fired = 0;
+        while ((!queue.isEmpty()) && (queue.getRoot().expiry <= now)){
+            uint32_t index = queue.getRoot().index;
+            queue.removeRoot();
+            T payload = std::move(pool[index].payload);
+            release(index);
+            onExpire(payload);
+            ++fired;
+        }
+        return fired;
+    }
+};
+
+}
+
+#endif /*TIMER_WHEEL_H*/
@@ -0,0 +1,63 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+/*
+
+Portable bit scans
+
+countTrailingZeros(x) - index of the lowest set bit of x, which must be non-zero
+popCount(x)           - number of set bits of x
+
+gcc and clang use their builtins, MSVC its intrinsics (_BitScanForward64 needs a 64 bit target,
+__popcnt a CPU with popcnt - any AVX2 machine).
+
+*/
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace structures_and_algorithms::bits{
+
+inline uint32_t countTrailingZeros(const uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index,x);
+    return index;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline uint32_t popCount(const uint32_t x)
+{
+#ifdef _MSC_VER
+    return __popcnt(x);
+#else
+    return __builtin_popcount(x);
+#endif
+}
+
+}
+
+#endif /*BITS_H*/
@@ -0,0 +1,117 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Minimal fork-join helpers over std::thread
+
+parallelFor(n,numThreads,fn) calls fn(threadIndex,begin,end) on contiguous chunks of [0,n),
+one per thread, and joins. Small ranges are run inline on the calling thread as starting
+threads costs more than the work saved.
+
+threadIndex is < numThreads so callers can keep per thread buffers indexed by it.
+
+parallelSort sorts one run per thread with std::sort, then merges neighbouring runs in rounds
+(half as many merges each round, ping-ponging through one buffer). Not stable.
+
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+
+namespace structures_and_algorithms::parallel{
+
+inline uint32_t defaultThreads()
+{
+    return std::max(1u,std::thread::hardware_concurrency());
+}
+
+template<typename F>
+void parallelFor(size_t n, uint32_t numThreads, F &&fn, size_t minChunk = 1024)
+{
+    uint32_t useThreads = std::max<size_t>(1,std::min<size_t>(numThreads,n / std::max<size_t>(1,minChunk)));
+    if (useThreads <= 1){
+        fn(0,0,n);
+        return;
+    }
+    std::vector<std::thread> threads;
+    size_t chunk = (n + useThreads - 1) / useThreads;
+    for (uint32_t t = 1; t < useThreads; ++t){
+        size_t begin = std::min(n,t * chunk);
+        size_t end = std::min(n,begin + chunk);
+        threads.emplace_back([&fn,t,begin,end](){fn(t,begin,end);});
+    }
+    fn(0,0,std::min(n,chunk)); //calling thread takes the first chunk
+    for (auto &thread : threads)
+        thread.join();
+}
+
+template<typename It, typename Compare = std::less<> >
+void parallelSort(It first, It last, uint32_t numThreads, Compare compare = Compare(), size_t minChunk = 1 << 14)
+{
+    typedef typename std::iterator_traits<It>::value_type V;
+    size_t n = last - first;
+    uint32_t runs = std::max<size_t>(1,std::min<size_t>(numThreads,n / std::max<size_t>(1,minChunk)));
+    if (runs <= 1){
+        std::sort(first,last,compare);
+        return;
+    }
+    std::vector<size_t> bounds(runs + 1);
+    for (uint32_t r = 0; r <= runs; ++r)
+        bounds[r] = n * r / runs;
+    parallelFor(runs,runs,[&](uint32_t,size_t begin,size_t end){
+        for (size_t r = begin; r < end; ++r)
+            std::sort(first + bounds[r],first + bounds[r + 1],compare);
+    },1);
+    std::vector<V> buffer(n);
+    bool inBuffer = false;
+    while (bounds.size() > 2){
+        size_t numRuns = bounds.size() - 1, pairs = (numRuns + 1) / 2; //a lone last run is merged with nothing
+        parallelFor(pairs,pairs,[&](uint32_t,size_t begin,size_t end){
+            for (size_t p = begin; p < end; ++p){
+                size_t low = bounds[2*p], mid = bounds[std::min(2*p + 1,numRuns)], high = bounds[std::min(2*p + 2,numRuns)];
+                if (inBuffer)
+                    std::merge(std::make_move_iterator(buffer.begin() + low),std::make_move_iterator(buffer.begin() + mid),
+                               std::make_move_iterator(buffer.begin() + mid),std::make_move_iterator(buffer.begin() + high),first + low,compare);
+                else
+                    std::merge(std::make_move_iterator(first + low),std::make_move_iterator(first + mid),
+                               std::make_move_iterator(first + mid),std::make_move_iterator(first + high),buffer.begin() + low,compare);
+            }
+        },1);
+        std::vector<size_t> merged;
+        for (size_t r = 0; r < bounds.size(); r += 2)
+            merged.push_back(bounds[r]);
+        if (merged.back() != n)
+            merged.push_back(n);
+        bounds.swap(merged);
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer)
+        std::move(buffer.begin(),buffer.end(),first);
+}
+
+}
+
+#endif /*PARALLEL_H*/
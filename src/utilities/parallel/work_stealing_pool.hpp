@@ -0,0 +1,194 @@
+/*****************************************************************************/
+/******************** Copyright (C) 2022, Richard Spinney. *******************/
+/*****************************************************************************/
+//                                                                           //
+//    This program is free software: you can redistribute it and/or modify   //
+//    it under the terms of the GNU General Public License as published by   //
+//    the Free Software Foundation, either version 3 of the License, or      //
+//    (at your option) any later version.                                    //
+//                                                                           //
+//    This program is distributed in the hope that it will be useful,        //
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of         //
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the          //
+//    GNU General Public License for more details.                           //
+//                                                                           //
+//    You should have received a copy of the GNU General Public License      //
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.  //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+/*
+
+Work stealing thread pool for recursive (fork-join) tasks
+
+Every worker has its own deque of tasks. New tasks go on the back of the submitting worker's
+deque (threads outside the pool share one extra deque) and a worker takes its next task from
+the back too - so it carries on with the most recent, smallest, cache-warm piece of work. An
+idle worker steals from the *front* of another deque, taking the oldest task, which in a
+divide and conquer algorithm is the biggest one left. Each steal therefore moves a lot of
+work, and steals are rare.
+
+Deques are guarded by a mutex each - tasks are meant to be coarse (thousands of elements or
+more), so the lock is not the bottleneck and is much simpler than a lock free deque.
+
+TaskGroup counts unfinished tasks. Tasks may submit more tasks to the same group.
+wait(group) does not block: the waiting thread runs queued tasks (its own or stolen) until
+the group is done, so waiting from inside a task cannot deadlock the pool.
+
+Idle workers sleep on a condition variable; submit only takes the sleep mutex when someone is
+asleep.
+
+*/
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include "parallel.hpp"
+
+namespace structures_and_algorithms::parallel{
+
+struct TaskGroup{
+    std::atomic<size_t> pending{0}; //submitted but not finished
+};
+
+class WorkStealingPool{
+    struct TaskQueue{
+        std::mutex mutex;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    std::vector<TaskQueue> queues; //one per worker, last one for threads outside the pool
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0}; //tasks sitting in queues
+    std::atomic<uint32_t> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    bool stop = false; //guarded by sleepMutex
+
+    inline static thread_local WorkStealingPool *currentPool = nullptr;
+    inline static thread_local uint32_t currentIndex = 0;
+
+    uint32_t ownQueue() const
+    {
+        return (currentPool == this) ? currentIndex : static_cast<uint32_t>(queues.size()) - 1;
+    }
+
+    bool popBack(const uint32_t q, std::function<void()> &task)
+    {
+        std::lock_guard<std::mutex> lock(queues[q].mutex);
+        if (queues[q].tasks.empty())
+            return false;
+        task = std::move(queues[q].tasks.back());
+        queues[q].tasks.pop_back();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    bool stealFront(const uint32_t q, std::function<void()> &task)
+    {
+        std::unique_lock<std::mutex> lock(queues[q].mutex,std::try_to_lock); //busy - try elsewhere
+        if (!lock.owns_lock() || queues[q].tasks.empty())
+            return false;
+        task = std::move(queues[q].tasks.front());
+        queues[q].tasks.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    //run one task - own deque first, then steal. false if nothing was found
+    bool runOne()
+    {
+        if (queued.load() == 0)
+            return false;
+        const uint32_t self = ownQueue();
+        const uint32_t numQueues = queues.size();
+        std::function<void()> task;
+        bool found = popBack(self,task);
+        for (uint32_t i = 1; !found && (i < numQueues); ++i)
+            found = stealFront((self + i) % numQueues,task);
+        if (found)
+            task();
+        return found;
+    }
+
+    void workerLoop(const uint32_t index)
+    {
+        currentPool = this;
+        currentIndex = index;
+        while (true){
+            if (runOne())
+                continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            wakeUp.wait(lock,[&](){return stop || (queued.load() > 0);});
+            sleeping.fetch_sub(1);
+            if (stop && (queued.load() == 0))
+                return;
+        }
+    }
+
+public:
+    //numThreads background workers - threads calling wait() work as well, so numThreads = 0 is valid
+    explicit WorkStealingPool(const uint32_t numThreads = defaultThreads()):queues(numThreads + 1)
+    {
+        for (uint32_t t = 0; t < numThreads; ++t)
+            workers.emplace_back([this,t](){workerLoop(t);});
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stop = true;
+        }
+        wakeUp.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    uint32_t numThreads() const noexcept
+    {
+        return workers.size();
+    }
+
+    template<typename F>
+    void submit(TaskGroup &group, F &&fn)
+    {
+        group.pending.fetch_add(1);
+        TaskQueue &queue = queues[ownQueue()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([&group,fn = std::forward<F>(fn)]() mutable {
+                fn();
+                group.pending.fetch_sub(1,std::memory_order_release);
+            });
+        }
+        queued.fetch_add(1);
+        if (sleeping.load() > 0){ //seq_cst pairs with the sleeper's increment before it checks queued
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeUp.notify_one();
+        }
+    }
+
+    //run tasks until every task of group (and the tasks they submitted) has finished
+    void wait(TaskGroup &group)
+    {
+        while (group.pending.load(std::memory_order_acquire) > 0)
+            if (!runOne())
+                std::this_thread::yield();
+    }
+};
+
+}
+
+#endif /*WORK_STEALING_POOL_H*/
@@ -22,6 +22,7 @@
 
 #include <math.h>
 #include <random>
+#include <array>
 #include <cmath>
 #include <algorithm>
 #include <ctime>